@@ -0,0 +1,197 @@
+#include "Bench.hpp"
+#include "BackupJob.hpp"
+#include "FileCopier.hpp"
+#include <sqlite3.h>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+
+// 在合成文件上测量一次完整保存（BackupJob::save，各保存方式）与 FileCopier 各复制路径
+namespace
+{
+    constexpr std::uint64_t FileSize = 32ull * 1024 * 1024;
+    constexpr int TreeFiles = 2000;
+    constexpr std::uint64_t TreeFileSize = 4096;
+
+    // 一半伪随机、一半重复文本：压缩比与真实存档相近，不至于让 gzip 过快或过慢
+    void writeSynthetic(const fs::path &path, std::uint64_t size, std::uint32_t seed)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        std::string block(4096, '\0');
+        std::uint32_t x = seed | 1;
+        for (std::uint64_t written = 0; written < size; written += block.size())
+        {
+            for (std::size_t i = 0; i < block.size(); ++i)
+            {
+                if (i < block.size() / 2)
+                {
+                    x ^= x << 13;
+                    x ^= x >> 17;
+                    x ^= x << 5;
+                    block[i] = static_cast<char>(x);
+                }
+                else
+                    block[i] = "\"uid\":10001,\"item\":"[i % 19];
+            }
+            out.write(block.data(), static_cast<std::streamsize>(std::min<std::uint64_t>(block.size(), size - written)));
+        }
+        if (!out)
+            throw std::runtime_error("无法写入合成文件 " + path.string());
+    }
+
+    // 就地改写 16 字节：内容哈希与修改时间都变化，保存不会被跳过
+    void touch(const fs::path &path, std::uint64_t size, std::uint64_t counter)
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>((counter * 2654435761u) % (size - 16)));
+        file.write(reinterpret_cast<const char *>(&counter), sizeof(counter));
+        file.write(reinterpret_cast<const char *>(&counter), sizeof(counter));
+    }
+
+    void exec(sqlite3 *db, const char *sql)
+    {
+        char *message = nullptr;
+        if (sqlite3_exec(db, sql, nullptr, nullptr, &message) != SQLITE_OK)
+        {
+            std::string error = message ? message : "sqlite3_exec 失败";
+            sqlite3_free(message);
+            throw std::runtime_error(error);
+        }
+    }
+
+    // 约 32 MiB 的 WAL 数据库：4096 行 × 8 KiB
+    void writeDatabase(const fs::path &path)
+    {
+        sqlite3 *db = nullptr;
+        if (sqlite3_open(path.string().c_str(), &db) != SQLITE_OK)
+            throw std::runtime_error("无法创建合成数据库");
+        exec(db, "PRAGMA journal_mode=WAL;"
+                 "CREATE TABLE player(id INTEGER PRIMARY KEY, data BLOB);"
+                 "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 4096)"
+                 " INSERT INTO player(data) SELECT randomblob(8192) FROM n;"
+                 "PRAGMA wal_checkpoint(TRUNCATE);");
+        sqlite3_close(db);
+    }
+
+    void touchDatabase(const fs::path &path)
+    {
+        sqlite3 *db = nullptr;
+        sqlite3_open(path.string().c_str(), &db);
+        exec(db, "UPDATE player SET data = randomblob(8192) WHERE id = abs(random()) % 4096 + 1;");
+        sqlite3_close(db);
+    }
+
+    // 每个用例一个任务与一份源，首次（预热）调用时创建
+    struct Fixture
+    {
+        fs::path source;
+        std::unique_ptr<BackupJob> job;
+        std::uint64_t counter = 0;
+    };
+
+    Fixture &fixture(const std::string &name, SaveMode mode)
+    {
+        static std::map<std::string, Fixture> fixtures;
+        Fixture &f = fixtures[name];
+        if (f.job)
+            return f;
+
+        const fs::path root = bench::workDir() / name;
+        fs::create_directories(root);
+        BackupJob::Options options;
+        options.name = name;
+        options.destination = root / "slots";
+        options.slotCount = 3;
+        options.mode = mode;
+        if (name == "directory")
+        {
+            f.source = root / "config";
+            for (int i = 0; i < TreeFiles; ++i)
+            {
+                fs::path file = f.source / ("d" + std::to_string(i / 100)) / ("f" + std::to_string(i) + ".json");
+                fs::create_directories(file.parent_path());
+                writeSynthetic(file, TreeFileSize, static_cast<std::uint32_t>(i + 1));
+            }
+        }
+        else if (mode == SaveMode::Sqlite)
+        {
+            f.source = root / "player.db";
+            writeDatabase(f.source);
+        }
+        else
+        {
+            f.source = root / "player.dat";
+            writeSynthetic(f.source, FileSize, 7);
+        }
+        options.source = f.source;
+        f.job = std::make_unique<BackupJob>(options);
+        return f;
+    }
+
+    void saveBody(const std::string &name, SaveMode mode, std::uint64_t n)
+    {
+        Fixture &f = fixture(name, mode);
+        for (std::uint64_t i = 0; i < n; ++i)
+        {
+            ++f.counter;
+            if (name == "directory")
+            {
+                // 每次改动 1% 的文件，其余文件走硬链接
+                for (int k = 0; k < TreeFiles / 100; ++k)
+                {
+                    const int index = static_cast<int>((f.counter * 37 + static_cast<std::uint64_t>(k) * 101) % TreeFiles);
+                    touch(f.source / ("d" + std::to_string(index / 100)) / ("f" + std::to_string(index) + ".json"),
+                          TreeFileSize, f.counter);
+                }
+            }
+            else if (mode == SaveMode::Sqlite)
+                touchDatabase(f.source);
+            else
+                touch(f.source, FileSize, f.counter);
+            f.job->save();
+        }
+    }
+
+    bench::Register saveCopy("backup/save/copy/32m", FileSize, [](std::uint64_t n)
+                             { saveBody("copy", SaveMode::Copy, n); });
+    bench::Register saveIncremental("backup/save/incremental/32m", FileSize, [](std::uint64_t n)
+                                    { saveBody("incremental", SaveMode::Incremental, n); });
+    bench::Register saveCompressed("backup/save/compressed/32m", FileSize, [](std::uint64_t n)
+                                   { saveBody("compressed", SaveMode::Compressed, n); });
+    bench::Register saveSqlite("backup/save/sqlite/32m", FileSize, [](std::uint64_t n)
+                               { saveBody("sqlite", SaveMode::Sqlite, n); });
+    bench::Register saveDirectory("backup/save/directory/2000x4k", TreeFiles * TreeFileSize, [](std::uint64_t n)
+                                  { saveBody("directory", SaveMode::Copy, n); });
+
+    void copyBody(const char *name, FileCopier::Method method, std::uint64_t n)
+    {
+        static const fs::path source = []
+        {
+            fs::path path = bench::workDir() / "copy_source.dat";
+            writeSynthetic(path, FileSize, 11);
+            return path;
+        }();
+        const fs::path target = bench::workDir() / (std::string("copy_") + name + ".dat");
+        for (std::uint64_t i = 0; i < n; ++i)
+        {
+            FileCopier::Stats stats;
+            std::string error;
+            if (!FileCopier::copyAtomic(source, target, stats, error, method))
+                throw std::runtime_error(error);
+        }
+    }
+
+    bench::Register copyAuto("filecopy/auto/32m", FileSize, [](std::uint64_t n)
+                             { copyBody("auto", FileCopier::Method::Auto, n); });
+#ifdef __linux__
+    bench::Register copyRange("filecopy/copy_file_range/32m", FileSize, [](std::uint64_t n)
+                              { copyBody("copy_file_range", FileCopier::Method::CopyFileRange, n); });
+    bench::Register copySendfile("filecopy/sendfile/32m", FileSize, [](std::uint64_t n)
+                                 { copyBody("sendfile", FileCopier::Method::Sendfile, n); });
+#endif
+#ifndef _WIN32
+    bench::Register copyReadWrite("filecopy/read_write/32m", FileSize, [](std::uint64_t n)
+                                  { copyBody("read_write", FileCopier::Method::ReadWrite, n); });
+#endif
+}
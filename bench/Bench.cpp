@@ -0,0 +1,275 @@
+#include "Bench.hpp"
+#include "ConsoleOutputManager.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+using json = nlohmann::json;
+
+namespace
+{
+    fs::path workDirectory;
+
+    struct Options
+    {
+        std::string filter;         // 只运行名称包含该子串的用例
+        double minSeconds = 0.1;    // 每轮至少运行的时间
+        int repetitions = 5;        // 轮数，取中位数
+        std::string out;            // JSON 输出文件，空为标准输出
+        std::string baseline;       // 与之前的 JSON 结果对比
+        bool list = false;
+        bool keep = false;          // 保留合成数据目录
+    };
+
+    void usage()
+    {
+        std::fprintf(stderr,
+                     "用法: DanhengServerConsole_bench [选项]\n"
+                     "  --filter <子串>       只运行名称包含子串的用例\n"
+                     "  --min-time <秒>       每轮最短运行时间（默认 0.1）\n"
+                     "  --repetitions <n>     轮数，结果取中位数（默认 5）\n"
+                     "  --out <文件>          JSON 结果写入文件（默认标准输出）\n"
+                     "  --baseline <文件>     与之前的 JSON 结果逐项对比\n"
+                     "  --work-dir <目录>     合成数据目录\n"
+                     "  --keep                结束后保留合成数据\n"
+                     "  --list                列出全部用例\n");
+    }
+
+    bool parseArgs(int argc, char **argv, Options &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            auto next = [&]() -> const char *
+            { return i + 1 < argc ? argv[++i] : nullptr; };
+            const char *value = nullptr;
+            if (arg == "--list")
+                options.list = true;
+            else if (arg == "--keep")
+                options.keep = true;
+            else if (arg == "--filter" && (value = next()))
+                options.filter = value;
+            else if (arg == "--min-time" && (value = next()))
+                options.minSeconds = std::max(0.001, std::atof(value));
+            else if (arg == "--repetitions" && (value = next()))
+                options.repetitions = std::max(1, std::atoi(value));
+            else if (arg == "--out" && (value = next()))
+                options.out = value;
+            else if (arg == "--baseline" && (value = next()))
+                options.baseline = value;
+            else if (arg == "--work-dir" && (value = next()))
+                workDirectory = value;
+            else
+                return false;
+        }
+        return true;
+    }
+
+    double secondsOf(const bench::Body &body, std::uint64_t iterations)
+    {
+        auto start = std::chrono::steady_clock::now();
+        body(iterations);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    json runCase(const bench::Case &benchCase, const Options &options)
+    {
+        // 预热一次（含用例的惰性准备），再按耗时把迭代次数放大到每轮至少 minSeconds
+        benchCase.body(1);
+        std::uint64_t iterations = 1;
+        double seconds = secondsOf(benchCase.body, iterations);
+        while (seconds < options.minSeconds)
+        {
+            const double scale = seconds > 0 ? options.minSeconds * 1.2 / seconds : 100.0;
+            iterations = static_cast<std::uint64_t>(iterations * std::clamp(scale, 2.0, 100.0));
+            seconds = secondsOf(benchCase.body, iterations);
+        }
+
+        std::vector<double> nsPerOp;
+        for (int i = 0; i < options.repetitions; ++i)
+            nsPerOp.push_back(secondsOf(benchCase.body, iterations) * 1e9 / static_cast<double>(iterations));
+        std::sort(nsPerOp.begin(), nsPerOp.end());
+        const double median = nsPerOp[nsPerOp.size() / 2];
+
+        // 用例里的备份/保存会调用 buffer()；输出线程未启动，逐个用例清掉积压
+        ConsoleOutputManager::discardQueued();
+
+        json result = {
+            {"name", benchCase.name},
+            {"iterations", iterations},
+            {"repetitions", options.repetitions},
+            {"ns_per_op", median},
+            {"ns_per_op_min", nsPerOp.front()},
+            {"ns_per_op_max", nsPerOp.back()},
+            {"ops_per_s", median > 0 ? 1e9 / median : 0.0}};
+        if (benchCase.bytesPerOp > 0)
+        {
+            result["bytes_per_op"] = benchCase.bytesPerOp;
+            result["mib_per_s"] = median > 0 ? benchCase.bytesPerOp / (1024.0 * 1024.0) / (median / 1e9) : 0.0;
+        }
+        return result;
+    }
+
+    std::string timestamp()
+    {
+        time_t now = std::time(nullptr);
+        std::tm utc{};
+#ifdef _WIN32
+        gmtime_s(&utc, &now);
+#else
+        gmtime_r(&now, &utc);
+#endif
+        char text[32];
+        std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%SZ", &utc);
+        return text;
+    }
+
+    std::string compilerName()
+    {
+#if defined(__clang__)
+        return "clang " __clang_version__;
+#elif defined(__GNUC__)
+        return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+        return "msvc " + std::to_string(_MSC_VER);
+#else
+        return "unknown";
+#endif
+    }
+
+    // 逐项打印与基准结果的差异（正值表示变慢）
+    void compare(const json &current, const std::string &baselinePath)
+    {
+        std::ifstream in(baselinePath);
+        json baseline;
+        try
+        {
+            in >> baseline;
+        }
+        catch (const std::exception &e)
+        {
+            std::fprintf(stderr, "无法读取基准结果 %s: %s\n", baselinePath.c_str(), e.what());
+            return;
+        }
+
+        std::map<std::string, double> before;
+        for (const auto &result : baseline.value("results", json::array()))
+            before[result.value("name", std::string())] = result.value("ns_per_op", 0.0);
+
+        std::fprintf(stderr, "\n%-44s %14s %14s %9s\n", "用例", "基准 ns/op", "本次 ns/op", "变化");
+        for (const auto &result : current["results"])
+        {
+            const std::string name = result["name"];
+            const double now = result["ns_per_op"];
+            auto found = before.find(name);
+            if (found == before.end() || found->second <= 0)
+            {
+                std::fprintf(stderr, "%-44s %14s %14.1f %9s\n", name.c_str(), "-", now, "新增");
+                continue;
+            }
+            std::fprintf(stderr, "%-44s %14.1f %14.1f %+8.1f%%\n", name.c_str(), found->second, now,
+                         (now / found->second - 1.0) * 100.0);
+        }
+    }
+}
+
+std::vector<bench::Case> &bench::registry()
+{
+    static std::vector<Case> cases;
+    return cases;
+}
+
+bench::Register::Register(std::string name, std::uint64_t bytesPerOp, Body body)
+{
+    registry().push_back(Case{std::move(name), bytesPerOp, std::move(body)});
+}
+
+const fs::path &bench::workDir()
+{
+    return workDirectory;
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseArgs(argc, argv, options))
+    {
+        usage();
+        return 2;
+    }
+
+    auto &cases = bench::registry();
+    std::sort(cases.begin(), cases.end(), [](const bench::Case &a, const bench::Case &b)
+              { return a.name < b.name; });
+    if (options.list)
+    {
+        for (const auto &benchCase : cases)
+            std::printf("%s\n", benchCase.name.c_str());
+        return 0;
+    }
+
+    if (workDirectory.empty())
+        workDirectory = fs::temp_directory_path() / "danheng_bench";
+    std::error_code ec;
+    fs::remove_all(workDirectory, ec);
+    fs::create_directories(workDirectory);
+
+    json report = {
+        {"benchmark", "DanhengServerConsole_bench"},
+        {"timestamp", timestamp()},
+        {"compiler", compilerName()},
+#ifdef NDEBUG
+        {"build_type", "release"},
+#else
+        {"build_type", "debug"},
+#endif
+        {"min_seconds", options.minSeconds},
+        {"results", json::array()}};
+
+    for (const auto &benchCase : cases)
+    {
+        if (!options.filter.empty() && benchCase.name.find(options.filter) == std::string::npos)
+            continue;
+        try
+        {
+            json result = runCase(benchCase, options);
+            if (result.contains("mib_per_s"))
+                std::fprintf(stderr, "%-44s %14.1f ns/op %10.1f MiB/s\n", benchCase.name.c_str(),
+                             result["ns_per_op"].get<double>(), result["mib_per_s"].get<double>());
+            else
+                std::fprintf(stderr, "%-44s %14.1f ns/op\n", benchCase.name.c_str(),
+                             result["ns_per_op"].get<double>());
+            report["results"].push_back(std::move(result));
+        }
+        catch (const std::exception &e)
+        {
+            std::fprintf(stderr, "%-44s 失败: %s\n", benchCase.name.c_str(), e.what());
+        }
+    }
+
+    if (!options.keep)
+        fs::remove_all(workDirectory, ec);
+
+    if (options.out.empty())
+        std::cout << report.dump(2) << std::endl;
+    else
+    {
+        std::ofstream out(options.out, std::ios::trunc);
+        out << report.dump(2) << std::endl;
+        if (!out)
+        {
+            std::fprintf(stderr, "无法写入 %s\n", options.out.c_str());
+            return 1;
+        }
+    }
+
+    if (!options.baseline.empty())
+        compare(report, options.baseline);
+    return 0;
+}
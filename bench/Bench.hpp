@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// 微基准测试：各 *Bench.cpp 用 bench::Register 登记用例，
+// Bench.cpp 负责预热、标定迭代次数、多轮取中位数并输出 JSON
+namespace bench
+{
+    // 执行 iterations 次被测操作；首次调用前会先以 1 次迭代预热（可在其中做惰性准备）
+    using Body = std::function<void(std::uint64_t iterations)>;
+
+    struct Case
+    {
+        std::string name;         // 分组/名称，如 "codec/base64_encode/1k"
+        std::uint64_t bytesPerOp; // 每次操作处理的字节数，用于换算吞吐；0 表示不统计
+        Body body;
+    };
+
+    std::vector<Case> &registry();
+
+    struct Register
+    {
+        Register(std::string name, std::uint64_t bytesPerOp, Body body);
+    };
+
+    // 合成数据所在目录（--work-dir，默认为系统临时目录下的 danheng_bench）
+    const fs::path &workDir();
+
+    // 阻止编译器把结果未被使用的计算优化掉
+    template <class T>
+    inline void doNotOptimize(const T &value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void *sink;
+        sink = &value;
+#endif
+    }
+}
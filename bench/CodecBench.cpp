@@ -0,0 +1,142 @@
+#include "Bench.hpp"
+#include "SessionManager.hpp"
+#include "PlayerWatcher.hpp"
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+#include <memory>
+#include <stdexcept>
+
+// Base64、RSA 加密与 MUIP 请求体构造/响应解析：每条命令都要走一遍的 CPU 路径
+namespace
+{
+    std::string randomBytes(std::size_t size)
+    {
+        std::string data(size, '\0');
+        std::uint32_t x = 2463534242u;
+        for (auto &c : data)
+        {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            c = static_cast<char>(x);
+        }
+        return data;
+    }
+
+    // 生成一次 RSA-2048 密钥，导出服务器下发的那种 PEM 公钥
+    const std::string &publicKeyPem()
+    {
+        static const std::string pem = []
+        {
+            std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)> ctx(EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr),
+                                                                           EVP_PKEY_CTX_free);
+            EVP_PKEY *key = nullptr;
+            if (!ctx || EVP_PKEY_keygen_init(ctx.get()) <= 0 ||
+                EVP_PKEY_CTX_set_rsa_keygen_bits(ctx.get(), 2048) <= 0 ||
+                EVP_PKEY_keygen(ctx.get(), &key) <= 0)
+                throw std::runtime_error("RSA 密钥生成失败");
+            std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> owned(key, EVP_PKEY_free);
+
+            std::unique_ptr<BIO, decltype(&BIO_free)> bio(BIO_new(BIO_s_mem()), BIO_free);
+            PEM_write_bio_PUBKEY(bio.get(), key);
+            char *data = nullptr;
+            long size = BIO_get_mem_data(bio.get(), &data);
+            return std::string(data, static_cast<std::size_t>(size));
+        }();
+        return pem;
+    }
+
+    const std::string sessionId = "6f1c2e8a-31d4-4b7e-9a55-0c7f2d9e4b13";
+
+    std::string createSessionResponse()
+    {
+        json response = {
+            {"code", 0},
+            {"message", "Success"},
+            {"data", {{"sessionId", sessionId}, {"rsaPublicKey", publicKeyPem()}, {"expireTimeStamp", 1760000000}}}};
+        return response.dump();
+    }
+
+    std::string playerInfoResponse()
+    {
+        json response = {
+            {"code", 0},
+            {"message", "Success"},
+            {"data", {{"uid", 10001}, {"name", "开拓者"}, {"signature", "星穹列车，下一站"}, {"headIconId", 208001},
+                      {"curPlaneId", 20101}, {"curFloorId", 20101001}, {"playerStatus", 1}, {"playerSubStatus", 0},
+                      {"stamina", 240}, {"recoveryStamina", 2}, {"assistAvatarList", {1102, 1205, 1006}},
+                      {"displayAvatarList", {1102, 1205, 1006, 1212}}, {"acceptedSubMissionList", json::array()},
+                      {"finishedMainMissionIdList", {1000101, 1000102, 1000103, 1000201, 1000202}}}}};
+        return response.dump();
+    }
+
+    template <std::size_t Size>
+    void encodeBody(std::uint64_t n)
+    {
+        static const std::string input = randomBytes(Size);
+        for (std::uint64_t i = 0; i < n; ++i)
+            bench::doNotOptimize(SessionManager::base64Encode(input));
+    }
+
+    template <std::size_t Size>
+    void decodeBody(std::uint64_t n)
+    {
+        static const std::string input = SessionManager::base64Encode(randomBytes(Size));
+        for (std::uint64_t i = 0; i < n; ++i)
+            bench::doNotOptimize(SessionManager::base64Decode(input));
+    }
+
+    bench::Register encode1k("codec/base64_encode/1k", 1024, encodeBody<1024>);
+    bench::Register encode64k("codec/base64_encode/64k", 64 * 1024, encodeBody<64 * 1024>);
+    bench::Register decode1k("codec/base64_decode/1k", 1024, decodeBody<1024>);
+    bench::Register decode64k("codec/base64_decode/64k", 64 * 1024, decodeBody<64 * 1024>);
+
+    bench::Register encryptAdminKey("codec/encrypt/rsa2048", 0, [](std::uint64_t n)
+                                    {
+        const std::string &pem = publicKeyPem();
+        for (std::uint64_t i = 0; i < n; ++i)
+            bench::doNotOptimize(encrypt(pem, "admin-key-0123456789")); });
+
+    bench::Register buildStatus("muip/build_server_status_body", 0, [](std::uint64_t n)
+                                {
+        for (std::uint64_t i = 0; i < n; ++i)
+            bench::doNotOptimize(SessionManager::buildServerStatusBody(sessionId)); });
+
+    bench::Register buildPlayerInfo("muip/build_player_info_body", 0, [](std::uint64_t n)
+                                    {
+        for (std::uint64_t i = 0; i < n; ++i)
+            bench::doNotOptimize(SessionManager::buildPlayerInfoBody(sessionId, "10001")); });
+
+    // 含一次 RSA 加密，代表一条命令提交在本地的全部开销
+    bench::Register buildCommand("muip/build_command_body", 0, [](std::uint64_t n)
+                                 {
+        const std::string &pem = publicKeyPem();
+        for (std::uint64_t i = 0; i < n; ++i)
+            bench::doNotOptimize(SessionManager::buildCommandBody(sessionId, pem, "relic 61011 1 4:2 5:3 l15 x1", "10001")); });
+
+    bench::Register parseSession("muip/parse_create_session", 0, [](std::uint64_t n)
+                                 {
+        static const std::string response = createSessionResponse();
+        for (std::uint64_t i = 0; i < n; ++i)
+            bench::doNotOptimize(SessionManager::parseResponse(response)); });
+
+    bench::Register parsePlayerInfo("muip/parse_player_info", 0, [](std::uint64_t n)
+                                    {
+        static const std::string response = playerInfoResponse();
+        for (std::uint64_t i = 0; i < n; ++i)
+            bench::doNotOptimize(SessionManager::parseResponse(response)); });
+
+    // 监视模式的一轮比较：一处数值变化的玩家信息
+    bench::Register diffPlayerInfo("watch/diff_player_info", 0, [](std::uint64_t n)
+                                   {
+        static const json before = SessionManager::parseResponse(playerInfoResponse())["data"];
+        static const json after = []
+        {
+            json changed = before;
+            changed["watch_bench_counter"] = 1;
+            return changed;
+        }();
+        for (std::uint64_t i = 0; i < n; ++i)
+            bench::doNotOptimize(PlayerWatcher::diff(before, after)); });
+}
@@ -0,0 +1,77 @@
+#include "Bench.hpp"
+#include "ConsoleManager.hpp"
+#include "CommandTemplate.hpp"
+#include "RelicSimulator.hpp"
+
+// 遗器构造（含 buildFullId 拼接 ID）、命令文本拼接与模板展开
+namespace
+{
+    bench::Register construct("relic/construct", 0, [](std::uint64_t n)
+                              {
+        for (std::uint64_t i = 0; i < n; ++i)
+        {
+            Relic relic(Relic::Type::Tunnel, 5, "61", 1, "1", "4:2 5:3 6:1", "l15");
+            bench::doNotOptimize(relic.getId());
+        } });
+
+    bench::Register random("relic/random", 0, [](std::uint64_t n)
+                           {
+        for (std::uint64_t i = 0; i < n; ++i)
+        {
+            Relic relic = Relic::Random(Relic::Type::Plane, 5, "05", 5, 1, Relic::maxMainTag(5));
+            bench::doNotOptimize(relic.getId());
+        } });
+
+    bench::Register relicCommand("command/relic_string", 0, [](std::uint64_t n)
+                                 {
+        const Relic relic(Relic::Type::Tunnel, 5, "61", 3, "5", "4:2 5:3 6:1", "l15");
+        for (std::uint64_t i = 0; i < n; ++i)
+            bench::doNotOptimize(ConsoleManager::buildRelicCommand(relic, 1)); });
+
+    bench::Register giveCommand("command/give_string", 0, [](std::uint64_t n)
+                                {
+        for (std::uint64_t i = 0; i < n; ++i)
+            bench::doNotOptimize(ConsoleManager::buildGiveCommand("1001", 10)); });
+
+    // 复用缓冲区展开一条命令，对照上面每次构造新字符串的写法
+    bench::Register templateExpand("command/template_expand", 0, [](std::uint64_t n)
+                                   {
+        const CommandTemplate tpl("relic {id} {main} {sub} {level} x{n}");
+        const std::string_view values[] = {"61031", "5", "4:2 5:3 6:1", "l15", "1"};
+        std::string out;
+        for (std::uint64_t i = 0; i < n; ++i)
+        {
+            tpl.expand(values, out);
+            bench::doNotOptimize(out);
+        } });
+
+    // 1000 条范围展开（每次迭代一整批）
+    bench::Register templateRange("command/template_range/1000", 0, [](std::uint64_t n)
+                                  {
+        const CommandTemplate tpl("give {id} x{n}");
+        const TemplateBindings bindings = TemplateBindings::parse("id=1001..2000 n=1", tpl);
+        for (std::uint64_t i = 0; i < n; ++i)
+            bindings.forEach(tpl, [](const std::string &command)
+                             {
+                bench::doNotOptimize(command);
+                return true; }); });
+
+    // 一次完整模拟：100 万件躯干候选取前 5，单线程与全部线程
+    void simulateBody(unsigned threads, std::uint64_t n)
+    {
+        RelicSimulator::Options options;
+        options.relicId = "61";
+        options.partId = 3;
+        options.threads = threads;
+        for (std::uint64_t i = 0; i < n; ++i)
+        {
+            options.seed = i;
+            bench::doNotOptimize(RelicSimulator::run(options).best.front().score);
+        }
+    }
+
+    bench::Register simulateSingle("relic/simulate/1m/1_thread", 0, [](std::uint64_t n)
+                                   { simulateBody(1, n); });
+    bench::Register simulateAll("relic/simulate/1m/all_threads", 0, [](std::uint64_t n)
+                                { simulateBody(0, n); });
+}
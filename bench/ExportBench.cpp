@@ -0,0 +1,84 @@
+#include "Bench.hpp"
+#include "PlayerExport.hpp"
+
+// 玩家导出：1 万条 player_information 响应写入列式文件，以及读回还原为 JSON
+namespace
+{
+    constexpr int Players = 10000;
+
+    const std::vector<json> &responses()
+    {
+        static const std::vector<json> list = []
+        {
+            std::vector<json> out;
+            for (int i = 0; i < Players; ++i)
+                out.push_back({{"code", 0},
+                               {"message", "Success"},
+                               {"data", {{"uid", 10001 + i},
+                                         {"name", "Trailblazer" + std::to_string(i % 50)},
+                                         {"signature", i % 3 ? "" : "你好"},
+                                         {"level", 1 + i % 70},
+                                         {"worldLevel", i % 7},
+                                         {"stamina", i * 37 % 241},
+                                         {"credit", 100000 + i * 13},
+                                         {"curFloorId", 20101001 + i % 40},
+                                         {"displayAvatarList", {1001, 1002 + i % 5, 1201}},
+                                         {"online", i % 4 == 0}}}});
+            return out;
+        }();
+        return list;
+    }
+
+    std::uint64_t rawBytes()
+    {
+        std::uint64_t total = 0;
+        for (const auto &response : responses())
+            total += response.dump().size();
+        return total;
+    }
+
+    const fs::path &exportFile()
+    {
+        static const fs::path path = []
+        {
+            const fs::path file = bench::workDir() / "players.dhpx";
+            fs::create_directories(file.parent_path());
+            PlayerExport::Writer writer;
+            writer.open(file);
+            for (int i = 0; i < Players; ++i)
+                writer.add(10001 + i, responses()[i]);
+            writer.close();
+            return file;
+        }();
+        return path;
+    }
+
+    bench::Register write("export/write/10k", rawBytes(), [](std::uint64_t n)
+                          {
+        const fs::path file = bench::workDir() / "players_write.dhpx";
+        fs::create_directories(file.parent_path());
+        for (std::uint64_t i = 0; i < n; ++i)
+        {
+            PlayerExport::Writer writer;
+            writer.open(file);
+            for (int p = 0; p < Players; ++p)
+                writer.add(10001 + p, responses()[p]);
+            writer.close();
+            bench::doNotOptimize(writer.bytesWritten());
+        } });
+
+    bench::Register read("export/read/10k", rawBytes(), [](std::uint64_t n)
+                         {
+        const fs::path &file = exportFile();
+        for (std::uint64_t i = 0; i < n; ++i)
+        {
+            PlayerExport::Reader reader;
+            std::string error;
+            std::vector<json> rows;
+            reader.open(file, error);
+            std::size_t total = 0;
+            while (reader.next(rows, error))
+                total += rows.size();
+            bench::doNotOptimize(total);
+        } });
+}
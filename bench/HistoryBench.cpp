@@ -0,0 +1,73 @@
+#include "Bench.hpp"
+#include "CommandHistory.hpp"
+#include <fstream>
+#include <thread>
+
+// 命令历史：20 万条的历史文件打开（只映射并扫描换行）与索引建好后的反向搜索
+namespace
+{
+    constexpr int HistoryEntries = 200000;
+
+    const fs::path &historyFile()
+    {
+        static const fs::path path = []
+        {
+            const fs::path file = bench::workDir() / "command_history.txt";
+            fs::create_directories(file.parent_path());
+            std::ofstream out(file, std::ios::binary | std::ios::trunc);
+            for (int i = 0; i < HistoryEntries; ++i)
+            {
+                switch (i % 4)
+                {
+                case 0:
+                    out << "give " << 1000 + i % 5000 << " x" << i % 100 + 1 << '\n';
+                    break;
+                case 1:
+                    out << "relic 6" << i % 300 << "5 " << i % 10 << " 4:2 5:3 6:1 l15 x1\n";
+                    break;
+                case 2:
+                    out << "mail send " << i << " 星琼 x" << i % 1000 << '\n';
+                    break;
+                default:
+                    out << "setlevel " << i % 80 << " uid" << 10000 + i % 20000 << '\n';
+                    break;
+                }
+            }
+            return file;
+        }();
+        return path;
+    }
+
+    void openIndexed()
+    {
+        CommandHistory::open(historyFile());
+        while (!CommandHistory::indexed())
+            std::this_thread::yield();
+    }
+
+    bench::Register open("history/open/200k", 0, [](std::uint64_t n)
+                         {
+        const fs::path &path = historyFile();
+        for (std::uint64_t i = 0; i < n; ++i)
+        {
+            CommandHistory::open(path);
+            bench::doNotOptimize(CommandHistory::size());
+        }
+        CommandHistory::close(); });
+
+    // 搜索词较少见：三元组候选很少
+    bench::Register searchRare("history/search_rare/200k", 0, [](std::uint64_t n)
+                               {
+        if (CommandHistory::size() != HistoryEntries || !CommandHistory::indexed())
+            openIndexed();
+        for (std::uint64_t i = 0; i < n; ++i)
+            bench::doNotOptimize(CommandHistory::search("mail send 19999", CommandHistory::size())); });
+
+    // 搜索词很常见：候选是大部分不同命令
+    bench::Register searchCommon("history/search_common/200k", 0, [](std::uint64_t n)
+                                 {
+        if (CommandHistory::size() != HistoryEntries || !CommandHistory::indexed())
+            openIndexed();
+        for (std::uint64_t i = 0; i < n; ++i)
+            bench::doNotOptimize(CommandHistory::search("4:2 5:3", CommandHistory::size())); });
+}
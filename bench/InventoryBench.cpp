@@ -0,0 +1,44 @@
+#include "Bench.hpp"
+#include "InventoryReconciler.hpp"
+
+// 背包补齐：10 万种物品的规格对照 99% 已满足的当前持有量计算缺口，以及从 player_information 中取出持有量
+namespace
+{
+    constexpr std::uint32_t SpecItems = 100000;
+
+    const InventoryReconciler::Counts &desired()
+    {
+        static const InventoryReconciler::Counts counts = []
+        {
+            InventoryReconciler::Counts out;
+            for (std::uint32_t i = 0; i < SpecItems; ++i)
+                out[100000 + i] = 1 + i % 50;
+            return out;
+        }();
+        return counts;
+    }
+
+    const json &playerData()
+    {
+        static const json data = []
+        {
+            json items = json::array();
+            for (std::uint32_t i = 0; i < SpecItems; ++i)
+                if (i % 100 != 0)
+                    items.push_back({{"itemId", 100000 + i}, {"count", 1 + i % 50}});
+            return json{{"uid", 10001}, {"credit", 5000000}, {"itemList", std::move(items)}};
+        }();
+        return data;
+    }
+
+    bench::Register diff("inventory/diff/100k", 0, [](std::uint64_t n)
+                         {
+        const auto current = InventoryReconciler::parseHoldings(playerData(), InventoryReconciler::defaultFields());
+        for (std::uint64_t i = 0; i < n; ++i)
+            bench::doNotOptimize(InventoryReconciler::diff(desired(), current, 1 << 30).gives.size()); });
+
+    bench::Register holdings("inventory/parse_holdings/100k", 0, [](std::uint64_t n)
+                             {
+        for (std::uint64_t i = 0; i < n; ++i)
+            bench::doNotOptimize(InventoryReconciler::parseHoldings(playerData(), InventoryReconciler::defaultFields()).counts.size()); });
+}
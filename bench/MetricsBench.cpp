@@ -0,0 +1,67 @@
+#include "Bench.hpp"
+#include "Metrics.hpp"
+#include <thread>
+#include <vector>
+
+// 多线程同时更新同一个指标的开销：分片后各线程写不同的缓存行，线程数增加时单次开销应基本不变
+namespace
+{
+    template <class Update>
+    void hammer(std::uint64_t n, unsigned threads, Update update)
+    {
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t)
+            workers.emplace_back([&, t]
+                                 {
+                const std::uint64_t count = n / threads + (t < n % threads ? 1 : 0);
+                for (std::uint64_t i = 0; i < count; ++i)
+                    update(i); });
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    Metrics::Counter &benchCounter()
+    {
+        static Metrics::Counter &counter = Metrics::counter("bench_counter_total", "基准测试计数器");
+        return counter;
+    }
+
+    Metrics::Histogram &benchHistogram()
+    {
+        static Metrics::Histogram &histogram =
+            Metrics::histogram("bench_duration_seconds", "基准测试直方图", Metrics::requestBuckets());
+        return histogram;
+    }
+
+    void counterAdd(std::uint64_t n, unsigned threads)
+    {
+        Metrics::Counter &counter = benchCounter();
+        hammer(n, threads, [&](std::uint64_t)
+               { counter.add(); });
+        bench::doNotOptimize(counter.value());
+    }
+
+    void histogramObserve(std::uint64_t n, unsigned threads)
+    {
+        Metrics::Histogram &histogram = benchHistogram();
+        hammer(n, threads, [&](std::uint64_t i)
+               { histogram.observe(static_cast<double>(i % 1000) * 0.0001); });
+    }
+
+    bench::Register counter1("metrics/counter_add/threads:1", 0, [](std::uint64_t n)
+                             { counterAdd(n, 1); });
+    bench::Register counter4("metrics/counter_add/threads:4", 0, [](std::uint64_t n)
+                             { counterAdd(n, 4); });
+    bench::Register histogram1("metrics/histogram_observe/threads:1", 0, [](std::uint64_t n)
+                               { histogramObserve(n, 1); });
+    bench::Register histogram4("metrics/histogram_observe/threads:4", 0, [](std::uint64_t n)
+                               { histogramObserve(n, 4); });
+
+    // 渲染全部指标为 Prometheus 文本（导出线程每个周期做一次）
+    bench::Register render("metrics/render_prometheus", 0, [](std::uint64_t n)
+                           {
+        benchCounter();
+        benchHistogram();
+        for (std::uint64_t i = 0; i < n; ++i)
+            bench::doNotOptimize(Metrics::renderPrometheus()); });
+}
@@ -0,0 +1,106 @@
+#include "Bench.hpp"
+#include "ConsoleOutputManager.hpp"
+#include "Dashboard.hpp"
+#include <limits>
+#include <thread>
+
+// 多线程同时调用 buffer() 时的入队开销；输出线程不启动，测的是生产者一侧的锁竞争
+namespace
+{
+    const std::vector<std::string> &messages()
+    {
+        static const std::vector<std::string> texts = []
+        {
+            std::vector<std::string> all;
+            for (int i = 0; i < 4096; ++i)
+                all.push_back("[database] 自动保存完成：#" + std::to_string(i % 5) + "（copy_file_range，" +
+                              std::to_string(i) + " MiB）");
+            return all;
+        }();
+        return texts;
+    }
+
+    // threads 个线程共做 n 次 buffer()；distinct 为 false 时全部是同一条消息（走重复合并路径）
+    void produce(std::uint64_t n, unsigned threads, bool distinct)
+    {
+        ConsoleOutputManager::configure(std::numeric_limits<std::size_t>::max(), OverflowPolicy::Block);
+        const auto &texts = messages();
+        std::vector<std::thread> producers;
+        for (unsigned t = 0; t < threads; ++t)
+            producers.emplace_back([&, t]
+                                   {
+                const std::uint64_t count = n / threads + (t < n % threads ? 1 : 0);
+                for (std::uint64_t i = 0; i < count; ++i)
+                    ConsoleOutputManager::buffer(distinct ? texts[(i * threads + t) % texts.size()] : texts[0],
+                                                 MessageType::Info); });
+        for (auto &producer : producers)
+            producer.join();
+        ConsoleOutputManager::discardQueued();
+    }
+
+    bench::Register distinct1("output/buffer/threads:1", 0, [](std::uint64_t n)
+                              { produce(n, 1, true); });
+    bench::Register distinct4("output/buffer/threads:4", 0, [](std::uint64_t n)
+                              { produce(n, 4, true); });
+    bench::Register distinct8("output/buffer/threads:8", 0, [](std::uint64_t n)
+                              { produce(n, 8, true); });
+    bench::Register repeated4("output/buffer_repeated/threads:4", 0, [](std::uint64_t n)
+                              { produce(n, 4, false); });
+}
+
+
+// 仪表盘一帧：120×40，只有时钟与一个任务的进度在变；测的是画进离屏缓冲加比较出差异的开销
+namespace
+{
+    Dashboard::Snapshot dashboardSnapshot()
+    {
+        Dashboard::Snapshot s;
+        s.now = 1760000000;
+        s.serverUrl = "http://127.0.0.1:8080";
+        s.statusKnown = s.statusOk = true;
+        s.status = {{"onlinePlayers", json::array({1, 2, 3})}, {"usedMemory", 812.0}, {"maxMemory", 4096.0}, {"programUsedMemory", 305.0}};
+        s.statusLatencyMs = 4;
+        s.uid = "10001";
+        for (int i = 1; i <= 6; ++i)
+        {
+            JobManager::Info job;
+            job.id = i;
+            job.title = "随机遗器礼包 x50";
+            job.uid = "1000" + std::to_string(i);
+            job.state = i < 3 ? JobManager::State::Running : JobManager::State::Done;
+            job.total = 50;
+            job.done = i < 3 ? 20 : 50;
+            job.seconds = 12.5;
+            job.perSecond = 4.0;
+            s.jobs.push_back(job);
+        }
+        AutoSaver::Status save;
+        save.name = "database";
+        save.watched = true;
+        save.nextSaveSeconds = 120;
+        save.last.savedAt = 1759999000;
+        save.last.slot = 2;
+        save.last.bytesWritten = 12 << 20;
+        s.autosave.push_back(save);
+        for (int i = 0; i < 30; ++i)
+            s.messages.emplace_back("[#" + std::to_string(i % 6 + 1) + "] 遗器已发放：61031 主词条 5 副词条 4:2 5:3 6:1", MessageType::Success);
+        return s;
+    }
+
+    bench::Register dashboardFrame("output/dashboard_frame/120x40", 0, [](std::uint64_t n)
+                                   {
+        Dashboard::Snapshot s = dashboardSnapshot();
+        ScreenBuffer front(120, 40), back(120, 40);
+        Dashboard::render(s, front);
+        std::string out;
+        for (std::uint64_t i = 0; i < n; ++i)
+        {
+            ++s.now;
+            s.jobs[0].done = static_cast<int>(i % 50);
+            Dashboard::render(s, back);
+            out.clear();
+            ScreenBuffer::diff(front, back, out);
+            bench::doNotOptimize(out);
+            std::swap(front, back);
+        } });
+}
@@ -1,41 +1,91 @@
 #pragma once
-#include <filesystem>
-#include <string>
-#include <thread>
-#include <mutex>
+#include "BackupJob.hpp"
+#include "TimerWheel.hpp"
+#include <chrono>
 #include <condition_variable>
-#include <atomic>
-
-namespace fs = std::filesystem;
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
-// 自动保存器：托管方式使用，只需调用 AutoSaver::start(...)
+// 自动保存调度器：托管方式使用，addJob(...) 注册任务后 start()
+// 所有任务由同一个调度线程按时间轮驱动，串行执行；等待使用条件变量，
+// 因此 stop() 与 triggerSaveNow() 都会立即唤醒调度线程
+// 开启 watch 的任务由 FileWatcher 报告变化：写入静默 debounce 秒后保存，
+// 定时间隔只在有未保存的变化时才触发保存（最长陈旧时间兜底），空闲时不产生任何备份 I/O
 class AutoSaver
 {
 public:
-    // 启动自动保存线程（仅调用一次）
-    static void start(const fs::path& sourceFile,
-                      const fs::path& saveRootDir,
-                      int intervalSeconds,
-                      int slotCount,
-                      bool saveImmediately = true);
+    // 注册一个备份任务，返回任务编号；可在 start() 前后调用
+    static int addJob(BackupJob::Options options);
+
+    // 启动调度线程（仅第一次调用生效）
+    static void start();
+
+    // 让所有任务（或指定编号的任务）尽快保存一次，不等待完成
+    static void triggerSaveNow(int jobId = -1);
+
+    // 停止调度线程：正在进行的保存被中止（删除其临时文件），随后返回
+    static void stop();
 
-    // 手动触发保存一次
-    static void triggerSaveNow();
+    // 已注册任务的配置，下标即任务编号
+    static std::vector<BackupJob::Options> jobList();
+
+    // 任务的当前状态，下标即任务编号（仪表盘显示用，不等待进行中的保存）
+    struct Status
+    {
+        std::string name;         // 任务名，未命名时为源文件名
+        bool watched = false;     // 监视已生效
+        bool dirty = false;       // 有尚未保存的变化
+        bool saving = false;      // 正在保存
+        int nextSaveSeconds = -1; // 距下一次定时保存的秒数
+        BackupJob::Outcome last;
+    };
+    static std::vector<Status> status();
+
+    // 持有任务的保存锁执行 action（校验、恢复槽位用），编号无效时返回 false
+    static bool withJob(int jobId, const std::function<void(BackupJob &)> &action);
 
 private:
-    static std::atomic<bool> isRunning;
-    static std::thread workerThread;
-    static std::mutex fileMutex;
+    using Clock = std::chrono::steady_clock;
+
+    static void run();                       // 调度线程
+    static std::uint64_t currentTick();      // 自启动起经过的秒数
+    static std::uint64_t tickAfter(Clock::time_point time); // 不早于 time 的第一个刻度
+    static void schedule(int jobId);         // 按任务间隔排入下一次（需持有 schedulerMutex）
+    static void notifyChanged(int jobId);    // FileWatcher 回调：源发生变化
+
+    // 时间轮中的定时器编号 = 任务编号 × 2 + 种类
+    enum TimerKind
+    {
+        IntervalTimer = 0,
+        DebounceTimer = 1
+    };
+
+    // 监视模式下每个任务的变化状态
+    struct JobState
+    {
+        bool watched = false;         // 监视已生效
+        bool dirty = false;           // 有尚未保存的变化
+        bool debouncePending = false; // 时间轮中已有该任务的去抖定时器
+        Clock::time_point lastChange; // 最近一次变化的时刻（比刻度精细，避免把刻度末尾的写入误判为已静默）
+        Clock::time_point nextInterval; // 间隔定时器的到期时刻
+        bool saving = false;
+    };
 
-    static fs::path source;
-    static fs::path saveRoot;
-    static int interval;
-    static int slotIndex;
-    static int slotCount;
-    static bool saveImmediately;
+    static std::mutex schedulerMutex;
+    static std::condition_variable schedulerNotifier;
+    static std::thread schedulerThread;
+    static bool running;
+    static bool stopping;
+    static bool wakeup;   // 任务表或待执行队列有变化，需要重新计算等待时刻
+    static Clock::time_point epoch;
 
-    static void run();           // 后台定时保存线程
-    static void performSave();   // 具体保存操作
+    static std::vector<std::unique_ptr<BackupJob>> jobs;
+    static std::vector<JobState> states;
+    static std::vector<int> pendingNow; // 等待立即执行的任务编号
+    static TimerWheel wheel;
 
     // 自动析构清理器：在程序结束时自动停止线程
     class Finalizer {
@@ -43,4 +93,4 @@ private:
         ~Finalizer();
     };
     static Finalizer finalizer;
-};
\ No newline at end of file
+};
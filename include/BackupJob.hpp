@@ -0,0 +1,153 @@
+#pragma once
+#include "IoThrottle.hpp"
+#include "Metrics.hpp"
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <cstdint>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// 保存方式
+enum class SaveMode
+{
+    Copy,        // 整文件复制到槽位
+    Incremental, // 内容定义分块，块去重存入共享块存储，槽位只保存清单
+    Compressed,  // 多线程分块压缩为多成员 gzip 快照
+    Sqlite       // SQLite 在线备份 API，得到一致的数据库镜像（含 WAL）
+};
+
+// 槽位清单：每次保存成功后写入 slot_N/<源名>.slot.json，记录保存时间、源状态与内容校验和
+struct SlotManifest
+{
+    struct Entry
+    {
+        std::string path;      // 槽位内的产物路径（相对 slot_N），如 db.gz、logs/a.log
+        std::uint64_t size = 0; // 还原后内容的字节数
+        std::uint32_t crc = 0;  // 还原后内容的 CRC32
+        std::int64_t mtime = 0; // 目录方式：保存时源文件的修改时间，下次保存据此判断能否硬链接
+    };
+
+    std::string job;
+    std::string mode;           // copy / incremental / compressed / sqlite / directory
+    int slot = 0;
+    std::int64_t savedAt = 0;   // Unix 时间（秒）
+    std::uint64_t sourceSize = 0;
+    std::int64_t sourceMtime = 0;
+    double seconds = 0;         // 保存耗时
+    std::uint64_t bytesWritten = 0; // 本次实际写入槽位/块存储的字节数
+    std::vector<Entry> files;
+};
+
+// 一个备份任务：一个源（文件或目录）按固定间隔轮流保存到 destination/slot_N
+// 不自带线程，由 AutoSaver 的调度线程串行调用 save()
+class BackupJob
+{
+public:
+    struct Options
+    {
+        std::string name;         // 任务名，用于输出
+        fs::path source;          // 源文件或目录
+        fs::path destination;     // 保存根目录
+        int intervalSeconds = 300;
+        int slotCount = 5;        // 轮换槽位数，小于 1 时按 1 处理
+        bool saveImmediately = true;
+        bool watch = false;       // 监视源的变化，写入停止 debounceSeconds 秒后保存；间隔作为最长陈旧时间兜底
+        int debounceSeconds = 2;
+        SaveMode mode = SaveMode::Copy;
+        int compressLevel = 6;       // 压缩模式：zlib 级别 1–9
+        unsigned compressThreads = 0; // 压缩模式：线程数，0 表示硬件并发数
+        unsigned copyThreads = 4;     // 目录源：并行复制的线程数，0 表示硬件并发数
+        int sqlitePagesPerStep = 64;  // SQLite 模式：每步拷贝页数
+        int sqlitePauseMs = 5;        // SQLite 模式：步间停顿毫秒数
+        double maxMegabytesPerSecond = 0; // 读写限速（MB/s），0 表示不限
+        bool lowIoPriority = false;       // 保存期间把调度线程的 I/O 优先级降为空闲级
+    };
+
+    explicit BackupJob(Options options);
+
+    const Options &options() const { return opts; }
+
+    // 执行一次保存；源未变化时直接返回，失败时通过 buffer() 报告
+    // 成功后在槽位中写入清单（见 BackupManager）
+    void save();
+
+    // 中止进行中的保存（可从其他线程调用，不等待保存锁）：限速等待立即返回，
+    // 复制循环随即失败并删除临时文件；之后的保存同样立即中止，直到 resume()
+    void cancel() { throttle.cancel(); }
+    void resume() { throttle.reset(); }
+
+    // 保存期间持有；校验或恢复槽位前加锁，避免读到写了一半的槽位
+    std::mutex &mutex() { return saveMutex; }
+
+    static const char *modeName(SaveMode mode);
+
+    // 最近一次保存的结果；有单独的锁，保存进行中也可读取（仪表盘显示用）
+    struct Outcome
+    {
+        std::int64_t savedAt = 0;       // 最近一次写入槽位的 Unix 时间，0 表示启动以来尚未写入
+        int slot = -1;
+        double seconds = 0;
+        std::uint64_t bytesWritten = 0;
+        std::string error;              // 最近一次失败的原因，之后保存成功时清空
+    };
+
+    Outcome outcome() const;
+
+private:
+    // 最近一次成功保存时源的状态，用于跳过未变化的保存
+    struct SavedState
+    {
+        bool valid = false;
+        std::uintmax_t size = 0;
+        std::int64_t mtime = 0;
+        std::string hash; // 文件为内容哈希；目录为文件列表（路径/大小/修改时间）指纹
+    };
+
+    // 目录源中的一个普通文件
+    struct TreeEntry
+    {
+        fs::path relative;
+        std::uintmax_t size = 0;
+        std::int64_t mtime = 0;
+    };
+    using Tree = std::vector<TreeEntry>;
+
+    static Tree listTree(const fs::path &root);           // 遍历一次，按相对路径排序
+    static std::string fingerprint(const Tree &tree);    // 路径/大小/修改时间指纹
+
+    // 各保存方式把写入槽位的产物登记到 files（还原后的大小与 CRC32）
+    using ManifestFiles = std::vector<SlotManifest::Entry>;
+    bool saveCopy(const fs::path &slotDir, SavedState &state, ManifestFiles &files);        // 整文件复制
+    bool saveIncremental(const fs::path &slotDir, SavedState &state, ManifestFiles &files); // 分块增量保存
+    bool saveCompressed(const fs::path &slotDir, SavedState &state, ManifestFiles &files);  // 并行压缩快照
+    bool saveSqlite(const fs::path &slotDir, SavedState &state, ManifestFiles &files);      // SQLite 在线备份
+    bool saveDirectory(const fs::path &slotDir, const Tree &tree, ManifestFiles &files);    // 目录树并行快照
+
+    std::string label() const; // 输出前缀，如 "[database] "
+
+    void recordSave(const SlotManifest &manifest) const; // 追加一行到 destination/save_log.csv
+
+    // 本任务的指标，标签 job=任务名，构造时注册
+    struct Instruments
+    {
+        explicit Instruments(const std::string &job);
+        Metrics::Counter &saves;       // 写入了槽位的保存
+        Metrics::Counter &skipped;     // 源未变化而跳过
+        Metrics::Counter &failures;    // 源缺失或保存抛出异常
+        Metrics::Counter &bytes;
+        Metrics::Histogram &duration;
+        Metrics::Gauge &lastSuccess;   // 最近一次成功写入的 Unix 时间
+    };
+
+    Options opts;
+    IoThrottle throttle;
+    Instruments metrics;
+    std::uint64_t bytesWritten = 0; // 由各 save* 填写
+    std::mutex saveMutex;
+    int slotIndex = 0;
+    SavedState lastSaved;
+    mutable std::mutex outcomeMutex;
+    Outcome lastOutcome;
+};
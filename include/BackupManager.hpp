@@ -0,0 +1,44 @@
+#pragma once
+#include "BackupJob.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+class IoThrottle;
+
+// 备份槽位的清单读写、并行校验与原子恢复
+class BackupManager
+{
+public:
+    struct SlotStatus
+    {
+        int slot = 0;
+        bool hasManifest = false;
+        bool valid = false;
+        SlotManifest manifest;
+        std::string error;      // 校验失败原因
+    };
+
+    static fs::path manifestPath(const fs::path &slotDir, const fs::path &source);
+    static bool writeManifest(const fs::path &path, const SlotManifest &manifest);
+    static bool readManifest(const fs::path &path, SlotManifest &manifest);
+
+    // 分块并行计算 CRC32，用 crc32_combine 合并；threads 为 0 时取硬件并发数，为 1 时单线程流式计算
+    // 给出 throttle 时读取计入限速，被取消时返回 false
+    static bool crc32File(const fs::path &file, unsigned threads, std::uint32_t &crc, std::uint64_t &size,
+                          IoThrottle *throttle = nullptr);
+
+    // 并行校验任务的全部槽位（每个槽位一个线程），结果按槽位编号排列
+    static std::vector<SlotStatus> verifyAll(const BackupJob::Options &options);
+
+    // 最近一次保存且校验通过的槽位，没有时返回 -1
+    static int newestValid(const std::vector<SlotStatus> &slots);
+
+    // 从槽位恢复：边解码边校验写入临时文件/目录，校验通过后原子替换源
+    // 失败时源保持原样；仅替换后清理失败这类例外会在 error 中说明源已被修改
+    // SQLite 源仍被其他连接使用（WAL 读写或未结束的事务）时拒绝恢复
+    static bool restore(const BackupJob::Options &options, int slot, std::string &error);
+};
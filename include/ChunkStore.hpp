@@ -0,0 +1,70 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class IoThrottle;
+struct evp_md_ctx_st;
+
+namespace fs = std::filesystem;
+
+// 内容定义分块（FastCDC 风格 Gear 滚动哈希）的去重块存储
+// 每个块以 SHA-256 命名，只存一份；槽位只保存引用这些块的清单
+class ChunkStore
+{
+public:
+    struct ChunkRef
+    {
+        std::string   hash; // 块内容的 SHA-256（十六进制）
+        std::uint32_t size;
+    };
+
+    struct Result
+    {
+        std::vector<ChunkRef> chunks;
+        std::string   fileHash;       // 整个文件的 SHA-256
+        std::uint32_t fileCrc = 0;    // 整个文件的 CRC32，写入槽位清单用于校验
+        std::uint64_t fileSize = 0;
+        std::size_t   newChunks = 0;  // 本次新写入的块数
+        std::uint64_t newBytes = 0;   // 本次新写入的字节数
+    };
+
+    // 流式读取并分块，把存储中尚不存在的块写入 storeDir；throttle 可选，按读取量限速
+    static bool storeFile(const fs::path &source, const fs::path &storeDir, Result &out,
+                          IoThrottle *throttle = nullptr);
+
+    // 按块列表把文件还原到 target
+    static bool materialize(const std::vector<ChunkRef> &chunks, const fs::path &storeDir, const fs::path &target);
+
+    // 删除不再被任何清单引用的块，removed 为删除数量
+    // 任一清单无法读取或解析时不删除任何块并返回 false：无法确认它引用了哪些块
+    static bool collectGarbage(const fs::path &storeDir, const std::vector<fs::path> &manifests,
+                               std::size_t &removed, std::string &error);
+
+    // 清单读写：记录源文件大小、修改时间、整体哈希与块列表
+    static bool writeManifest(const fs::path &manifest, const Result &result, std::int64_t sourceMtime);
+    static bool readManifest(const fs::path &manifest, std::vector<ChunkRef> &chunks);
+
+    // 增量 SHA-256：复制、压缩在读取源文件的同一遍中喂入数据，不必为哈希再读一遍
+    class Sha256
+    {
+    public:
+        Sha256();
+        ~Sha256();
+        Sha256(const Sha256 &) = delete;
+        Sha256 &operator=(const Sha256 &) = delete;
+
+        void update(const void *data, std::size_t size);
+        std::string hex(); // 结束计算，返回十六进制摘要
+
+    private:
+        evp_md_ctx_st *ctx;
+    };
+
+    // 流式计算文件 SHA-256（十六进制），失败返回空串；throttle 可选，按读取量限速
+    static std::string hashFile(const fs::path &file, IoThrottle *throttle = nullptr);
+
+    // 块文件路径：storeDir/哈希前两位/哈希
+    static fs::path chunkPath(const fs::path &storeDir, const std::string &hash);
+};
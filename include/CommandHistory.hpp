@@ -0,0 +1,74 @@
+#pragma once
+#include "MappedFile.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// 持久化命令历史：历史文件每行一条，新命令只在末尾追加，从不重写整个文件
+// 启动时内存映射已有文件，只扫描一遍换行符即可上下翻阅；
+// 反向搜索用的三元组索引由后台线程建立，尚未建好的部分按顺序比对，不拖慢启动
+// 搜索结果按命令去重，每条不同的命令只在它最近一次出现的位置命中一次
+class CommandHistory
+{
+public:
+    // 映射已有历史并在后台建立索引；文件不存在时从空历史开始，首次追加时创建
+    static bool open(const fs::path &path);
+    static void close();
+
+    // 追加一条（与上一条相同时不重复记录）
+    static void add(const std::string &line);
+
+    static std::size_t size();
+    static std::string at(std::size_t index);
+
+    // 查找下标小于 before 的、包含 query 的最近一条不同命令，找不到返回 -1
+    // 从 before = size() 开始，每次以上一次结果为 before 即可逐条往旧翻
+    static long long search(const std::string &query, std::size_t before);
+
+    // 后台索引是否已覆盖全部历史
+    static bool indexed();
+
+private:
+    // 一条不同的命令
+    struct Distinct
+    {
+        std::string_view text;
+        std::uint32_t lastEntry = 0; // 最近一次出现的历史下标
+    };
+
+    static void indexLoop();
+    static void process(std::size_t count);   // 把随后 count 条历史并入去重表与索引（需持有 historyMutex）
+    static void indexText(std::uint32_t id); // 登记一条不同命令的全部三元组
+    static bool matches(std::string_view text, const std::string &query);
+
+    static std::mutex historyMutex;
+    static fs::path filePath;
+    static MappedFile mapped;
+    static bool needsNewline;                    // 已有文件末尾缺换行（上次写到一半退出）
+    static std::vector<std::string_view> entries; // 指向映射内存或 added
+    static std::deque<std::string> added;        // 本次运行新增的命令
+    static std::size_t processed;                // entries 中已并入去重表与索引的条数
+    static std::vector<Distinct> distinct;
+    static std::unordered_map<std::string_view, std::uint32_t> distinctIds;
+    static std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> postings; // 三元组 -> 不同命令编号（递增）
+
+    static std::thread indexThread;
+    static bool stopping;
+
+    // 自动析构清理器：在程序结束时停止索引线程
+    class Finalizer
+    {
+    public:
+        ~Finalizer();
+    };
+    static Finalizer finalizer;
+};
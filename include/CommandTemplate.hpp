@@ -0,0 +1,83 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 命令模板：把 "give {id} x{n}" 一次编译为字面量段与变量槽段，展开时只做追加，
+// 写入调用方复用的缓冲区，不再为每条命令拼接临时字符串
+// 语法：{name} 为变量槽（字母、数字、下划线），{{ 与 }} 表示字面的花括号
+class CommandTemplate
+{
+public:
+    // 编译模板；语法错误（未闭合的 {、空变量名等）抛出 std::invalid_argument
+    explicit CommandTemplate(const std::string &text);
+
+    const std::string &text() const { return source; }
+
+    // 模板引用的变量名，按首次出现的顺序去重
+    const std::vector<std::string> &variables() const { return names; }
+
+    // 按 variables() 的顺序给出取值，展开到 out（先清空，保留容量）
+    void expand(const std::string_view *values, std::string &out) const;
+    std::string expand(std::initializer_list<std::string_view> values) const;
+
+private:
+    struct Segment
+    {
+        std::uint32_t offset = 0; // 字面量在 literals 中的位置
+        std::uint32_t length = 0;
+        int variable = -1;        // 不小于 0 时为变量槽，值为变量下标
+    };
+
+    std::string source;
+    std::string literals;
+    std::vector<Segment> segments;
+    std::vector<std::string> names;
+};
+
+// 模板变量的取值表：每个变量一列，各列按行对齐展开（长度为 1 的列对每一行都适用）
+// 取值写法：
+//   id=1001..1100      闭区间整数范围，可带步长 1..99:2，也可递减 100..1
+//   part=1,2,3         列表
+//   n=1                单个值
+//   @items.csv         CSV 文件（首行为列名），与变量同名的列作为取值
+// 范围按需生成，不预先展开成字符串
+class TemplateBindings
+{
+public:
+    static constexpr std::size_t MaxCommands = 1000000;
+
+    // 解析以空白分隔的取值写法；变量缺少取值、列长度不一致或超过 MaxCommands 时抛出 std::invalid_argument
+    static TemplateBindings parse(const std::string &spec, const CommandTemplate &tpl);
+
+    // 展开后的命令条数
+    std::size_t size() const { return rows; }
+
+    // 依次展开每一条命令；fn 返回 false 时停止，返回已处理的条数
+    std::size_t forEach(const CommandTemplate &tpl, const std::function<bool(const std::string &)> &fn) const;
+
+private:
+    struct Column
+    {
+        bool range = false;
+        std::int64_t start = 0;
+        std::int64_t step = 1;
+        std::size_t count = 0;
+        std::vector<std::string> values; // 列表或 CSV 列
+
+        std::size_t size() const { return range ? count : values.size(); }
+        std::string_view at(std::size_t row, std::array<char, 24> &scratch) const; // 范围值格式化到 scratch
+    };
+
+    static Column parseValue(const std::string &name, const std::string &text);
+    static void readCsv(const std::string &path, const CommandTemplate &tpl, std::vector<Column> &columns,
+                        std::vector<bool> &bound);
+
+    std::vector<Column> columns; // 与 CommandTemplate::variables() 一一对应
+    std::size_t rows = 0;
+};
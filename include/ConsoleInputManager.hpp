@@ -2,22 +2,75 @@
 #include <string>
 #include <thread>
 #include <mutex>
+#include <queue>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
 
 class ConsoleInputManager
 {
 public:
-    // 每次调用 read() 时才启动一次输入线程，直到用户敲回车后线程结束
+    // 启动常驻输入线程（首次 read() 时也会自动启动）
+    static void start();
+
+    // 阻塞等待并取出用户敲回车后的一整行
     static std::string read();
 
+    // 输出线程打印完队列中的消息后调用，唤醒输入线程重绘提示符
+    static void notifyOutputIdle();
+
+    // 按键捕获模式（全屏仪表盘）：按键不回显、不组成行，逐个交给 nextKey()
+    static void captureKeys(bool enabled);
+    // 等待下一个捕获到的按键，超时返回 -1
+    static int nextKey(std::chrono::milliseconds timeout);
+
 private:
-    // 实际做输入读取的函数：收集字符直到 '\r'，然后退出
-    static void inputLoop(std::string& outLine);
+    // 常驻输入线程：阻塞等待按键或唤醒，收集字符直到 '\r'，整行放入队列
+    static void inputLoop();
+    static void handleKey(char ch);
+
+    // 方向键等多字节按键：decodeKey() 逐字节识别，序列未结束或不关心的序列返回 0
+    static constexpr int KeyUp = 0x100;
+    static constexpr int KeyDown = 0x101;
+    static constexpr int KeyCtrlG = 0x07;
+    static constexpr int KeyCtrlR = 0x12;
+    static int decodeKey(char ch);
+
+    // 命令历史：上下方向键翻阅，Ctrl-R 反向增量搜索（Ctrl-G 取消），仅交互式终端
+    static constexpr std::size_t MinHistoryLength = 2; // 更短的输入（菜单选项、Y/N）不记入历史
+    static void browseHistory(int key);
+    static void handleSearchKey(int key);
+    static void refreshSearch(bool fromNewest);
+    static std::string promptLine();
+    static void redrawLine();
+    static void submitLine(bool echo);
 
     // 当输出线程正在打印时，临时存放用户敲击的字符
     static std::string typingShadow;
     static std::mutex   shadowMutex;
+
+    // 正在编辑的一行（仅输入线程访问）
+    static std::string lineBuffer;
+
+    // 按键解码与历史翻阅/搜索状态（仅输入线程访问）
+    static int escapeState;
+    static std::size_t historyPos;   // 正在显示的历史下标，npos 表示未在翻阅
+    static std::string draftLine;    // 开始翻阅前正在编辑的内容
+    static bool searching;
+    static std::string searchQuery;
+    static long long searchMatch;    // 当前命中的历史下标，-1 表示没有
+    static std::string searchOrigin; // 开始搜索前的内容，Ctrl-G 时恢复
+
+    // 已完成的输入行
+    static std::queue<std::string> lines;
+    static std::mutex              linesMutex;
+    static std::condition_variable linesNotifier;
+
+    // 捕获模式下的按键（受 linesMutex 保护）
+    static std::atomic<bool> capturing;
+    static std::queue<char>  keys;
 };
 
 inline std::string read(){
     return ConsoleInputManager::read();
-}
\ No newline at end of file
+}
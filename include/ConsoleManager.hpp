@@ -4,6 +4,7 @@
 #include <random>
 #include <sstream>
 #include <nlohmann/json.hpp>
+#include "SessionManager.hpp"
 
 using json = nlohmann::json;
 
@@ -53,6 +54,28 @@ public:
     const std::string& getLevel()   const { return level; }
     const std::string& getId()      const { return id; }
 
+    /**
+     * 部位ID是否属于该遗器类型（隧洞 1–4，位面 5–6）
+     */
+    static bool isValidPart(Type type, int partId) {
+        return type == Type::Tunnel ? (partId >= 1 && partId <= 4)
+                                    : (partId >= 5 && partId <= 6);
+    }
+
+    /**
+     * 部位对应的主词条ID上限（下限恒为 1），无效部位返回 0
+     */
+    static int maxMainTag(int partId) {
+        switch (partId) {
+            case 1: case 2: return 1;   // 头/手
+            case 3:         return 7;   // 躯
+            case 4:         return 4;   // 脚
+            case 5:         return 10;  // 位面球
+            case 6:         return 5;   // 连接绳
+            default:        return 0;
+        }
+    }
+
     /**
      * 随机主词条工厂
      * @param minTag 下界
@@ -127,6 +150,14 @@ public:
     // 发送任意命令，返回服务器响应
     static json SubmitCommand(const std::string& commandText, const std::string& uid);
 
+    // 批量提交：先 OpenSession() 建立一次会话，再逐条经该会话提交
+    static SessionManager::Session OpenSession();
+    static json SubmitCommand(const SessionManager::Session& session, const std::string& commandText, const std::string& uid);
+
+    // 拼接命令文本（不提交），如 "give 1001 x10"、"relic 61011 1 1 l0 x1"
+    static std::string buildGiveCommand(const std::string& itemId, int count);
+    static std::string buildRelicCommand(const Relic& relic, int count);
+
     // 构造并返回“给予物品”命令执行状态
     static json CommandGive(const std::string& itemId, int count, const std::string& uid);
 
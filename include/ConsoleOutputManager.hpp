@@ -1,10 +1,13 @@
 #pragma once
 #include <string>
-#include <queue>
+#include <deque>
+#include <array>
 #include <mutex>
 #include <condition_variable>
 #include <iostream>
 #include <atomic>
+#include <cstdint>
+#include <vector>
 
 enum class MessageType
 {
@@ -16,12 +19,22 @@ enum class MessageType
     Command
 };
 
+// 输出队列已满时的处理策略
+enum class OverflowPolicy
+{
+    Block,     // 阻塞生产者，直到输出线程腾出空位
+    DropInfo,  // 直接丢弃 [INFO] 消息
+    Summarize  // 丢弃 [INFO] 消息，稍后输出一条汇总提示
+};
+
 struct ConsoleMessage
 {
     std::string content;
     MessageType type;
     bool animated;
     bool prompt;
+    int repeat = 1;         // 连续重复次数，大于 1 时输出 "×N"
+    std::uint64_t seq = 0;  // 入队序号，用于未拥塞时保持先后顺序
 
     ConsoleMessage(const std::string &content, MessageType type)
         : content(content), type(type) {}
@@ -31,22 +44,61 @@ class ConsoleOutputManager
 {
 public:
     static void start();
+    // 输出完剩余消息后停止输出线程（程序退出前调用）
+    static void stop();
     static void buffer(const std::string &text, MessageType type);
+    // 设置队列容量与溢出策略（可在 start() 前后调用）
+    static void configure(std::size_t capacity, OverflowPolicy policy);
     static bool getTyping(){
         return isTyping.load();
     }
+    // 锁住终端输出（输入线程回显时使用）
+    static std::unique_lock<std::recursive_mutex> lockOutput();
+    static std::unique_lock<std::recursive_mutex> tryLockOutput();
+    // 队列为空且没有正在打印的消息
+    static bool isIdle();
+    // 丢弃所有尚未输出的消息，返回丢弃条数（输出线程未启动时清理积压，如基准测试）
+    static std::size_t discardQueued();
+
+    // 暂停滚动输出（全屏仪表盘期间）：输出线程照常取出消息，记入最近消息后暂存而不打印
+    static void suspend();
+    // 恢复滚动输出，先补打暂停期间暂存的消息（超过队列容量的部分只提示条数）
+    static void resume();
+    // 最近取出的 RecentCount 条消息（含暂停期间），从旧到新
+    static std::vector<ConsoleMessage> recentMessages();
 
 private:
     static void outputLoop();
     static void flushSingle(const ConsoleMessage &msg);
     static std::string getColorCode(MessageType type);
+    static const char *getPrefix(MessageType type);
+    static void flushPending();
     static void typeWrite(const std::string &text, std::ostream &out);
+    static int laneOf(MessageType type);
+    static bool popNext(ConsoleMessage &out);
+    static void remember(const ConsoleMessage &msg);
 
-    static std::queue<ConsoleMessage> queue;
+    // 按优先级分道：0=错误/提示符，1=成功/警告，2=普通信息
+    static constexpr int LaneCount = 3;
+    static constexpr std::size_t CongestionThreshold = 32; // 积压超过此数才按优先级插队
+    static std::array<std::deque<ConsoleMessage>, LaneCount> lanes;
+    static std::size_t queuedCount;
+    static std::size_t capacity;
+    static OverflowPolicy policy;
+    static int lastLane;              // 最近一次入队的分道，用于合并连续重复消息
+    static std::size_t droppedCount;  // 因溢出被丢弃的消息数
+    static std::uint64_t nextSeq;
+    static constexpr std::size_t RecentCount = 64;
+    static std::deque<ConsoleMessage> recent; // 最近取出的消息
+    static bool suspended;
+    static std::deque<ConsoleMessage> held;   // 暂停期间取出、等待恢复后补打的消息
+    static std::size_t heldDropped;           // 暂停期间超出容量未能暂存的消息数
     static std::mutex queueMutex;
     static std::condition_variable queueNotifier;
+    static std::condition_variable spaceNotifier;
     static std::recursive_mutex outputMutex;
     static std::atomic<bool> isTyping;
+    static std::string pendingOutput;
     static int delayMs;
 };
 
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+// 本地控制套接字：其他运维脚本经 Unix 域套接字把请求交给控制台，
+// 复用控制台共享的已授权会话与各工作线程的 keep-alive 连接，省去每个脚本自己建会话、做 RSA 授权
+//
+// 协议：每帧为 4 字节大端长度 + UTF-8 JSON。一个连接上可以连续发送多个请求，
+// 响应带回请求中的 "id"（任意 JSON 值），访问服务器的请求完成先后不定
+//   {"id":1,"op":"exec","uid":"10001","command":"give 1001 x1"}
+//   {"id":2,"op":"status"}                    服务器状态（server_information）
+//   {"id":3,"op":"player","uid":"10001"}      玩家信息（player_information）
+//   {"id":4,"op":"ping"}                      不访问服务器
+// 响应：{"id":1,"ok":true,"data":{...MUIP 响应...}} 或 {"id":1,"ok":false,"error":"..."}
+// exec 的响应另附 "output"：解码后的命令输出文本
+//
+// 单线程 poll 事件循环负责所有连接的接受、读取与写回；访问服务器的请求交给固定大小的工作线程池，
+// 完成后经唤醒管道交回事件循环，慢请求不会挡住其他客户端。POSIX 以外的平台 supported() 返回 false
+class ControlServer
+{
+public:
+    struct Options
+    {
+        fs::path path;                          // 套接字路径（创建后权限为 0600）
+        std::string serverUrl;                  // MUIP 地址与管理员密钥，启动时取自配置
+        std::string adminKey;
+        unsigned workers = 4;                   // 同时进行的服务器请求数
+        std::size_t maxClients = 64;
+        std::size_t maxInFlightPerClient = 16;  // 单个连接同时交给工作线程的请求数，达到后暂停解析与读取该连接
+        std::size_t maxFrameBytes = 1 << 20;    // 超过此长度的请求帧视为协议错误并断开
+        long requestTimeoutMs = 10000;
+    };
+
+    static bool supported();
+
+    // 创建套接字并启动事件循环；路径上已有活动的控制台在监听、或创建失败时返回 false 并填写 error
+    static bool start(const Options &options, std::string &error);
+
+    // 停止事件循环，等待进行中的请求结束，删除套接字文件
+    static void stop();
+
+    static bool running();
+
+    // 处理一个已解析的请求，返回响应（在工作线程中调用；ping 与参数错误不访问服务器）
+    static json handle(const json &request, const Options &options);
+
+    // 帧编码：4 字节大端长度 + 内容
+    static void appendFrame(std::string &out, const std::string &payload);
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include "AutoSaver.hpp"
+#include "ConsoleOutputManager.hpp"
+#include "JobManager.hpp"
+#include "ScreenBuffer.hpp"
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// 全屏仪表盘：服务器状态、当前 UID、后台任务、最近消息与自动保存状态
+// 每帧画进离屏缓冲，与终端上的上一帧比较后只写出变化的格子，帧率有上限；
+// 内容不变的帧不写任何字节，经慢速 SSH 刷新时每帧通常只有几十字节
+// 运行期间暂停滚动输出与行输入，退出后补打期间的消息
+class Dashboard
+{
+public:
+    struct Options
+    {
+        int fps = 4;                   // 帧率上限
+        int statusIntervalSeconds = 5; // 服务器状态的查询间隔
+    };
+
+    // 一帧所需的全部数据；render() 只依赖它，不访问全局状态
+    struct Snapshot
+    {
+        std::time_t now = 0;
+        std::string serverUrl;
+        bool statusKnown = false;  // 已完成至少一次查询
+        bool statusOk = false;
+        std::string statusError;
+        json status;               // server_information 的 data
+        int statusLatencyMs = 0;
+        int statusAgeSeconds = 0;  // 距上次查询完成的秒数
+        std::string uid;
+        std::vector<std::string> watchedUids;
+        std::vector<JobManager::Info> jobs;
+        std::vector<AutoSaver::Status> autosave;
+        std::vector<ConsoleMessage> messages; // 从旧到新
+    };
+
+    // 阻塞运行，直到按下 Q 或 Esc；输出不是终端时返回 false
+    static bool run(const Options &options);
+
+    // 把 snapshot 画进 screen（先清空，尺寸不变）
+    static void render(const Snapshot &snapshot, ScreenBuffer &screen);
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <cstdint>
+
+class IoThrottle;
+
+namespace fs = std::filesystem;
+
+// 崩溃安全的文件复制：写入同目录临时文件 → fsync → 原子改名 → fsync 目录
+// Linux 下依次尝试最便宜的内核路径：FICLONE 引用链接 → copy_file_range → sendfile → read/write
+class FileCopier
+{
+public:
+    enum class Method
+    {
+        Auto,          // 自动选择可用的最快路径
+        Clone,         // ioctl(FICLONE)，支持 reflink 的文件系统上只复制元数据
+        CopyFileRange, // copy_file_range，数据不经过用户态
+        Sendfile,      // sendfile，数据不经过用户态
+        ReadWrite,     // 用户态缓冲区读写
+        Portable       // std::filesystem::copy_file（非 Linux 平台）
+    };
+
+    struct Stats
+    {
+        Method method = Method::Auto; // 实际使用的路径
+        std::uint64_t bytes = 0;
+        double seconds = 0;
+    };
+
+    // 复制 source 到 target；preferred 不为 Auto 时从该路径开始尝试（基准测试用）
+    // throttle 限速时按小块复制，每块先取令牌（reflink 不搬运数据，不受限）
+    static bool copyAtomic(const fs::path &source, const fs::path &target,
+                           Stats &stats, std::string &error,
+                           Method preferred = Method::Auto,
+                           IoThrottle *throttle = nullptr);
+
+    // 直接写入 target，不落盘、不改名：整棵目录树先复制进临时目录，
+    // 再由 syncTree() 统一落盘后整体换入，省去逐个文件的 fsync 与改名
+    static bool copyInto(const fs::path &source, const fs::path &target,
+                         Stats &stats, std::string &error,
+                         IoThrottle *throttle = nullptr);
+
+    // 把目录树下的所有文件与目录项落盘（Linux 下一次 syncfs，其他平台逐个刷新）
+    static bool syncTree(const fs::path &root, std::string &error);
+
+    // 把已写完的临时文件落盘并原子替换 target
+    static bool commit(const fs::path &tmp, const fs::path &target, std::string &error);
+
+    static const char *methodName(Method method);
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include <filesystem>
+#include <functional>
+
+namespace fs = std::filesystem;
+
+// 文件变化监视：Linux 下基于 inotify，由一个后台线程读取事件并回调；
+// 其他平台 supported() 返回 false，调用方退回定时保存
+class FileWatcher
+{
+public:
+    // 回调参数为 watch() 时登记的编号；在监视线程中调用，应尽快返回
+    using Callback = std::function<void(int id)>;
+
+    static bool supported();
+
+    // 监视文件（实际监视其所在目录并按文件名过滤，可感知替换、-wal/-journal 写入）
+    // 或目录（递归监视，新建的子目录自动加入）；失败返回 false
+    static bool watch(int id, const fs::path &path);
+
+    // 启动监视线程（仅第一次调用生效）
+    static void start(Callback onChange);
+
+    // 停止监视线程并关闭所有监视
+    static void stop();
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include <filesystem>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+class IoThrottle;
+
+namespace fs = std::filesystem;
+
+// 并行压缩快照：源文件按块流式读取，各块在线程池中独立压缩为 gzip 成员，
+// 按顺序拼接写出（与 pigz 相同的多成员 gzip 格式，gzip -d / zcat 可直接读取）
+class GzipSnapshot
+{
+public:
+    struct Stats
+    {
+        std::uint64_t inputBytes = 0;
+        std::uint64_t outputBytes = 0;
+        std::uint32_t crc = 0; // 原始数据的 CRC32（由各块 CRC 用 crc32_combine 合并）
+        std::string sha256;    // 原始数据的 SHA-256（十六进制），读取时顺带计算
+        double seconds = 0;
+    };
+
+    /**
+     * 压缩 source 到 target（先写临时文件，完成后改名）
+     * @param level   zlib 压缩级别 1–9
+     * @param threads 压缩线程数，0 表示硬件并发数
+     * @param throttle 可选限速：读取源文件前按块取令牌
+     * @param beforeCommit 可选：临时文件写完、替换 target 之前调用（此时 stats 已完整），
+     *                     返回 false 时丢弃临时文件，保留原有 target
+     */
+    static bool compress(const fs::path &source, const fs::path &target,
+                         int level, unsigned threads, Stats &stats,
+                         IoThrottle *throttle = nullptr,
+                         const std::function<bool(const Stats &)> &beforeCommit = {});
+
+    // 解压（支持多成员 gzip）到 target
+    static bool decompress(const fs::path &source, const fs::path &target);
+
+    // 每块原始数据大小；内存占用约为 块大小 × 在途块数
+    static constexpr std::size_t BlockSize = 4 * 1024 * 1024;
+};
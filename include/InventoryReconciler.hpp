@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+// 背包补齐：给出期望持有的物品与数量，对照玩家当前持有量，只给予缺少的部分
+// 期望与现有都以 物品ID -> 数量 的哈希表表示，同一物品的缺口合并为一条 give <id> x<缺口>，
+// 对已基本齐全的账号，命令数从“规格中的每一件”降到“真正缺少的那几种”
+class InventoryReconciler
+{
+public:
+    using Counts = std::unordered_map<std::uint32_t, std::int64_t>;
+
+    // 一条待提交的给予命令
+    struct Give
+    {
+        std::uint32_t id = 0;
+        std::int64_t count = 0;
+    };
+
+    struct Plan
+    {
+        std::vector<Give> gives;        // 按物品ID升序
+        std::size_t wantedItems = 0;    // 规格中的物品种数
+        std::size_t satisfiedItems = 0; // 已经足够的种数
+        std::int64_t wantedCount = 0;   // 规格中的总件数（逐件给予时的命令数）
+        std::int64_t missingCount = 0;  // 缺少的总件数
+        std::size_t unknownItems = 0;   // 持有量未知而未给予的种数
+    };
+
+    // 从玩家信息中识别持有量的字段
+    struct Fields
+    {
+        std::vector<std::string> lists; // 物品列表字段名，如 itemList
+        std::unordered_map<std::string, std::uint32_t> scalars; // 标量字段名 -> 物品ID，如 credit -> 2
+    };
+
+    // 当前持有量，以及哪些物品的持有量是确知的
+    struct Holdings
+    {
+        Counts counts;
+        bool listFound = false;                      // 找到了物品列表：列表中没有的物品持有量为 0
+        std::unordered_set<std::uint32_t> scalarIds; // 由标量字段得知持有量的物品
+
+        bool known(std::uint32_t id) const { return listFound || scalarIds.count(id) != 0; }
+    };
+
+    /**
+     * 读取期望背包规格（JSON），两种写法可混用于不同文件：
+     *   {"1001": 1, "2": 1000000}
+     *   [{"id": 1001, "count": 1}, {"id": 2, "count": 1000000}]
+     * 同一物品出现多次时数量相加；格式错误时抛出 std::runtime_error
+     */
+    static Counts loadSpec(const fs::path &path);
+    static Counts parseSpec(const json &spec);
+
+    /**
+     * 从 player_information 的 data 中取出当前持有量（字段名不区分大小写，忽略下划线）
+     *   - fields.lists 中列出的物品列表字段（任意层级），每一项须带物品ID与数量，
+     *     如 [{"itemId": 1001, "count": 3}]，接受 id/itemId/item_id 与 count/num/amount；
+     *     有一项无法识别即抛出 std::runtime_error，不猜测其含义
+     *   - fields.scalars 中列出的 data 顶层标量字段，只说明对应那一个物品的持有量
+     */
+    static Holdings parseHoldings(const json &data, const Fields &fields);
+
+    // 默认字段：列表 itemList/items/inventory，标量信用点（credit -> 2）与星琼（jade -> 1）
+    static Fields defaultFields();
+
+    // 计算缺口，只给予持有量确知的物品；单条命令的数量超过 maxPerCommand 时拆成多条
+    static Plan diff(const Counts &desired, const Holdings &current, std::int64_t maxPerCommand);
+};
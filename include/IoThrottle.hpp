@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+// 令牌桶限速：按 MB/s 发放字节令牌，复制循环每处理一块先 acquire()；
+// 允许短暂透支，透支部分按速率换算成等待时间，多线程共享同一个桶时各自休眠
+// cancel() 立即唤醒所有等待者，之后 acquire() 一律返回 false，复制循环据此中止并删除临时文件
+class IoThrottle
+{
+public:
+    // megabytesPerSecond 为 0 表示不限速
+    explicit IoThrottle(double megabytesPerSecond = 0);
+
+    bool limited() const { return rate > 0; }
+
+    // 取得 bytes 个令牌，必要时阻塞；已取消（含等待期间被取消）时返回 false
+    bool acquire(std::size_t bytes);
+
+    // 取消进行中与之后的 acquire()（程序退出时中止保存用）；reset() 恢复可用
+    void cancel();
+    void reset() { stopRequested = false; }
+    bool cancelled() const { return stopRequested; }
+
+    // 限速时建议的单次 I/O 大小：约 1/8 秒的配额，介于 64 KiB 与 1 MiB 之间
+    std::size_t chunkSize() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::mutex bucketMutex;
+    std::condition_variable cancelNotifier;
+    std::atomic<bool> stopRequested{false};
+    double rate = 0;     // 字节/秒
+    double capacity = 0; // 桶容量：约 1/4 秒的配额
+    double tokens = 0;
+    Clock::time_point last;
+};
+
+// 在作用域内把当前线程的 I/O 优先级降为空闲级（Linux ioprio_set IDLE，
+// Windows 后台模式），离开作用域时恢复；enable 为 false 时什么也不做
+class IoPriorityScope
+{
+public:
+    explicit IoPriorityScope(bool enable);
+    ~IoPriorityScope();
+
+    IoPriorityScope(const IoPriorityScope &) = delete;
+    IoPriorityScope &operator=(const IoPriorityScope &) = delete;
+
+private:
+    bool active = false;
+    int previous = 0;
+};
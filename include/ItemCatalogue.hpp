@@ -0,0 +1,53 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include "MappedFile.hpp"
+
+namespace fs = std::filesystem;
+
+// 物品表中的一条记录（字符串直接指向映射内存，索引关闭前有效）
+struct CatalogueItem
+{
+    std::uint32_t    id;
+    std::string_view name;
+    std::string_view mainType;
+};
+
+// 物品表索引：把 DanhengServer 的 ExcelOutput 物品表编译为紧凑的磁盘索引，启动时内存映射
+//   - ID 查找：开放寻址哈希表，O(1)
+//   - 名称前缀搜索：字典树，每个节点记录其子树在按名称排序的记录中的区间
+class ItemCatalogue
+{
+public:
+    /**
+     * 加载物品表
+     * @param sources   ExcelOutput 物品表 JSON（如 ItemConfig.json、ItemConfigRelic.json）
+     * @param textMap   TextMap JSON（哈希 -> 名称），为空时名称显示为哈希值
+     * @param indexFile 索引缓存路径；与源文件一致时直接映射，否则重新编译
+     */
+    static bool load(const std::vector<fs::path> &sources,
+                     const fs::path &textMap,
+                     const fs::path &indexFile);
+
+    static bool isLoaded() { return index.isOpen(); }
+    static std::size_t size();
+
+    // 按 ID 查找，找不到返回 false
+    static bool find(std::uint32_t id, CatalogueItem &out);
+
+    // 名称前缀搜索，最多返回 limit 条（按名称排序）
+    static std::vector<CatalogueItem> searchPrefix(const std::string &prefix, std::size_t limit = 10);
+
+private:
+    static bool build(const std::vector<fs::path> &sources,
+                      const fs::path &textMap,
+                      const fs::path &indexFile,
+                      std::uint64_t stamp);
+    static bool mapIndex(const fs::path &indexFile, std::uint64_t stamp);
+    static CatalogueItem itemAt(std::uint32_t index);
+
+    static MappedFile index;
+};
@@ -0,0 +1,111 @@
+#pragma once
+#include "ConsoleOutputManager.hpp"
+#include "ThreadPool.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 后台任务：随机遗器礼包、自定义命令等长时间的网络操作在工作线程上执行，菜单立即返回
+// 每个任务有编号、进度与取消标志；结果随完成随时经 buffer() 输出
+// 任务在提交时记录目标 UID，之后修改当前 UID 不影响已提交的任务
+class JobManager
+{
+public:
+    enum class State
+    {
+        Queued,    // 等待空闲的工作线程
+        Running,
+        Done,
+        Cancelled,
+        Failed     // 任务体抛出异常
+    };
+
+    // 任务体通过它汇报进度、检查取消与输出结果（可在工作线程中调用）
+    class Job
+    {
+    public:
+        int id() const { return jobId; }
+        const std::string &uid() const { return playerUid; }
+
+        void setTotal(int steps) { total = steps; }
+        void step(bool succeeded = true); // 完成一步；失败的步骤单独计数
+        bool cancelled() const { return cancelRequested.load(); }
+
+        // 输出带任务编号前缀的消息，如 "[#3] ..."
+        void print(const std::string &text, MessageType type) const;
+
+    private:
+        friend class JobManager;
+        using Clock = std::chrono::steady_clock;
+
+        int jobId = 0;
+        std::string title;
+        std::string playerUid;
+        std::atomic<int> total{0};
+        std::atomic<int> done{0};
+        std::atomic<int> failed{0};
+        std::atomic<bool> cancelRequested{false};
+        // 以下由 JobManager::jobsMutex 保护
+        State state = State::Queued;
+        Clock::time_point started;
+        Clock::time_point finished;
+    };
+
+    using Body = std::function<void(Job &)>;
+
+    // 任务快照，供“后台任务”视图显示
+    struct Info
+    {
+        int id = 0;
+        std::string title;
+        std::string uid;
+        State state = State::Queued;
+        int total = 0;
+        int done = 0;
+        int failed = 0;
+        double seconds = 0;   // 已运行（或总共运行）的时间
+        double perSecond = 0; // 每秒完成的步骤数
+    };
+
+    // 启动工作线程池（仅第一次调用生效）；workers 为同时运行的任务数上限
+    static void start(unsigned workers = 4);
+
+    // 提交任务，返回编号；未 start() 时以默认线程数启动
+    static int submit(const std::string &title, const std::string &uid, Body body);
+
+    // 请求取消；任务在下一步开始前停止。返回任务是否存在且尚未结束
+    static bool cancel(int id);
+    static int cancelAll();
+
+    // 运行中、排队中以及最近结束的任务，按编号排列
+    static std::vector<Info> list();
+
+    // 取消全部任务，等待正在执行的步骤结束后返回（程序退出前调用）
+    static void stop();
+
+    static const char *stateName(State state);
+
+private:
+    static void run(const std::shared_ptr<Job> &job, const Body &body);
+    static void prune(); // 只保留最近的若干个已结束任务（需持有 jobsMutex）
+
+    static constexpr std::size_t KeepFinished = 16;
+
+    static std::mutex jobsMutex;
+    static std::map<int, std::shared_ptr<Job>> jobs;
+    static int nextId;
+    static std::unique_ptr<ThreadPool> pool;
+
+    // 自动析构清理器：在程序结束时停止工作线程
+    class Finalizer
+    {
+    public:
+        ~Finalizer();
+    };
+    static Finalizer finalizer;
+};
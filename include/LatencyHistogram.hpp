@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 对数-线性分桶的延迟直方图（与 HdrHistogram 同一思路）：每个 2 的幂区间分 128 个桶，
+// 相对误差不超过 1/128；记录为 O(1)，内存固定，多个直方图可直接相加
+// 单位由调用方决定（压测用微秒）
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void record(std::uint64_t value);
+
+    // 协调遗漏校正：value 超过 expectedInterval 时，补记本应在等待期间发出的请求
+    // （value - interval、value - 2×interval……），等价于 HdrHistogram 的 recordValueWithExpectedInterval
+    void recordCorrected(std::uint64_t value, std::uint64_t expectedInterval);
+
+    void merge(const LatencyHistogram &other);
+
+    // 按 expectedInterval 对已记录的值做事后校正，返回新的直方图
+    LatencyHistogram corrected(std::uint64_t expectedInterval) const;
+
+    std::uint64_t count() const { return total; }
+    std::uint64_t max() const { return maximum; }
+    double mean() const;
+
+    // 百分位（0–100），返回所在桶的上界；为空时返回 0
+    std::uint64_t percentile(double p) const;
+
+private:
+    static constexpr unsigned SubBits = 7;
+    static constexpr std::size_t SubCount = std::size_t(1) << SubBits;
+
+    static std::size_t bucketOf(std::uint64_t value);
+    static std::uint64_t lowestOf(std::size_t bucket);
+    static std::uint64_t highestOf(std::size_t bucket);
+
+    void recordCount(std::uint64_t value, std::uint64_t times);
+
+    std::vector<std::uint64_t> counts;
+    std::uint64_t total = 0;
+    std::uint64_t maximum = 0;
+    long double sum = 0;
+};
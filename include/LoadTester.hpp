@@ -0,0 +1,60 @@
+#pragma once
+#include "LatencyHistogram.hpp"
+#include "SessionManager.hpp"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+
+// MUIP 压测：复用 SessionManager 的会话与每线程 keep-alive 连接，对单个接口持续发请求
+//   开环（Open）：按固定到达率排定每个请求的发出时刻，工作线程忙不过来时请求排队，
+//                延迟从排定时刻算起，服务端变慢不会让客户端少发请求（无协调遗漏）；
+//                到时长结束仍未发出的请求计为错误，并以 结束时刻 - 排定时刻 为延迟下界记入
+//   闭环（Closed）：固定并发数，每个连接收到响应后立即发下一个；另给出按中位延迟
+//                做协调遗漏校正后的分布
+class LoadTester
+{
+public:
+    enum class Target
+    {
+        ExecCommand,       // /muip/exec_cmd
+        PlayerInformation, // /muip/player_information
+        ServerInformation  // /muip/server_information
+    };
+
+    enum class Mode
+    {
+        Open,
+        Closed
+    };
+
+    struct Options
+    {
+        Target target = Target::ServerInformation;
+        Mode mode = Mode::Closed;
+        double rate = 100;          // 开环：每秒请求数
+        unsigned connections = 16;  // 工作线程（连接）数，闭环即并发数
+        int durationSeconds = 10;
+        long timeoutMs = 10000;     // 单个请求的超时
+        std::string command = "help"; // exec_cmd 的命令
+        std::string uid = "10001";    // exec_cmd 与 player_information 的目标 UID
+    };
+
+    struct Report
+    {
+        std::uint64_t sent = 0;      // 实际发出的请求数
+        std::uint64_t succeeded = 0;
+        double seconds = 0;
+        LatencyHistogram latency;   // 微秒；开环从排定时刻算起
+        LatencyHistogram corrected; // 闭环的校正分布（开环与 latency 相同）
+        std::map<std::string, std::uint64_t> errors; // 错误种类 → 次数
+    };
+
+    // 每秒回调一次：已运行秒数、这一秒完成的请求数与出错数
+    using Progress = std::function<void(int second, std::uint64_t completed, std::uint64_t failed)>;
+
+    // 阻塞运行到结束；progress 在调用线程中执行
+    static Report run(const SessionManager::Session &session, const Options &options, const Progress &progress = {});
+
+    static const char *targetName(Target target);
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <filesystem>
+#include <cstddef>
+
+namespace fs = std::filesystem;
+
+// 只读内存映射文件：按需由操作系统分页载入，打开大文件几乎不花时间
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // 映射整个文件，失败返回 false（空文件同样视为失败）
+    bool open(const fs::path &path);
+    void close();
+
+    const char *data() const { return mappedData; }
+    std::size_t size() const { return mappedSize; }
+    bool isOpen() const { return mappedData != nullptr; }
+
+private:
+    const char *mappedData = nullptr;
+    std::size_t mappedSize = 0;
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#endif
+};
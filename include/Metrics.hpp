@@ -0,0 +1,161 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// 进程内指标：计数器、仪表与直方图
+// 按名称与标签注册一次（返回的引用在进程内一直有效，调用方用局部静态变量缓存），
+// 之后热路径上只是一次 relaxed 原子加；计数器与直方图按线程分片，各线程写不同的缓存行，
+// 读取时再把分片相加。输出为 Prometheus 文本格式，可定期写入 node-exporter 的 textfile 目录
+class Metrics
+{
+public:
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+
+    static constexpr std::size_t Shards = 16;
+
+    // 只增不减的计数器
+    class Counter
+    {
+    public:
+        void add(std::uint64_t n = 1);
+        std::uint64_t value() const;
+
+    private:
+        struct alignas(64) Cell
+        {
+            std::atomic<std::uint64_t> value{0};
+        };
+        std::array<Cell, Shards> cells;
+    };
+
+    // 可增可减、可直接设置的当前值（如队列长度），不分片
+    class Gauge
+    {
+    public:
+        void set(std::int64_t v) { current.store(v, std::memory_order_relaxed); }
+        void add(std::int64_t n) { current.fetch_add(n, std::memory_order_relaxed); }
+        std::int64_t value() const { return current.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<std::int64_t> current{0};
+    };
+
+    // 固定桶边界的直方图（Prometheus 语义：桶为“小于等于上界”的累计数）
+    class Histogram
+    {
+    public:
+        explicit Histogram(std::vector<double> upperBounds);
+
+        void observe(double value);
+
+        struct Snapshot
+        {
+            std::vector<double> bounds;
+            std::vector<std::uint64_t> cumulative; // 与 bounds 对应，末尾多一个 +Inf
+            std::uint64_t count = 0;
+            double sum = 0;
+
+            // 按桶内线性插值估计分位数（0–1），为空时返回 0
+            double quantile(double q) const;
+        };
+        Snapshot snapshot() const;
+
+    private:
+        // 一条缓存行的桶计数；分片的桶数组按整行分配与对齐，不与其他分片或其他对象共享缓存行
+        struct alignas(64) Line
+        {
+            std::atomic<std::uint64_t> counts[8];
+        };
+        struct alignas(64) Shard
+        {
+            std::unique_ptr<Line[]> lines;         // 共 bounds.size() + 1 个计数，末行补齐
+            std::atomic<std::uint64_t> sumBits{0}; // double 的位模式，CAS 累加
+
+            std::atomic<std::uint64_t> &count(std::size_t bucket) { return lines[bucket / 8].counts[bucket % 8]; }
+            const std::atomic<std::uint64_t> &count(std::size_t bucket) const { return lines[bucket / 8].counts[bucket % 8]; }
+        };
+        std::vector<double> bounds;
+        std::array<Shard, Shards> shards;
+    };
+
+    // 取得（首次调用时注册）指标；同名指标的类型必须一致，否则抛出 std::logic_error
+    static Counter &counter(const std::string &name, const std::string &help, const Labels &labels = {});
+    static Gauge &gauge(const std::string &name, const std::string &help, const Labels &labels = {});
+    static Histogram &histogram(const std::string &name, const std::string &help,
+                                const std::vector<double> &upperBounds, const Labels &labels = {});
+
+    // 常用桶边界（秒）
+    static const std::vector<double> &requestBuckets(); // 1 ms – 10 s
+    static const std::vector<double> &saveBuckets();    // 10 ms – 5 min
+
+    // Prometheus 文本格式（按名称与标签排序）
+    static std::string renderPrometheus();
+
+    // 每个指标一行的可读摘要，直方图给出次数、平均与估计的 p50/p99，供控制台显示
+    static std::vector<std::string> describe();
+
+    // 写入 path（先写同目录临时文件再改名，收集器不会读到写了一半的文件）
+    static bool writeTextfile(const fs::path &path, std::string &error);
+
+    // 启动后台线程，每 intervalSeconds 秒写一次 path；再次调用会替换设置
+    static void startExport(const fs::path &path, int intervalSeconds);
+    static void stopExport();
+
+private:
+    enum class Type
+    {
+        Counter,
+        Gauge,
+        Histogram
+    };
+
+    struct Series
+    {
+        std::string labels; // 已渲染的 {a="b",...}，无标签时为空
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    struct Family
+    {
+        std::string help;
+        Type type = Type::Counter;
+        std::map<std::string, Series> series; // 键为 labels
+    };
+
+    static Series &lookup(const std::string &name, const std::string &help, Type type, const Labels &labels);
+    static std::string renderLabels(const Labels &labels);
+    static void exportLoop();
+
+    // 注册表在首次使用时创建且不析构：调用方缓存的引用在其他静态对象析构期间（如退出时打印消息）仍然有效
+    static std::map<std::string, Family> &families();
+    static std::mutex registryMutex;
+
+    static std::mutex exportMutex;
+    static std::condition_variable exportNotifier;
+    static std::thread exportThread;
+    static bool exportStopping;
+    static fs::path exportPath;
+    static int exportInterval;
+
+    // 自动析构清理器：在程序结束时停止导出线程
+    class Finalizer
+    {
+    public:
+        ~Finalizer();
+    };
+    static Finalizer finalizer;
+};
@@ -0,0 +1,129 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+// 玩家快照批量导出：并发查询一段 UID 的 player_information，把每个响应逐行写入紧凑的列式文件，
+// 只在内存中保留当前一个行组（默认最多 4096 行、16 MiB），导出多少玩家内存占用都不变
+//
+// 文件格式（所有整数为 LEB128 变长编码，字符串为 长度 + 字节）：
+//   "DHPX" 版本(1 字节)
+//   行组 × N：行数 列数 列 × 列数；行数为 0 表示文件结束（没有结束标记说明导出中断，已写出的行组仍可读取）
+//   列：名称 类型(1 字节，最高位为 1 表示内容经 zlib 压缩) 原始长度 存储长度 内容
+//   内容：存在位图（每行 1 位）+ 各存在值
+//     Int    与上一个存在值之差的 zigzag 编码
+//     Double 8 字节小端
+//     String/Json  本行组内的字典（条数 + 各条）+ 各值的字典下标；Json 列的值为 JSON 文本（数组、混合类型等）
+// 列名为响应中各标量字段的路径，如 "code"、"data/level"（键中的 "~"、"/" 按 JSON Pointer 写作 "~0"、"~1"），
+// 另有 "#uid" 列记录查询的 UID；行的先后按查询完成的顺序，不按 UID 排序
+class PlayerExport
+{
+public:
+    enum class Kind : std::uint8_t
+    {
+        Int = 0,
+        Double = 1,
+        String = 2,
+        Json = 3
+    };
+
+    class Writer
+    {
+    public:
+        // 行数或值的总字节数先达到上限时写出一个行组
+        explicit Writer(std::size_t groupRows = 4096, std::size_t groupBytes = 16 << 20)
+            : groupRows(groupRows ? groupRows : 1), groupBytes(groupBytes) {}
+        ~Writer() { close(); }
+
+        bool open(const fs::path &path);
+
+        // 追加一行：value 的各标量字段成为列，数组以 JSON 文本保存；行组写满时压缩写出
+        void add(std::int64_t uid, const json &value);
+
+        // 写出剩余的行与结束标记
+        bool close();
+
+        std::uint64_t rows() const { return totalRows; }
+        std::uint64_t bytesWritten() const { return written; }
+
+    private:
+        struct Cell
+        {
+            Kind kind = Kind::Int;
+            std::int64_t i = 0;
+            double d = 0;
+            std::string s;
+        };
+        struct Column
+        {
+            std::string name;
+            std::vector<std::pair<std::uint32_t, Cell>> cells; // (行号, 值)，行号递增
+        };
+
+        void flatten(const json &value, const std::string &path);
+        void put(const std::string &name, Cell cell);
+        void flush();
+        std::string encode(const Column &column, Kind &kind) const;
+
+        std::size_t groupRows;
+        std::size_t groupBytes;
+        std::ofstream out;
+        std::vector<Column> columns;
+        std::unordered_map<std::string, std::size_t> columnIndex;
+        std::uint32_t pendingRows = 0;
+        std::size_t pendingBytes = 0;
+        std::uint64_t totalRows = 0;
+        std::uint64_t written = 0;
+    };
+
+    class Reader
+    {
+    public:
+        bool open(const fs::path &path, std::string &error);
+
+        // 读出下一个行组，每行还原为 JSON 对象（缺失的字段不出现）；文件结束返回 false
+        // 文件截断或损坏时返回 false 并填写 error
+        bool next(std::vector<json> &rows, std::string &error);
+
+        // 是否读到了结束标记
+        bool complete() const { return finished; }
+
+    private:
+        std::ifstream in;
+        bool finished = false;
+    };
+
+    struct Options
+    {
+        fs::path path;
+        std::int64_t firstUid = 0;
+        std::int64_t lastUid = 0;
+        unsigned threads = 8;
+        std::size_t groupRows = 4096;
+    };
+
+    struct Stats
+    {
+        std::uint64_t rows = 0;
+        std::uint64_t failed = 0;     // 请求失败（网络或解析错误），这些 UID 不写入文件
+        std::uint64_t rawBytes = 0;   // 响应 JSON 的总长度
+        std::uint64_t fileBytes = 0;
+        double seconds = 0;
+        bool cancelled = false;
+        std::string firstError;
+    };
+
+    // 并发导出 [firstUid, lastUid]，整个导出共用一个已授权会话；每个 UID 完成后调用 onPlayer(是否成功)，
+    // 返回 false 时停止派发新的 UID。服务器返回的错误（如玩家不存在）照常作为一行写入
+    // 会话建立或文件创建失败时抛出 std::runtime_error
+    static Stats exportRange(const Options &options, const std::function<bool(bool)> &onPlayer);
+};
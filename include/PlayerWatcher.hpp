@@ -0,0 +1,70 @@
+#pragma once
+#include "SessionManager.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 玩家监视：按固定间隔并发查询一组 UID 的 player_information，共用一个已授权会话，
+// 每个 UID 保存上一次的快照，只输出两次之间的结构化差异（JSON Patch 风格）
+// 响应文本与上次逐字节相同时不解析、不比较、不输出
+class PlayerWatcher
+{
+public:
+    struct Options
+    {
+        std::vector<std::string> uids;
+        int intervalSeconds = 5; // 两轮查询开始时刻的间隔
+        unsigned threads = 4;    // 同时进行的查询数
+    };
+
+    // 启动监视线程；已在监视或 UID 为空时返回 false
+    static bool start(Options options);
+
+    // 停止监视；正在进行的一轮查询结束后返回
+    static void stop();
+
+    static bool running();
+    static std::vector<std::string> watchedUids();
+
+    // 计算 before → after 的差异，返回操作数组，如
+    //   [{"op":"replace","path":"/level","old":60,"value":61}, {"op":"add","path":"/items/3","value":...}]
+    // 在 RFC 6902 的基础上，replace 与 remove 附带 "old" 便于阅读；数组尾部删除按下标从大到小排列
+    // 对象键按序归并遍历，整棵树只走一遍，相同的子树不产生任何输出
+    static json diff(const json &before, const json &after);
+
+    // 单个操作的一行文字描述，如 "replace /level: 60 → 61"
+    static std::string describe(const json &op);
+
+private:
+    struct Player
+    {
+        std::string uid;
+        std::string raw;       // 上一次的响应文本
+        json snapshot;         // 上一次的 data
+        bool hasSnapshot = false;
+        std::string lastError; // 相同的错误只提示一次
+    };
+
+    static void run();
+    static bool poll(Player &player, const SessionManager::Session &session); // 查询或解析失败时返回 false
+
+    static constexpr std::size_t MaxLinesPerPoll = 40; // 每个 UID 每轮最多输出的差异行数
+
+    static std::mutex watchMutex;
+    static std::condition_variable watchNotifier;
+    static std::thread watchThread;
+    static bool isRunning;
+    static bool stopping;
+    static Options options;
+    static std::vector<Player> players; // 仅监视线程访问
+
+    // 自动析构清理器：在程序结束时停止监视线程
+    class Finalizer
+    {
+    public:
+        ~Finalizer();
+    };
+    static Finalizer finalizer;
+};
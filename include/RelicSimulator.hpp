@@ -0,0 +1,76 @@
+#pragma once
+#include "ConsoleManager.hpp"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 遗器词条模拟器：按游戏的主词条/副词条概率表批量生成候选遗器（初始副词条与每 3 级一次的强化），
+// 用权重方案打分，只保留得分最高的若干件，再以 "副词条ID:次数" 的副词条写法提交
+// 随机数为 xoshiro256++，候选按固定大小的分块生成，每块的种子只由 (seed, 块号) 决定，
+// 因此同一种子在任意线程数下都得到同样的结果
+class RelicSimulator
+{
+public:
+    // 词条种类；副词条只会出现前 12 种
+    enum class Stat : std::uint8_t
+    {
+        Hp, Atk, Def, HpPct, AtkPct, DefPct, Spd, CritRate, CritDmg, EffectHit, EffectRes, BreakEffect,
+        Healing, EnergyRegen, PhysicalDmg, FireDmg, IceDmg, LightningDmg, WindDmg, QuantumDmg, ImaginaryDmg,
+        Count
+    };
+    static constexpr std::size_t StatCount = static_cast<std::size_t>(Stat::Count);
+
+    // 配置中使用的名称，如 "crit_rate"、"atk_pct"
+    static const char *statName(Stat stat);
+
+    // 权重方案：得分 = main[主词条] + Σ sub[副词条] × 命中次数
+    struct Profile
+    {
+        std::array<float, StatCount> main{};
+        std::array<float, StatCount> sub{};
+
+        // {"main": {"crit_rate": 3, ...}, "sub": {"crit_dmg": 1, ...}}；未知的词条名抛出 std::invalid_argument
+        static Profile fromJson(const json &j);
+        static Profile defaultProfile(); // 暴击向输出位
+    };
+
+    struct Options
+    {
+        Relic::Type type = Relic::Type::Tunnel;
+        int starRank = 5;
+        std::string relicId;
+        int partId = 1;
+        std::string level = "l15";       // 决定强化次数（每 3 级一次，不超过星级 × 3 级）
+        std::uint64_t candidates = 1000000;
+        std::size_t top = 5;
+        std::uint64_t seed = 0;
+        unsigned threads = 0;            // 0 为硬件并发数
+        Profile profile = Profile::defaultProfile();
+    };
+
+    struct Candidate
+    {
+        float score = 0;
+        std::uint64_t index = 0;         // 在本次模拟中的序号，同分时序号小者优先
+        std::uint8_t mainTag = 0;        // 主词条 ID（1 起）
+        std::uint8_t subCount = 0;
+        std::array<std::uint8_t, 4> subIds{};
+        std::array<std::uint8_t, 4> rolls{};
+
+        std::string subTag() const;      // "8:3 9:2 7:1 5:1"
+        Relic toRelic(const Options &options) const;
+    };
+
+    struct Result
+    {
+        std::vector<Candidate> best;     // 按得分从高到低
+        double seconds = 0;
+    };
+
+    // 部位无效或星级不在 2–5 时抛出 std::invalid_argument
+    static Result run(const Options &options);
+
+    static Stat mainStat(int partId, int mainTag);
+    static Stat subStat(int subId);
+};
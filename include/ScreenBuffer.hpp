@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 离屏字符格缓冲：每个格子存一个字符与样式，全角字符占两格（第二格为续格）
+// 仪表盘每帧画进一块新缓冲，再用 diff() 与终端上现有的那一帧比较，只写出变化的格子
+class ScreenBuffer
+{
+public:
+    // 样式：低 4 位为前景色，其余位为加粗、反显
+    enum Style : std::uint8_t
+    {
+        Plain = 0,
+        Red = 1,
+        Green = 2,
+        Yellow = 3,
+        Blue = 4,
+        Magenta = 5,
+        Cyan = 6,
+        White = 7,
+        Gray = 8,
+        Bold = 0x10,
+        Inverse = 0x20
+    };
+
+    struct Cell
+    {
+        char32_t ch = U' ';     // 0 表示全角字符的续格
+        std::uint8_t style = Plain;
+
+        bool operator==(const Cell &other) const { return ch == other.ch && style == other.style; }
+        bool operator!=(const Cell &other) const { return !(*this == other); }
+    };
+
+    ScreenBuffer() = default;
+    ScreenBuffer(int cols, int rows);
+
+    // 改变尺寸并清空
+    void resize(int cols, int rows);
+    void clear();
+
+    int cols() const { return width; }
+    int rows() const { return height; }
+    const Cell &at(int x, int y) const { return cells[static_cast<std::size_t>(y) * width + x]; }
+
+    // 从 (x, y) 起写入 UTF-8 文本，最多占 maxColumns 列（负数表示到行尾），返回实际占用的列数
+    // 放不下的全角字符用空格补齐；控制字符与组合字符不占格
+    int put(int x, int y, std::string_view utf8, std::uint8_t style = Plain, int maxColumns = -1);
+
+    // 用同一字符填充一段格子
+    void fill(int x, int y, int count, char32_t ch, std::uint8_t style = Plain);
+
+    // UTF-8 文本的显示宽度（列数）
+    static int displayWidth(std::string_view utf8);
+    static int charWidth(char32_t ch);
+
+    // 生成把终端从 front 变成 back 的转义序列，追加到 out
+    // 只移动光标到变化的格子；相邻变化之间的少量未变格子直接重写，比再发一次光标定位更省字节
+    // 尺寸不同时清屏后整屏重画；输出以默认样式结束，并假定终端开始时也处于默认样式
+    static void diff(const ScreenBuffer &front, const ScreenBuffer &back, std::string &out);
+
+private:
+    static void appendUtf8(char32_t ch, std::string &out);
+    static void appendStyle(std::uint8_t style, std::string &out);
+
+    int width = 0;
+    int height = 0;
+    std::vector<Cell> cells;
+};
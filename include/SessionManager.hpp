@@ -1,51 +1,85 @@
 #pragma once
+#include <mutex>
 #include <string>
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
 
+// 用服务器下发的 RSA 公钥（PEM）做 PKCS#1 v1.5 加密，结果为 Base64 文本
+std::string encrypt(const std::string &rsaPublicKeyPEM, const std::string &adminKeyPlain);
+
 class SessionManager
 {
 public:
+    // 进程启动时调用一次：curl 的全局初始化不是线程安全的，须在后台任务并发请求之前完成
+    static void initialize();
+
     static std::string base64Encode(const std::string &binary);
     static std::string base64Decode(const std::string& in);
+
+    // MUIP 请求体构造与响应解析，不涉及网络，可单独测量
+    static std::string buildCreateSessionBody();
+    static std::string buildAuthorizeBody(const std::string &sessionId, const std::string &rsaPublicKeyPEM, const std::string &adminKeyPlain);
+    static std::string buildServerStatusBody(const std::string &sessionId);
+    static std::string buildPlayerInfoBody(const std::string &sessionId, const std::string &playerUid);
+    static std::string buildCommandBody(const std::string &sessionId, const std::string &rsaPublicKeyPEM, const std::string &commandPlain, const std::string &targetUid);
+    static json parseResponse(const std::string &responseStr);
+
+    // 已授权的会话：批量提交时复用，省去每条命令的建会话与授权往返
+    struct Session
+    {
+        std::string serverUrl;
+        std::string sessionId;
+        std::string rsaPublicKey;
+    };
+
+    // 建立会话并授权；响应格式不对时抛出 std::runtime_error
+    static Session OpenSession(const std::string &serverUrl, const std::string &adminKeyPlain);
+
+    // 进程内共享的已授权会话：首次调用时建立，之后直接返回（本地控制套接字等长期运行的调用方共用）
+    // 服务器判定会话失效时调用 InvalidateSharedSession()，下次调用重新建立；其他线程已重建的会话不受影响
+    static Session SharedSession(const std::string &serverUrl, const std::string &adminKeyPlain);
+    static void InvalidateSharedSession(const std::string &sessionId);
+
     static json GetServerStatus(const std::string &serverUrl, const std::string &adminKeyPlain)
     {
-        json session = createSession(serverUrl);
-        authorize(
-            serverUrl,
-            session["data"]["sessionId"],
-            session["data"]["rsaPublicKey"],
-            adminKeyPlain);
-        return getServerStatus(serverUrl, session["data"]["sessionId"]);
+        Session session = OpenSession(serverUrl, adminKeyPlain);
+        return getServerStatus(serverUrl, session.sessionId);
     }
     static json GetPlayerInfo(const std::string &serverUrl, const std::string &adminKeyPlain, const std::string &playerUid)
     {
-        json session = createSession(serverUrl);
-        authorize(
-            serverUrl,
-            session["data"]["sessionId"],
-            session["data"]["rsaPublicKey"],
-            adminKeyPlain);
-        return getPlayerInfo(serverUrl, session["data"]["sessionId"], playerUid);
+        Session session = OpenSession(serverUrl, adminKeyPlain);
+        return getPlayerInfo(serverUrl, session.sessionId, playerUid);
     };
     static json SubmitCommand(const std::string &serverUrl, const std::string &adminKeyPlain, const std::string &commandPlain, const std::string &targetUid)
     {
-        json session = createSession(serverUrl);
-        authorize(
-            serverUrl,
-            session["data"]["sessionId"],
-            session["data"]["rsaPublicKey"],
-            adminKeyPlain);
-        return submitCommand(
-            serverUrl,
-            session["data"]["sessionId"],
-            session["data"]["rsaPublicKey"],
-            commandPlain,
-            targetUid);
+        return SubmitCommand(OpenSession(serverUrl, adminKeyPlain), commandPlain, targetUid);
     }
+    static json SubmitCommand(const Session &session, const std::string &commandPlain, const std::string &targetUid)
+    {
+        return submitCommand(session.serverUrl, session.sessionId, session.rsaPublicKey, commandPlain, targetUid);
+    }
+
+    // 单次请求的原始结果：不解析、不输出错误（压测按种类统计错误）
+    struct Response
+    {
+        long httpStatus = 0;        // 未收到响应时为 0
+        std::string body;
+        std::string transportError; // 连接、超时等错误，为空表示收到了响应
+    };
+
+    // POST 请求体到 serverUrl + path（如 "/muip/exec_cmd"）；timeoutMs 为 0 时不限时
+    static Response postOnce(const std::string &serverUrl, const char *path, const std::string &postData, long timeoutMs = 0);
+
+    // 经已有会话查询玩家信息，返回未解析的响应文本（监视模式先逐字节比较，相同则不必解析）
+    static std::string GetPlayerInfoRaw(const Session &session, const std::string &playerUid);
 
 private:
+    // POST JSON 请求体到 serverUrl + path，返回解析后的响应；failure 为请求失败时的提示前缀
+    // 每个线程复用一个 curl 句柄，同一服务器的连续请求走同一条 keep-alive 连接
+    static json post(const std::string &serverUrl, const char *path, const std::string &postData, const char *failure);
+    static std::string postRaw(const std::string &serverUrl, const char *path, const std::string &postData, const char *failure);
+
     static json createSession(const std::string &serverUrl);
     static json authorize(
         const std::string &serverUrl,
@@ -60,4 +94,8 @@ private:
         const std::string &rsaPublicKeyPEM,
         const std::string &commandPlain,
         const std::string &targetUid);
+
+    static std::mutex sharedMutex;
+    static Session shared;
+    static bool sharedValid;
 };
\ No newline at end of file
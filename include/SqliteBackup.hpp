@@ -0,0 +1,35 @@
+#pragma once
+#include <filesystem>
+#include <string>
+
+class IoThrottle;
+
+namespace fs = std::filesystem;
+
+// SQLite 在线备份：通过 sqlite3_backup_* 按小步拷贝页面，步间短暂停顿，
+// 让 DanhengServer 的写入几乎不受影响；页面经由 pager 读取，WAL 中的内容一并包含
+class SqliteBackup
+{
+public:
+    struct Stats
+    {
+        int pages = 0;        // 拷贝的总页数
+        int restarts = 0;     // 源库被其他连接修改导致的重新开始次数
+        double seconds = 0;
+        bool wal = false;     // 源库是否处于 WAL 模式
+    };
+
+    /**
+     * 备份 source 到 target（先写临时文件，完成后改名）
+     * @param pagesPerStep 每步拷贝页数
+     * @param pauseMs      步间停顿（毫秒）
+     * @param throttle     可选限速：每步按 页数 × 页大小 取令牌
+     */
+    static bool backup(const fs::path &source, const fs::path &target,
+                       int pagesPerStep, int pauseMs,
+                       Stats &stats, std::string &error,
+                       IoThrottle *throttle = nullptr);
+
+    // 非 WAL 模式下源库持续被写入时，每次修改都会让备份从头开始；超过此次数即放弃本次保存
+    static constexpr int MaxRestarts = 8;
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+
+// waitInput() 的返回原因
+enum class InputEvent
+{
+    Key,  // 有按键（或输入结束）可读
+    Wake  // 被 wakeInput() 唤醒
+};
+
+// 终端后端：屏蔽 Windows 控制台与 POSIX 终端（termios + ANSI）的差异
+// 按平台分别实现于 TerminalBackendWin32.cpp / TerminalBackendPosix.cpp
+class TerminalBackend
+{
+public:
+    // 初始化终端：Windows 下切换 UTF-8 代码页，POSIX 下关闭行缓冲与回显
+    static void init();
+
+    // 恢复终端初始设置（POSIX 下在退出或收到信号时自动调用）
+    static void restore();
+
+    // 标准输入/输出是否连接到交互式终端
+    static bool inputIsTty();
+    static bool outputIsTty();
+
+    // 非阻塞检测是否有按键待读
+    static bool keyAvailable();
+
+    // 阻塞等待按键或唤醒信号，期间不占用 CPU
+    static InputEvent waitInput();
+
+    // 唤醒阻塞在 waitInput() 中的线程（可在任意线程调用）
+    static void wakeInput();
+
+    // 读取一个按键：回车统一为 '\r'，退格统一为 '\b'，输入结束返回 -1
+    static int readKey();
+
+    // 直接写出一整块文本，绕过 iostream 缓冲（用于非终端输出时的批量写入）
+    static void write(const std::string &text, bool toStderr = false);
+
+    // 允许输出光标定位等 VT 控制序列（Windows 下开启虚拟终端处理），输出不是终端时返回 false
+    static bool enableVirtualTerminal();
+
+    // 终端可见区域的列数与行数，获取失败时返回 false
+    static bool size(int &cols, int &rows);
+};
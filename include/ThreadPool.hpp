@@ -0,0 +1,48 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// 固定大小的工作线程池；析构时执行完已提交的任务再退出
+class ThreadPool
+{
+public:
+    // threads 为 0 时取硬件并发数
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    // 提交任务，返回其结果的 future（任务抛出的异常会在 get() 时重新抛出）
+    template <class F>
+    auto submit(F &&task) -> std::future<decltype(task())>
+    {
+        using Result = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> future = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(tasksMutex);
+            tasks.emplace([packaged]
+                          { (*packaged)(); });
+        }
+        tasksNotifier.notify_one();
+        return future;
+    }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex tasksMutex;
+    std::condition_variable tasksNotifier;
+    bool stopping = false;
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 单层哈希时间轮：按整数刻度（tick）到期，到期时间对桶数取模落桶，
+// 超过一圈的定时器留在桶中等下一圈；插入 O(1)，推进只扫描经过的桶
+class TimerWheel
+{
+public:
+    explicit TimerWheel(std::size_t bucketCount = 256);
+
+    // 在 tick 刻度到期；不晚于当前刻度的按下一刻度处理
+    void schedule(int id, std::uint64_t tick);
+
+    // 推进到 now，把所有到期的 id 追加到 due
+    void advance(std::uint64_t now, std::vector<int> &due);
+
+    // 最早的到期刻度；一圈内没有定时器时返回 当前 + 桶数，为空时返回 UINT64_MAX
+    std::uint64_t nextDue() const;
+
+    std::uint64_t now() const { return current; }
+    bool empty() const { return count == 0; }
+
+private:
+    struct Entry
+    {
+        int id;
+        std::uint64_t deadline;
+    };
+
+    std::vector<std::vector<Entry>> buckets;
+    std::uint64_t current = 0;
+    std::size_t count = 0;
+};
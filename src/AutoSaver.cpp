@@ -1,105 +1,273 @@
 #include "AutoSaver.hpp"
 #include "ConsoleOutputManager.hpp"
-#include <fstream>
-#include <chrono>
-#include <ctime>
+#include "FileWatcher.hpp"
+#include <algorithm>
+#include <limits>
 
-std::atomic<bool> AutoSaver::isRunning{false};
-std::thread AutoSaver::workerThread;
-std::mutex AutoSaver::fileMutex;
+std::mutex AutoSaver::schedulerMutex;
+std::condition_variable AutoSaver::schedulerNotifier;
+std::thread AutoSaver::schedulerThread;
+bool AutoSaver::running = false;
+bool AutoSaver::stopping = false;
+bool AutoSaver::wakeup = false;
+AutoSaver::Clock::time_point AutoSaver::epoch = AutoSaver::Clock::now();
 
-fs::path AutoSaver::source;
-fs::path AutoSaver::saveRoot;
-int AutoSaver::interval = 0;
-int AutoSaver::slotIndex = 0;
-int AutoSaver::slotCount = 0;
-bool AutoSaver::saveImmediately = true;
+std::vector<std::unique_ptr<BackupJob>> AutoSaver::jobs;
+std::vector<AutoSaver::JobState> AutoSaver::states;
+std::vector<int> AutoSaver::pendingNow;
+TimerWheel AutoSaver::wheel;
 
 AutoSaver::Finalizer AutoSaver::finalizer;
 
-void AutoSaver::start(const fs::path &sourceFile,
-                      const fs::path &saveRootDir,
-                      int intervalSeconds,
-                      int slotCount_,
-                      bool saveImmediately_)
+int AutoSaver::addJob(BackupJob::Options options)
 {
-    if (isRunning.exchange(true))
-        return;
+    auto job = std::make_unique<BackupJob>(std::move(options));
+    const BackupJob::Options &opts = job->options();
+    const bool immediately = opts.saveImmediately;
+    const bool watch = opts.watch;
+    const fs::path source = opts.source;
+    const std::string name = opts.name;
 
-    source = sourceFile;
-    saveRoot = saveRootDir;
-    interval = intervalSeconds;
-    slotCount = slotCount_;
-    saveImmediately = saveImmediately_;
-    slotIndex = 0;
+    int id;
+    {
+        std::lock_guard<std::mutex> lock(schedulerMutex);
+        id = static_cast<int>(jobs.size());
+        jobs.push_back(std::move(job));
+        states.emplace_back();
+        if (immediately)
+            pendingNow.push_back(id);
+        schedule(id);
+        wakeup = true; // 新任务可能比调度线程当前等待的时刻更早到期
+    }
+    schedulerNotifier.notify_one();
 
-    workerThread = std::thread([]()
-                               { run(); });
+    if (watch)
+    {
+        // 在 schedulerMutex 之外登记，避免与监视线程的回调互相等待
+        if (FileWatcher::supported() && FileWatcher::watch(id, source))
+        {
+            {
+                std::lock_guard<std::mutex> lock(schedulerMutex);
+                states[id].watched = true;
+            }
+            FileWatcher::start(notifyChanged);
+        }
+        else
+            buffer("[" + name + "] 无法监视 " + source.string() + "，改为按间隔定时保存", MessageType::Warning);
+    }
+    return id;
 }
 
-void AutoSaver::triggerSaveNow()
+void AutoSaver::start()
 {
-    std::lock_guard<std::mutex> lock(fileMutex);
-    performSave();
+    std::lock_guard<std::mutex> lock(schedulerMutex);
+    if (running)
+        return;
+    running = true;
+    stopping = false;
+    for (auto &job : jobs)
+        job->resume();
+    schedulerThread = std::thread([]()
+                                  { run(); });
 }
 
-void AutoSaver::run()
+void AutoSaver::triggerSaveNow(int jobId)
+{
+    std::lock_guard<std::mutex> lock(schedulerMutex);
+    for (int id = 0; id < static_cast<int>(jobs.size()); ++id)
+        if (jobId < 0 || id == jobId)
+            pendingNow.push_back(id);
+    wakeup = true;
+    schedulerNotifier.notify_one();
+}
+
+void AutoSaver::stop()
 {
-    if (saveImmediately)
+    FileWatcher::stop();
     {
-        std::lock_guard<std::mutex> lock(fileMutex);
-        performSave(); // 启动立即保存
+        std::lock_guard<std::mutex> lock(schedulerMutex);
+        if (!running)
+            return;
+        stopping = true;
+        // 正在进行的保存可能卡在限速等待中（低限速下的大文件要几分钟），直接中止
+        for (auto &job : jobs)
+            job->cancel();
     }
+    schedulerNotifier.notify_one();
+    if (schedulerThread.joinable())
+        schedulerThread.join();
 
-    auto nextTick = std::chrono::steady_clock::now() + std::chrono::seconds(interval);
-    while (isRunning.load())
+    std::lock_guard<std::mutex> lock(schedulerMutex);
+    running = false;
+}
+
+std::vector<BackupJob::Options> AutoSaver::jobList()
+{
+    std::lock_guard<std::mutex> lock(schedulerMutex);
+    std::vector<BackupJob::Options> result;
+    for (const auto &job : jobs)
+        result.push_back(job->options());
+    return result;
+}
+
+std::vector<AutoSaver::Status> AutoSaver::status()
+{
+    std::lock_guard<std::mutex> lock(schedulerMutex);
+    const auto now = Clock::now();
+    std::vector<Status> result;
+    for (std::size_t id = 0; id < jobs.size(); ++id)
     {
-        std::this_thread::sleep_until(nextTick);
-        nextTick += std::chrono::seconds(interval);
+        const BackupJob::Options &opts = jobs[id]->options();
+        const JobState &state = states[id];
+        Status item;
+        item.name = opts.name.empty() ? opts.source.filename().string() : opts.name;
+        item.watched = state.watched;
+        item.dirty = state.dirty;
+        item.saving = state.saving;
+        if (running)
+            item.nextSaveSeconds = static_cast<int>(std::max<std::int64_t>(
+                0, std::chrono::duration_cast<std::chrono::seconds>(state.nextInterval - now).count()));
+        item.last = jobs[id]->outcome();
+        result.push_back(std::move(item));
+    }
+    return result;
+}
 
-        std::lock_guard<std::mutex> lock(fileMutex);
-        performSave();
+bool AutoSaver::withJob(int jobId, const std::function<void(BackupJob &)> &action)
+{
+    BackupJob *job;
+    {
+        std::lock_guard<std::mutex> lock(schedulerMutex);
+        if (jobId < 0 || jobId >= static_cast<int>(jobs.size()))
+            return false;
+        job = jobs[jobId].get();
     }
+    std::lock_guard<std::mutex> lock(job->mutex());
+    action(*job);
+    return true;
+}
+
+std::uint64_t AutoSaver::currentTick()
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::seconds>(Clock::now() - epoch).count());
 }
 
-void AutoSaver::performSave()
+std::uint64_t AutoSaver::tickAfter(Clock::time_point time)
 {
-    fs::path slotDir = saveRoot / ("slot_" + std::to_string(slotIndex));
-    fs::create_directories(slotDir);
-    fs::path targetFile = slotDir / source.filename();
+    const auto elapsed = std::chrono::ceil<std::chrono::seconds>(time - epoch).count();
+    return elapsed > 0 ? static_cast<std::uint64_t>(elapsed) : 0;
+}
+
+void AutoSaver::schedule(int jobId)
+{
+    const auto interval = static_cast<std::uint64_t>(jobs[jobId]->options().intervalSeconds);
+    const std::uint64_t tick = std::max(wheel.now(), currentTick()) + interval;
+    wheel.schedule(jobId * 2 + IntervalTimer, tick);
+    states[jobId].nextInterval = epoch + std::chrono::seconds(tick);
+}
+
+void AutoSaver::notifyChanged(int jobId)
+{
+    std::lock_guard<std::mutex> lock(schedulerMutex);
+    if (jobId < 0 || jobId >= static_cast<int>(states.size()))
+        return;
 
-    try
+    JobState &state = states[jobId];
+    state.dirty = true;
+    state.lastChange = Clock::now();
+
+    // 连续写入期间只保留一个去抖定时器，到期时再按最近一次变化顺延
+    if (state.debouncePending)
+        return;
+    state.debouncePending = true;
+    const std::chrono::seconds debounce(jobs[jobId]->options().debounceSeconds);
+    wheel.schedule(jobId * 2 + DebounceTimer, tickAfter(state.lastChange + debounce));
+    wakeup = true;
+    schedulerNotifier.notify_one();
+}
+
+void AutoSaver::run()
+{
+    std::unique_lock<std::mutex> lock(schedulerMutex);
+    while (!stopping)
     {
-        if (fs::exists(source))
+        wakeup = false;
+        std::vector<int> due;
+        due.swap(pendingNow);
+
+        std::vector<int> timers;
+        const std::uint64_t now = currentTick();
+        wheel.advance(now, timers);
+        for (int timer : timers)
         {
-            fs::copy_file(source, targetFile, fs::copy_options::overwrite_existing);
+            const int id = timer / 2;
+            JobState &state = states[id];
+            if (timer % 2 == IntervalTimer)
+            {
+                // 间隔定时器立即排入下一轮，间隔从本次到期时刻起算，保存耗时不影响节奏；
+                // 监视中的任务没有变化时直接跳过
+                schedule(id);
+                if (!state.watched || state.dirty)
+                    due.push_back(id);
+                continue;
+            }
 
-            time_t now = std::time(nullptr);
-            char timeStr[26];
-            ctime_s(timeStr, sizeof(timeStr), &now);
-            std::string timestamp(timeStr);
-            timestamp.pop_back(); // 去掉换行符
+            // 去抖定时器：期间仍有写入则顺延到最近一次变化之后
+            const auto quietAt = state.lastChange + std::chrono::seconds(jobs[id]->options().debounceSeconds);
+            if (state.dirty && quietAt > Clock::now())
+            {
+                wheel.schedule(timer, tickAfter(quietAt));
+                continue;
+            }
+            state.debouncePending = false;
+            if (state.dirty)
+                due.push_back(id);
+        }
 
-            buffer("自动保存完成：#" + std::to_string(slotIndex) + " @" + timestamp,
-                   MessageType::Info);
+        if (due.empty())
+        {
+            const std::uint64_t next = wheel.nextDue();
+            auto ready = []
+            { return stopping || wakeup; };
+            if (next == std::numeric_limits<std::uint64_t>::max())
+                schedulerNotifier.wait(lock, ready);
+            else
+                schedulerNotifier.wait_until(lock, epoch + std::chrono::seconds(next), ready);
+            continue;
         }
-        else
+
+        // 同一任务同时被手动触发和定时触发时只保存一次
+        std::sort(due.begin(), due.end());
+        due.erase(std::unique(due.begin(), due.end()), due.end());
+
+        // unique_ptr 指向的对象地址稳定，解锁后 addJob 扩容 jobs 也不影响
+        // 先清除变化标记：保存期间的新写入会重新标记并排入下一次
+        std::vector<BackupJob *> batch;
+        for (int id : due)
         {
-            buffer("自动保存源文件不存在：" + source.string(), MessageType::Warning);
+            batch.push_back(jobs[id].get());
+            states[id].dirty = false;
         }
-    }
-    catch (const std::exception &e)
-    {
-        buffer("自动保存失败 (槽 #" + std::to_string(slotIndex) + "): " + e.what(),
-               MessageType::Error);
-    }
 
-    slotIndex = (slotIndex + 1) % slotCount;
+        lock.unlock();
+        for (std::size_t i = 0; i < batch.size(); ++i)
+        {
+            {
+                std::lock_guard<std::mutex> mark(schedulerMutex);
+                states[due[i]].saving = true;
+            }
+            batch[i]->save();
+            std::lock_guard<std::mutex> check(schedulerMutex);
+            states[due[i]].saving = false;
+            if (stopping)
+                break;
+        }
+        lock.lock();
+    }
 }
 
 AutoSaver::Finalizer::~Finalizer()
 {
-    isRunning = false;
-    if (workerThread.joinable())
-        workerThread.join();
-}
\ No newline at end of file
+    stop();
+}
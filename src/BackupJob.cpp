@@ -0,0 +1,641 @@
+#include "BackupJob.hpp"
+#include "BackupManager.hpp"
+#include "ConsoleOutputManager.hpp"
+#include "ChunkStore.hpp"
+#include "FileCopier.hpp"
+#include "GzipSnapshot.hpp"
+#include "SqliteBackup.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    // 当前本地时间，格式同 ctime()（不含换行）
+    std::string currentTimestamp()
+    {
+        time_t now = std::time(nullptr);
+        std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &now);
+#else
+        localtime_r(&now, &local);
+#endif
+        char timeStr[32];
+        std::strftime(timeStr, sizeof(timeStr), "%a %b %d %H:%M:%S %Y", &local);
+        return timeStr;
+    }
+
+    // 开始覆盖槽位前删除旧清单，避免旧清单与写了一半的新产物配对
+    void dropManifest(const fs::path &slotDir, const fs::path &source)
+    {
+        std::error_code ec;
+        fs::remove(BackupManager::manifestPath(slotDir, source), ec);
+    }
+}
+
+BackupJob::Instruments::Instruments(const std::string &job)
+    : saves(Metrics::counter("danheng_console_autosave_saves_total", "写入了槽位的自动保存次数", {{"job", job}})),
+      skipped(Metrics::counter("danheng_console_autosave_skipped_total", "源未变化而跳过的自动保存次数", {{"job", job}})),
+      failures(Metrics::counter("danheng_console_autosave_failures_total", "失败的自动保存次数", {{"job", job}})),
+      bytes(Metrics::counter("danheng_console_autosave_bytes_written_total", "自动保存写入的字节数", {{"job", job}})),
+      duration(Metrics::histogram("danheng_console_autosave_duration_seconds", "自动保存耗时（秒）",
+                                  Metrics::saveBuckets(), {{"job", job}})),
+      lastSuccess(Metrics::gauge("danheng_console_autosave_last_success_timestamp_seconds",
+                                 "最近一次自动保存成功的 Unix 时间", {{"job", job}}))
+{
+}
+
+BackupJob::BackupJob(Options options)
+    : opts(std::move(options)),
+      throttle(opts.maxMegabytesPerSecond),
+      metrics(opts.name)
+{
+    // "logs/" 这类带结尾分隔符的目录，filename() 为空，去掉分隔符
+    if (!opts.source.has_filename() && opts.source.has_parent_path())
+        opts.source = opts.source.parent_path();
+    // 槽位数为 0 会导致轮换时除零
+    if (opts.slotCount < 1)
+        opts.slotCount = 1;
+    if (opts.intervalSeconds < 1)
+        opts.intervalSeconds = 1;
+    if (opts.debounceSeconds < 1)
+        opts.debounceSeconds = 1;
+    opts.compressLevel = std::clamp(opts.compressLevel, 1, 9);
+    if (opts.sqlitePagesPerStep < 1)
+        opts.sqlitePagesPerStep = 64;
+    if (opts.sqlitePauseMs < 0)
+        opts.sqlitePauseMs = 0;
+
+    std::error_code ec;
+    if (fs::is_directory(opts.source, ec) && opts.mode != SaveMode::Copy)
+        buffer(label() + "目录源只支持 copy 方式，已忽略配置的保存方式", MessageType::Warning);
+}
+
+BackupJob::Outcome BackupJob::outcome() const
+{
+    std::lock_guard<std::mutex> lock(outcomeMutex);
+    return lastOutcome;
+}
+
+std::string BackupJob::label() const
+{
+    return opts.name.empty() ? std::string() : "[" + opts.name + "] ";
+}
+
+BackupJob::Tree BackupJob::listTree(const fs::path &root)
+{
+    Tree tree;
+    for (const auto &entry : fs::recursive_directory_iterator(root))
+    {
+        if (!entry.is_regular_file())
+            continue;
+        // lexically_relative 只做字符串运算；fs::relative 会对两端路径逐级解析符号链接
+        tree.push_back(TreeEntry{entry.path().lexically_relative(root), entry.file_size(),
+                                 entry.last_write_time().time_since_epoch().count()});
+    }
+    std::sort(tree.begin(), tree.end(), [](const TreeEntry &a, const TreeEntry &b)
+              { return a.relative < b.relative; });
+    return tree;
+}
+
+// 文件列表指纹（FNV-1a）：任一文件增删、大小或修改时间变化都会改变指纹
+std::string BackupJob::fingerprint(const Tree &tree)
+{
+    std::uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](const void *data, std::size_t size)
+    {
+        const auto *bytes = static_cast<const unsigned char *>(data);
+        for (std::size_t i = 0; i < size; ++i)
+            h = (h ^ bytes[i]) * 1099511628211ull;
+    };
+    for (const auto &entry : tree)
+    {
+        std::string name = entry.relative.generic_string();
+        mix(name.data(), name.size() + 1);
+        mix(&entry.size, sizeof(entry.size));
+        mix(&entry.mtime, sizeof(entry.mtime));
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(h));
+    return hex;
+}
+
+const char *BackupJob::modeName(SaveMode mode)
+{
+    switch (mode)
+    {
+    case SaveMode::Incremental:
+        return "incremental";
+    case SaveMode::Compressed:
+        return "compressed";
+    case SaveMode::Sqlite:
+        return "sqlite";
+    default:
+        return "copy";
+    }
+}
+
+void BackupJob::save()
+{
+    std::lock_guard<std::mutex> lock(saveMutex);
+    IoPriorityScope priority(opts.lowIoPriority);
+    fs::path slotDir = opts.destination / ("slot_" + std::to_string(slotIndex));
+
+    try
+    {
+        if (!fs::exists(opts.source))
+        {
+            buffer(label() + "自动保存源不存在：" + opts.source.string(), MessageType::Warning);
+            metrics.failures.add();
+            return;
+        }
+
+        SavedState state;
+        state.valid = true;
+        const bool isDirectory = fs::is_directory(opts.source);
+        Tree tree;
+
+        if (isDirectory)
+        {
+            // 目录：只 stat 不读内容，文件列表指纹未变化即跳过；同一份列表直接用于快照
+            tree = listTree(opts.source);
+            for (const auto &entry : tree)
+            {
+                state.size += entry.size;
+                state.mtime = std::max(state.mtime, entry.mtime);
+            }
+            state.hash = fingerprint(tree);
+            if (lastSaved.valid && state.hash == lastSaved.hash)
+            {
+                metrics.skipped.add();
+                return;
+            }
+        }
+        else
+        {
+            state.size = fs::file_size(opts.source);
+            state.mtime = fs::last_write_time(opts.source).time_since_epoch().count();
+
+            // WAL 模式下写入先落在 -wal 文件，主库只在检查点时变化，一并纳入判断
+            if (opts.mode == SaveMode::Sqlite)
+            {
+                fs::path wal = opts.source;
+                wal += "-wal";
+                std::error_code ec;
+                if (fs::exists(wal, ec))
+                {
+                    state.size += fs::file_size(wal, ec);
+                    state.mtime = std::max<std::int64_t>(state.mtime, fs::last_write_time(wal, ec).time_since_epoch().count());
+                }
+            }
+
+            // 大小与修改时间均未变化：视为未修改，不读不写
+            if (lastSaved.valid && state.size == lastSaved.size && state.mtime == lastSaved.mtime)
+            {
+                metrics.skipped.add();
+                return;
+            }
+        }
+
+        fs::create_directories(slotDir);
+        auto startTime = std::chrono::steady_clock::now();
+        bytesWritten = 0;
+        ManifestFiles files;
+        bool saved = false;
+        if (isDirectory)
+            saved = saveDirectory(slotDir, tree, files);
+        else
+        {
+            switch (opts.mode)
+            {
+            case SaveMode::Incremental:
+                saved = saveIncremental(slotDir, state, files);
+                break;
+            case SaveMode::Compressed:
+                saved = saveCompressed(slotDir, state, files);
+                break;
+            case SaveMode::Sqlite:
+                saved = saveSqlite(slotDir, state, files);
+                break;
+            default:
+                saved = saveCopy(slotDir, state, files);
+                break;
+            }
+        }
+        lastSaved = state;
+        if (!saved)
+        {
+            metrics.skipped.add(); // 内容哈希未变化（仅修改时间变了）
+            return;
+        }
+
+        // 产物已原子换入，最后写清单；两者之间崩溃时清单缺失，校验会把该槽位判为不可用
+        SlotManifest manifest;
+        manifest.job = opts.name;
+        manifest.mode = isDirectory ? "directory" : modeName(opts.mode);
+        manifest.slot = slotIndex;
+        manifest.savedAt = std::chrono::duration_cast<std::chrono::seconds>(
+                               std::chrono::system_clock::now().time_since_epoch())
+                               .count();
+        manifest.sourceSize = state.size;
+        manifest.sourceMtime = state.mtime;
+        manifest.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        manifest.bytesWritten = bytesWritten;
+        manifest.files = std::move(files);
+        if (!BackupManager::writeManifest(BackupManager::manifestPath(slotDir, opts.source), manifest))
+            buffer(label() + "槽位清单写入失败：#" + std::to_string(slotIndex), MessageType::Warning);
+        recordSave(manifest);
+        {
+            std::lock_guard<std::mutex> outcomeLock(outcomeMutex);
+            lastOutcome = {manifest.savedAt, manifest.slot, manifest.seconds, manifest.bytesWritten, std::string()};
+        }
+        metrics.saves.add();
+        metrics.bytes.add(manifest.bytesWritten);
+        metrics.duration.observe(manifest.seconds);
+        metrics.lastSuccess.set(manifest.savedAt);
+
+        slotIndex = (slotIndex + 1) % opts.slotCount;
+    }
+    catch (const std::exception &e)
+    {
+        // 程序退出时被 cancel() 中止：各保存方式已删除临时文件，不算作失败
+        if (throttle.cancelled())
+        {
+            buffer(label() + "保存已中止 (槽 #" + std::to_string(slotIndex) + ")，临时文件已删除", MessageType::Warning);
+            return;
+        }
+        buffer(label() + "自动保存失败 (槽 #" + std::to_string(slotIndex) + "): " + e.what(),
+               MessageType::Error);
+        {
+            std::lock_guard<std::mutex> outcomeLock(outcomeMutex);
+            lastOutcome.error = e.what();
+        }
+        metrics.failures.add();
+        slotIndex = (slotIndex + 1) % opts.slotCount;
+    }
+}
+
+// 整文件复制（临时文件 + fsync + 原子改名，Linux 下优先 reflink/copy_file_range，数据不经过用户态）
+// 复制前先对源计算内容哈希，与上次相同时不动槽位并返回 false
+bool BackupJob::saveCopy(const fs::path &slotDir, SavedState &state, ManifestFiles &files)
+{
+    state.hash = ChunkStore::hashFile(opts.source, &throttle);
+    if (!state.hash.empty() && state.hash == lastSaved.hash)
+        return false;
+
+    dropManifest(slotDir, opts.source);
+    const fs::path target = slotDir / opts.source.filename();
+    FileCopier::Stats stats;
+    std::string error;
+    if (!FileCopier::copyAtomic(opts.source, target, stats, error, FileCopier::Method::Auto, &throttle))
+        throw std::runtime_error(error);
+    bytesWritten = stats.bytes;
+
+    // 校验和取自写入后的副本，而不是可能已被继续修改的源
+    SlotManifest::Entry entry{opts.source.filename().string()};
+    // 限速或低优先级时单线程读取，避免保存末尾出现一次全速的整文件读
+    const unsigned crcThreads = throttle.limited() || opts.lowIoPriority ? 1 : 0;
+    if (!BackupManager::crc32File(target, crcThreads, entry.crc, entry.size, &throttle))
+        throw std::runtime_error("计算校验和失败");
+    files.push_back(entry);
+
+    const double mib = 1024.0 * 1024.0;
+    char detail[128];
+    std::snprintf(detail, sizeof(detail), "（%s，%.1f MiB，%.0f MiB/s）",
+                  FileCopier::methodName(stats.method), stats.bytes / mib,
+                  stats.seconds > 0 ? stats.bytes / mib / stats.seconds : 0.0);
+
+    buffer(label() + "自动保存完成：#" + std::to_string(slotIndex) + " @" + currentTimestamp() + detail,
+           MessageType::Info);
+    return true;
+}
+
+// 分块增量保存：只写入块存储中还没有的块，槽位只保存清单
+bool BackupJob::saveIncremental(const fs::path &slotDir, SavedState &state, ManifestFiles &files)
+{
+    const fs::path storeDir = opts.destination / "chunks";
+    ChunkStore::Result result;
+    if (!ChunkStore::storeFile(opts.source, storeDir, result, &throttle))
+        throw std::runtime_error("读取源文件或写入块存储失败");
+
+    state.hash = result.fileHash;
+    state.size = result.fileSize;
+    if (state.hash == lastSaved.hash)
+        return false;
+
+    dropManifest(slotDir, opts.source);
+    fs::path manifest = slotDir / (opts.source.filename().string() + ".manifest.json");
+    if (!ChunkStore::writeManifest(manifest, result, state.mtime))
+        throw std::runtime_error("写入清单失败");
+    files.push_back(SlotManifest::Entry{manifest.filename().string(), result.fileSize, result.fileCrc});
+    bytesWritten = result.newBytes;
+
+    // 槽位被覆盖后，旧清单独占的块不再被引用，清理掉
+    // 同一保存根目录下的其他任务共用块存储，所有槽位里的块清单都要算作引用
+    const std::string suffix = ".manifest.json";
+    std::vector<fs::path> manifests;
+    std::error_code ec;
+    for (fs::directory_iterator slots(opts.destination, ec), end; !ec && slots != end; slots.increment(ec))
+    {
+        if (!slots->is_directory() || slots->path().filename().string().rfind("slot_", 0) != 0)
+            continue;
+        std::error_code slotEc;
+        for (fs::directory_iterator it(slots->path(), slotEc), itEnd; !slotEc && it != itEnd; it.increment(slotEc))
+        {
+            const std::string name = it->path().filename().string();
+            if (it->is_regular_file() && name.size() > suffix.size() &&
+                name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+                manifests.push_back(it->path());
+        }
+        if (slotEc)
+            ec = slotEc;
+    }
+    std::size_t removed = 0;
+    std::string gcError;
+    if (ec)
+        buffer(label() + "无法列出槽位，跳过块清理: " + ec.message(), MessageType::Warning);
+    else if (!ChunkStore::collectGarbage(storeDir, manifests, removed, gcError))
+        buffer(label() + "跳过块清理: " + gcError, MessageType::Warning);
+
+    buffer(label() + "增量保存完成：#" + std::to_string(slotIndex) + " @" + currentTimestamp() +
+               "（新增块 " + std::to_string(result.newChunks) + "/" + std::to_string(result.chunks.size()) +
+               "，写入 " + std::to_string(result.newBytes / 1024) + " KiB，清理块 " + std::to_string(removed) + "）",
+           MessageType::Info);
+    return true;
+}
+
+// 并行压缩快照；内容哈希（压缩时顺带计算）与上次相同时丢弃快照并返回 false
+bool BackupJob::saveCompressed(const fs::path &slotDir, SavedState &state, ManifestFiles &files)
+{
+    const std::string name = opts.source.filename().string() + ".gz";
+    bool changed = true;
+    GzipSnapshot::Stats stats;
+    const bool compressed = GzipSnapshot::compress(
+        opts.source, slotDir / name, opts.compressLevel, opts.compressThreads, stats, &throttle,
+        [&](const GzipSnapshot::Stats &done)
+        {
+            state.hash = done.sha256;
+            changed = state.hash != lastSaved.hash;
+            if (changed)
+                dropManifest(slotDir, opts.source);
+            return changed;
+        });
+    if (!compressed)
+        throw std::runtime_error("压缩快照写入失败");
+    if (!changed)
+        return false;
+    bytesWritten = stats.outputBytes;
+    files.push_back(SlotManifest::Entry{name, stats.inputBytes, stats.crc});
+
+    const double mib = 1024.0 * 1024.0;
+    char detail[128];
+    std::snprintf(detail, sizeof(detail), "（%.1f MiB → %.1f MiB，%.0f MiB/s）",
+                  stats.inputBytes / mib, stats.outputBytes / mib,
+                  stats.seconds > 0 ? stats.inputBytes / mib / stats.seconds : 0.0);
+
+    buffer(label() + "压缩保存完成：#" + std::to_string(slotIndex) + " @" + currentTimestamp() + detail,
+           MessageType::Info);
+    return true;
+}
+
+// SQLite 在线备份：文件级哈希对 WAL 数据库没有意义，只要大小或修改时间变化就备份
+bool BackupJob::saveSqlite(const fs::path &slotDir, SavedState &, ManifestFiles &files)
+{
+    SqliteBackup::Stats stats;
+    std::string error;
+    dropManifest(slotDir, opts.source);
+    const fs::path target = slotDir / opts.source.filename();
+    if (!SqliteBackup::backup(opts.source, target, opts.sqlitePagesPerStep, opts.sqlitePauseMs, stats, error, &throttle))
+        throw std::runtime_error("SQLite 在线备份失败: " + error);
+
+    SlotManifest::Entry entry{opts.source.filename().string()};
+    // 限速或低优先级时单线程读取，避免保存末尾出现一次全速的整文件读
+    const unsigned crcThreads = throttle.limited() || opts.lowIoPriority ? 1 : 0;
+    if (!BackupManager::crc32File(target, crcThreads, entry.crc, entry.size, &throttle))
+        throw std::runtime_error("计算校验和失败");
+    files.push_back(entry);
+    bytesWritten = entry.size;
+
+    char detail[128];
+    std::snprintf(detail, sizeof(detail), "（%d 页，%.0f 页/秒，重新开始 %d 次%s）",
+                  stats.pages, stats.seconds > 0 ? stats.pages / stats.seconds : 0.0,
+                  stats.restarts, stats.wal ? "，WAL" : "");
+
+    buffer(label() + "SQLite 在线备份完成：#" + std::to_string(slotIndex) + " @" + currentTimestamp() + detail,
+           MessageType::Info);
+    return true;
+}
+
+// 目录树快照：与上一个槽位相比大小和修改时间都没变的文件直接硬链接，其余文件在小线程池上并行复制；
+// 全部写入 slot_N/<目录名>.tmp 后统一落盘，再整体换入 slot_N/<目录名>
+bool BackupJob::saveDirectory(const fs::path &slotDir, const Tree &tree, ManifestFiles &manifestFiles)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    const fs::path dirName = opts.source.filename();
+    const fs::path target = slotDir / dirName;
+    fs::path tmp = target;
+    tmp += ".tmp";
+    fs::path old = target;
+    old += ".old";
+
+    // 上一次保存的槽位；只有一个槽位时就是正在覆盖的这个，旧副本在换入前一直存在
+    const int previousSlot = (slotIndex + opts.slotCount - 1) % opts.slotCount;
+    const fs::path previousDir = opts.destination / ("slot_" + std::to_string(previousSlot));
+    SlotManifest previous;
+    std::unordered_map<std::string, const SlotManifest::Entry *> reusable;
+    if (BackupManager::readManifest(BackupManager::manifestPath(previousDir, opts.source), previous) &&
+        previous.mode == "directory")
+    {
+        for (const auto &entry : previous.files)
+            if (entry.mtime != 0)
+                reusable.emplace(entry.path, &entry);
+    }
+
+    std::error_code ec;
+    dropManifest(slotDir, opts.source);
+    fs::remove_all(tmp, ec);
+    fs::create_directories(tmp);
+
+    // 目录先串行建好（列表已排序，同一目录的文件相邻），工作线程只处理文件
+    manifestFiles.resize(tree.size());
+    fs::path lastParent;
+    for (std::size_t i = 0; i < tree.size(); ++i)
+    {
+        manifestFiles[i].path = (dirName / tree[i].relative).generic_string();
+        manifestFiles[i].mtime = tree[i].mtime;
+        const fs::path parent = tree[i].relative.parent_path();
+        if (!parent.empty() && parent != lastParent)
+        {
+            fs::create_directories(tmp / parent);
+            lastParent = parent;
+        }
+    }
+
+    std::atomic<std::size_t> filesDone{0};
+    std::atomic<std::size_t> filesLinked{0};
+    std::atomic<std::uint64_t> bytesCopied{0};
+    std::atomic<bool> failed{false};
+    std::mutex errorMutex;
+    std::string firstError;
+    auto fail = [&](const fs::path &relative, const std::string &error)
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (firstError.empty())
+            firstError = relative.string() + ": " + error;
+        failed = true;
+    };
+
+    // 每个文件只写自己的清单项，不需要加锁
+    auto snapshotFile = [&](std::size_t i)
+    {
+        const TreeEntry &file = tree[i];
+        SlotManifest::Entry &entry = manifestFiles[i];
+        const fs::path to = tmp / file.relative;
+
+        auto found = reusable.find(entry.path);
+        if (found != reusable.end() && found->second->size == file.size && found->second->mtime == file.mtime)
+        {
+            // 跨文件系统、不支持硬链接或旧副本已不完整时退回复制
+            const fs::path from = previousDir / entry.path;
+            std::error_code linkError;
+            if (fs::file_size(from, linkError) == file.size && !linkError)
+            {
+                fs::create_hard_link(from, to, linkError);
+                if (!linkError)
+                {
+                    entry.size = file.size;
+                    entry.crc = found->second->crc;
+                    ++filesLinked;
+                    ++filesDone;
+                    return;
+                }
+            }
+        }
+
+        FileCopier::Stats stats;
+        std::string error;
+        if (!FileCopier::copyInto(opts.source / file.relative, to, stats, error, &throttle))
+            return fail(file.relative, error);
+        if (!BackupManager::crc32File(to, 1, entry.crc, entry.size, &throttle))
+            return fail(file.relative, "计算校验和失败");
+        bytesCopied += stats.bytes;
+        ++filesDone;
+    };
+
+    // 小文件按批提交，减少任务调度开销；大文件单独成批
+    constexpr std::size_t BatchFiles = 64;
+    constexpr std::uint64_t BatchBytes = 8 * 1024 * 1024;
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+    for (std::size_t begin = 0; begin < tree.size();)
+    {
+        std::size_t end = begin;
+        std::uint64_t bytes = 0;
+        while (end < tree.size() && end - begin < BatchFiles && bytes < BatchBytes)
+            bytes += tree[end++].size;
+        ranges.emplace_back(begin, end);
+        begin = end;
+    }
+    auto runBatch = [&](std::pair<std::size_t, std::size_t> range)
+    {
+        for (std::size_t i = range.first; i < range.second && !failed; ++i)
+        {
+            try
+            {
+                snapshotFile(i);
+            }
+            catch (const std::exception &e)
+            {
+                fail(tree[i].relative, e.what());
+            }
+        }
+    };
+
+    unsigned threads = opts.copyThreads ? opts.copyThreads : std::thread::hardware_concurrency();
+    threads = static_cast<unsigned>(std::clamp<std::size_t>(ranges.size(), 1, std::max(1u, threads)));
+    const double mib = 1024.0 * 1024.0;
+    {
+        // 线程池在作用域结束前析构，保证任务不会比它引用的局部变量活得更久
+        ThreadPool pool(threads);
+        std::vector<std::future<void>> batches;
+        batches.reserve(ranges.size());
+        // I/O 优先级按线程生效，save() 中的设置只作用于调度线程，工作线程需各自降低
+        for (const auto &range : ranges)
+            batches.push_back(pool.submit([this, &runBatch, range]
+                                          {
+                                              IoPriorityScope priority(opts.lowIoPriority);
+                                              runBatch(range); }));
+
+        // 调度线程等待期间每秒报告一次进度
+        const auto reportEvery = std::chrono::seconds(1);
+        auto nextReport = startTime + reportEvery;
+        for (auto &batch : batches)
+        {
+            while (batch.wait_until(nextReport) == std::future_status::timeout)
+            {
+                const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+                char progress[160];
+                std::snprintf(progress, sizeof(progress), "目录快照进度：%zu/%zu 个文件，已复制 %.1f MiB（%.0f MiB/s）",
+                              filesDone.load(), tree.size(), bytesCopied / mib, bytesCopied / mib / elapsed);
+                buffer(label() + progress, MessageType::Info);
+                nextReport += reportEvery;
+            }
+        }
+    }
+
+    std::string error;
+    if (failed || !FileCopier::syncTree(tmp, error))
+    {
+        fs::remove_all(tmp, ec);
+        throw std::runtime_error(failed ? firstError : error);
+    }
+    bytesWritten = bytesCopied;
+
+    // 目录不能原子覆盖非空目录：旧副本先移开，新副本换入后再删除
+    fs::remove_all(old, ec);
+    if (fs::exists(target))
+        fs::rename(target, old);
+    fs::rename(tmp, target);
+    fs::remove_all(old, ec);
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    char detail[192];
+    std::snprintf(detail, sizeof(detail), "（%zu 个文件：复制 %zu、硬链接 %zu；%.1f MiB，%.0f MiB/s，%.2f 秒，%u 线程）",
+                  tree.size(), tree.size() - filesLinked.load(), filesLinked.load(), bytesCopied / mib,
+                  seconds > 0 ? bytesCopied / mib / seconds : 0.0, seconds, threads);
+
+    buffer(label() + "目录保存完成：#" + std::to_string(slotIndex) + " @" + currentTimestamp() + detail,
+           MessageType::Info);
+    return true;
+}
+
+// 每次保存追加一行 CSV，便于根据实际耗时与写入量调整限速
+void BackupJob::recordSave(const SlotManifest &manifest) const
+{
+    const fs::path log = opts.destination / "save_log.csv";
+    std::error_code ec;
+    const bool fresh = !fs::exists(log, ec);
+
+    std::ofstream out(log, std::ios::app);
+    if (!out.is_open())
+        return;
+    if (fresh)
+        out << "saved_at,job,slot,mode,bytes_written,seconds,mb_per_s,limit_mb_per_s\n";
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "%lld,%s,%d,%s,%llu,%.3f,%.1f,%.1f\n",
+                  static_cast<long long>(manifest.savedAt), manifest.job.c_str(), manifest.slot,
+                  manifest.mode.c_str(), static_cast<unsigned long long>(manifest.bytesWritten),
+                  manifest.seconds,
+                  manifest.seconds > 0 ? manifest.bytesWritten / (1024.0 * 1024.0) / manifest.seconds : 0.0,
+                  opts.maxMegabytesPerSecond);
+    out << line;
+}
@@ -0,0 +1,443 @@
+#include "BackupManager.hpp"
+#include "ChunkStore.hpp"
+#include "FileCopier.hpp"
+#include "IoThrottle.hpp"
+#include "ThreadPool.hpp"
+#include <nlohmann/json.hpp>
+#include <sqlite3.h>
+#include <zlib.h>
+#include <algorithm>
+#include <fstream>
+#include <functional>
+
+using json = nlohmann::json;
+
+namespace
+{
+    constexpr std::size_t ReadBufferSize = 1024 * 1024;
+    constexpr std::uint64_t CrcBlockSize = 8 * 1024 * 1024;
+
+    using Sink = std::function<bool(const char *, std::size_t)>;
+
+    fs::path slotDir(const BackupJob::Options &options, int slot)
+    {
+        return options.destination / ("slot_" + std::to_string(slot));
+    }
+
+    // 数据库是否仍被其他连接使用：不等待地尝试独占锁
+    // WAL 模式下任何打开的连接都会使其失败；回滚日志模式下只能发现进行中的事务
+    bool sqliteInUse(const fs::path &path)
+    {
+        sqlite3 *db = nullptr;
+        if (sqlite3_open_v2(path.string().c_str(), &db, SQLITE_OPEN_READWRITE, nullptr) != SQLITE_OK)
+        {
+            sqlite3_close_v2(db);
+            return false;
+        }
+        sqlite3_busy_timeout(db, 0);
+        int rc = sqlite3_exec(db, "PRAGMA locking_mode=EXCLUSIVE", nullptr, nullptr, nullptr);
+        if (rc == SQLITE_OK)
+            rc = sqlite3_exec(db, "BEGIN EXCLUSIVE", nullptr, nullptr, nullptr);
+        const bool busy = rc == SQLITE_BUSY || rc == SQLITE_LOCKED;
+        if (rc == SQLITE_OK)
+            sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+        sqlite3_close_v2(db);
+        return busy;
+    }
+
+    // 把槽位中一个产物按保存方式解码为原始内容，逐块交给 sink
+    bool decodeEntry(const std::string &mode, const fs::path &dir, const fs::path &storeDir,
+                     const SlotManifest::Entry &entry, const Sink &sink, std::string &error)
+    {
+        const fs::path artifact = dir / fs::path(entry.path);
+        std::vector<char> buffer(ReadBufferSize);
+
+        if (mode == "compressed")
+        {
+            gzFile gz = gzopen(artifact.string().c_str(), "rb");
+            if (!gz)
+            {
+                error = "无法打开 " + entry.path;
+                return false;
+            }
+            gzbuffer(gz, 256 * 1024);
+            int n;
+            bool ok = true;
+            while (ok && (n = gzread(gz, buffer.data(), static_cast<unsigned>(buffer.size()))) > 0)
+                ok = sink(buffer.data(), static_cast<std::size_t>(n));
+            // gzread 在成员 CRC 或长度不符时返回 -1
+            if (ok && n < 0)
+            {
+                int code;
+                error = entry.path + " 解压失败: " + gzerror(gz, &code);
+                ok = false;
+            }
+            gzclose(gz);
+            return ok;
+        }
+
+        if (mode == "incremental")
+        {
+            std::vector<ChunkStore::ChunkRef> chunks;
+            if (!ChunkStore::readManifest(artifact, chunks))
+            {
+                error = "无法读取块清单 " + entry.path;
+                return false;
+            }
+            for (const auto &ref : chunks)
+            {
+                std::ifstream in(ChunkStore::chunkPath(storeDir, ref.hash), std::ios::binary);
+                buffer.resize(ref.size);
+                if (!in.read(buffer.data(), ref.size))
+                {
+                    error = "缺少或损坏的块 " + ref.hash.substr(0, 12);
+                    return false;
+                }
+                if (!sink(buffer.data(), ref.size))
+                    return false;
+            }
+            return true;
+        }
+
+        std::ifstream in(artifact, std::ios::binary);
+        if (!in.is_open())
+        {
+            error = "无法打开 " + entry.path;
+            return false;
+        }
+        while (in)
+        {
+            in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            const auto n = static_cast<std::size_t>(in.gcount());
+            if (n > 0 && !sink(buffer.data(), n))
+                return false;
+        }
+        if (in.bad())
+        {
+            error = "读取 " + entry.path + " 失败";
+            return false;
+        }
+        return true;
+    }
+
+    // 解码并比对大小与 CRC；out 非空时同时写出
+    bool checkEntry(const SlotManifest &manifest, const fs::path &dir, const fs::path &storeDir,
+                    const SlotManifest::Entry &entry, std::ofstream *out, std::string &error)
+    {
+        uLong crc = crc32(0, nullptr, 0);
+        std::uint64_t size = 0;
+        auto sink = [&](const char *data, std::size_t n)
+        {
+            crc = crc32(crc, reinterpret_cast<const Bytef *>(data), static_cast<uInt>(n));
+            size += n;
+            if (out && !out->write(data, static_cast<std::streamsize>(n)))
+            {
+                error = "写入失败";
+                return false;
+            }
+            return true;
+        };
+
+        if (!decodeEntry(manifest.mode, dir, storeDir, entry, sink, error))
+            return false;
+        if (size != entry.size || static_cast<std::uint32_t>(crc) != entry.crc)
+        {
+            error = entry.path + " 校验和不符";
+            return false;
+        }
+        return true;
+    }
+
+    BackupManager::SlotStatus verifySlot(const BackupJob::Options &options, int slot)
+    {
+        BackupManager::SlotStatus status;
+        status.slot = slot;
+        const fs::path dir = slotDir(options, slot);
+        if (!BackupManager::readManifest(BackupManager::manifestPath(dir, options.source), status.manifest))
+        {
+            status.error = "无清单";
+            return status;
+        }
+        status.hasManifest = true;
+
+        const fs::path storeDir = options.destination / "chunks";
+        for (const auto &entry : status.manifest.files)
+            if (!checkEntry(status.manifest, dir, storeDir, entry, nullptr, status.error))
+                return status;
+        status.valid = true;
+        return status;
+    }
+}
+
+fs::path BackupManager::manifestPath(const fs::path &slotDir, const fs::path &source)
+{
+    return slotDir / (source.filename().string() + ".slot.json");
+}
+
+bool BackupManager::writeManifest(const fs::path &path, const SlotManifest &manifest)
+{
+    json files = json::array();
+    for (const auto &entry : manifest.files)
+    {
+        json file = {{"path", entry.path}, {"size", entry.size}, {"crc32", entry.crc}};
+        if (entry.mtime != 0)
+            file["mtime"] = entry.mtime;
+        files.push_back(std::move(file));
+    }
+
+    json body = {
+        {"job", manifest.job},
+        {"mode", manifest.mode},
+        {"slot", manifest.slot},
+        {"saved_at", manifest.savedAt},
+        {"source_size", manifest.sourceSize},
+        {"source_mtime", manifest.sourceMtime},
+        {"seconds", manifest.seconds},
+        {"bytes_written", manifest.bytesWritten},
+        {"files", std::move(files)}};
+
+    fs::path tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        out << body.dump(2);
+        if (!out)
+            return false;
+    }
+    std::string error;
+    return FileCopier::commit(tmp, path, error);
+}
+
+bool BackupManager::readManifest(const fs::path &path, SlotManifest &manifest)
+{
+    std::ifstream in(path);
+    if (!in.is_open())
+        return false;
+    try
+    {
+        json body;
+        in >> body;
+        manifest = SlotManifest{};
+        manifest.job = body.value("job", std::string());
+        manifest.mode = body.at("mode").get<std::string>();
+        manifest.slot = body.value("slot", 0);
+        manifest.savedAt = body.value("saved_at", std::int64_t{0});
+        manifest.sourceSize = body.value("source_size", std::uint64_t{0});
+        manifest.sourceMtime = body.value("source_mtime", std::int64_t{0});
+        manifest.seconds = body.value("seconds", 0.0);
+        manifest.bytesWritten = body.value("bytes_written", std::uint64_t{0});
+        for (const auto &entry : body.at("files"))
+            manifest.files.push_back(SlotManifest::Entry{entry.at("path").get<std::string>(),
+                                                         entry.at("size").get<std::uint64_t>(),
+                                                         entry.at("crc32").get<std::uint32_t>(),
+                                                         entry.value("mtime", std::int64_t{0})});
+        return true;
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+}
+
+bool BackupManager::crc32File(const fs::path &file, unsigned threads, std::uint32_t &crc, std::uint64_t &size,
+                              IoThrottle *throttle)
+{
+    std::error_code ec;
+    size = fs::file_size(file, ec);
+    if (ec)
+        return false;
+
+    // 小文件或单线程：流式计算
+    if (threads == 1 || size < 2 * CrcBlockSize)
+    {
+        std::ifstream in(file, std::ios::binary);
+        if (!in.is_open())
+            return false;
+        const bool limited = throttle && throttle->limited();
+        std::vector<char> buffer(limited ? throttle->chunkSize() : ReadBufferSize);
+        uLong value = crc32(0, nullptr, 0);
+        while (in)
+        {
+            if (throttle && !throttle->acquire(buffer.size()))
+                return false;
+            in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            value = crc32(value, reinterpret_cast<const Bytef *>(buffer.data()), static_cast<uInt>(in.gcount()));
+        }
+        crc = static_cast<std::uint32_t>(value);
+        return !in.bad();
+    }
+
+    // 各块独立计算，按顺序用 crc32_combine 合并，结果与整体流式计算一致
+    ThreadPool pool(threads);
+    std::vector<std::future<std::pair<bool, uLong>>> blocks;
+    for (std::uint64_t offset = 0; offset < size; offset += CrcBlockSize)
+    {
+        const std::uint64_t length = std::min(CrcBlockSize, size - offset);
+        blocks.push_back(pool.submit([&file, offset, length, throttle]
+                                     {
+                                         if (throttle && !throttle->acquire(static_cast<std::size_t>(length)))
+                                             return std::make_pair(false, uLong{0});
+                                         std::ifstream in(file, std::ios::binary);
+                                         std::vector<char> buffer(static_cast<std::size_t>(length));
+                                         in.seekg(static_cast<std::streamoff>(offset));
+                                         if (!in.read(buffer.data(), static_cast<std::streamsize>(length)))
+                                             return std::make_pair(false, uLong{0});
+                                         return std::make_pair(true, crc32(0, reinterpret_cast<const Bytef *>(buffer.data()),
+                                                                           static_cast<uInt>(length))); }));
+    }
+
+    uLong value = crc32(0, nullptr, 0);
+    bool ok = true;
+    for (std::size_t i = 0; i < blocks.size(); ++i)
+    {
+        auto [blockOk, blockCrc] = blocks[i].get();
+        const std::uint64_t length = std::min(CrcBlockSize, size - i * CrcBlockSize);
+        ok = ok && blockOk;
+        value = crc32_combine(value, blockCrc, static_cast<z_off_t>(length));
+    }
+    crc = static_cast<std::uint32_t>(value);
+    return ok;
+}
+
+std::vector<BackupManager::SlotStatus> BackupManager::verifyAll(const BackupJob::Options &options)
+{
+    const int slots = std::max(options.slotCount, 1);
+    ThreadPool pool(std::min<unsigned>(static_cast<unsigned>(slots),
+                                       std::max(1u, std::thread::hardware_concurrency())));
+
+    std::vector<std::future<SlotStatus>> futures;
+    for (int slot = 0; slot < slots; ++slot)
+        futures.push_back(pool.submit([&options, slot]
+                                      { return verifySlot(options, slot); }));
+
+    std::vector<SlotStatus> result;
+    for (auto &future : futures)
+        result.push_back(future.get());
+    return result;
+}
+
+int BackupManager::newestValid(const std::vector<SlotStatus> &slots)
+{
+    int best = -1;
+    std::int64_t bestTime = 0;
+    for (const auto &status : slots)
+        if (status.valid && (best < 0 || status.manifest.savedAt > bestTime))
+        {
+            best = status.slot;
+            bestTime = status.manifest.savedAt;
+        }
+    return best;
+}
+
+bool BackupManager::restore(const BackupJob::Options &options, int slot, std::string &error)
+{
+    const fs::path dir = slotDir(options, slot);
+    const fs::path storeDir = options.destination / "chunks";
+    SlotManifest manifest;
+    if (!readManifest(manifestPath(dir, options.source), manifest))
+    {
+        error = "槽位 #" + std::to_string(slot) + " 没有可用的清单";
+        return false;
+    }
+
+    fs::path tmp = options.source;
+    tmp += ".restore";
+    std::error_code ec;
+
+    if (manifest.mode == "directory")
+    {
+        // 产物路径形如 <目录名>/<相对路径>，去掉第一级后写入临时目录
+        fs::remove_all(tmp, ec);
+        for (const auto &entry : manifest.files)
+        {
+            fs::path relative = fs::path(entry.path).lexically_relative(options.source.filename());
+            fs::path target = tmp / relative;
+            fs::create_directories(target.parent_path(), ec);
+            std::ofstream out(target, std::ios::binary | std::ios::trunc);
+            if (!out.is_open() || !checkEntry(manifest, dir, storeDir, entry, &out, error))
+            {
+                if (error.empty())
+                    error = "无法写入 " + target.string();
+                out.close();
+                fs::remove_all(tmp, ec);
+                return false;
+            }
+        }
+
+        // 目录不能原子覆盖非空目录：旧目录先移开，新目录换入后再删除；换入失败时把旧目录移回
+        fs::path old = options.source;
+        old += ".old";
+        fs::remove_all(old, ec);
+        bool moved = false;
+        if (fs::exists(options.source, ec))
+        {
+            fs::rename(options.source, old, ec);
+            if (ec)
+            {
+                error = "无法移开原目录: " + ec.message();
+                fs::remove_all(tmp, ec);
+                return false;
+            }
+            moved = true;
+        }
+        fs::rename(tmp, options.source, ec);
+        if (ec)
+        {
+            error = "无法换入恢复的目录: " + ec.message();
+            if (moved)
+            {
+                fs::rename(old, options.source, ec);
+                if (ec)
+                    error += "；原目录未能移回，保留在 " + old.string();
+            }
+            fs::remove_all(tmp, ec);
+            return false;
+        }
+        fs::remove_all(old, ec);
+        return true;
+    }
+
+    if (manifest.files.size() != 1)
+    {
+        error = "清单内容不完整";
+        return false;
+    }
+    if (manifest.mode == "sqlite" && fs::exists(options.source, ec) && sqliteInUse(options.source))
+    {
+        error = "数据库正被其他程序使用，请先停止 DanhengServer";
+        return false;
+    }
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out.is_open() || !checkEntry(manifest, dir, storeDir, manifest.files.front(), &out, error))
+        {
+            if (error.empty())
+                error = "无法写入 " + tmp.string();
+            out.close();
+            fs::remove(tmp, ec);
+            return false;
+        }
+    }
+
+    if (!FileCopier::commit(tmp, options.source, error))
+    {
+        fs::remove(tmp, ec);
+        return false;
+    }
+
+    // 旧的 -wal/-shm 与恢复后的数据库不匹配，必须一起删除；替换成功之后才删，失败时源仍完整
+    if (manifest.mode == "sqlite")
+        for (const char *suffix : {"-wal", "-shm"})
+        {
+            fs::path side = options.source;
+            side += suffix;
+            fs::remove(side, ec);
+            if (ec)
+            {
+                error = "数据库已恢复，但无法删除旧的 " + side.filename().string() + "（" + ec.message() +
+                        "），启动 DanhengServer 前请手动删除";
+                return false;
+            }
+        }
+    return true;
+}
@@ -0,0 +1,327 @@
+#include "ChunkStore.hpp"
+#include "FileCopier.hpp"
+#include "IoThrottle.hpp"
+#include <openssl/evp.h>
+#include <nlohmann/json.hpp>
+#include <zlib.h>
+#include <array>
+#include <fstream>
+#include <memory>
+#include <unordered_set>
+
+using json = nlohmann::json;
+
+namespace
+{
+    // 分块参数：最小 16 KiB，平均约 64 KiB，最大 256 KiB
+    constexpr std::size_t MinChunk = 16 * 1024;
+    constexpr std::size_t AvgChunk = 64 * 1024;
+    constexpr std::size_t MaxChunk = 256 * 1024;
+
+    // 归一化分块：未到平均长度时用更严格的掩码，超过后放宽，使块长集中在平均值附近
+    constexpr std::uint64_t MaskSmall = (1ull << 18) - 1;
+    constexpr std::uint64_t MaskLarge = (1ull << 14) - 1;
+
+    constexpr std::size_t ReadBufferSize = 1024 * 1024;
+
+    // Gear 表：固定种子的 splitmix64 序列，保证不同版本之间分块结果一致
+    const std::array<std::uint64_t, 256> &gearTable()
+    {
+        static const std::array<std::uint64_t, 256> table = []
+        {
+            std::array<std::uint64_t, 256> t{};
+            std::uint64_t x = 0x44616e68656e6721ull;
+            for (auto &v : t)
+            {
+                x += 0x9E3779B97F4A7C15ull;
+                std::uint64_t z = x;
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                v = z ^ (z >> 31);
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    struct DigestDeleter
+    {
+        void operator()(EVP_MD_CTX *ctx) const { EVP_MD_CTX_free(ctx); }
+    };
+    using DigestPtr = std::unique_ptr<EVP_MD_CTX, DigestDeleter>;
+
+    DigestPtr newSha256()
+    {
+        DigestPtr ctx(EVP_MD_CTX_new());
+        if (ctx)
+            EVP_DigestInit_ex(ctx.get(), EVP_sha256(), nullptr);
+        return ctx;
+    }
+
+    std::string finishHex(EVP_MD_CTX *ctx)
+    {
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int length = 0;
+        EVP_DigestFinal_ex(ctx, digest, &length);
+
+        static const char *hex = "0123456789abcdef";
+        std::string out;
+        out.reserve(length * 2);
+        for (unsigned int i = 0; i < length; ++i)
+        {
+            out.push_back(hex[digest[i] >> 4]);
+            out.push_back(hex[digest[i] & 0xF]);
+        }
+        return out;
+    }
+
+    std::string sha256Hex(const char *data, std::size_t size)
+    {
+        DigestPtr ctx = newSha256();
+        EVP_DigestUpdate(ctx.get(), data, size);
+        return finishHex(ctx.get());
+    }
+}
+
+ChunkStore::Sha256::Sha256() : ctx(newSha256().release())
+{
+}
+
+ChunkStore::Sha256::~Sha256()
+{
+    EVP_MD_CTX_free(ctx);
+}
+
+void ChunkStore::Sha256::update(const void *data, std::size_t size)
+{
+    EVP_DigestUpdate(ctx, data, size);
+}
+
+std::string ChunkStore::Sha256::hex()
+{
+    return finishHex(ctx);
+}
+
+fs::path ChunkStore::chunkPath(const fs::path &storeDir, const std::string &hash)
+{
+    // 按前两位分子目录，避免单个目录下文件过多
+    return storeDir / hash.substr(0, 2) / hash;
+}
+
+bool ChunkStore::storeFile(const fs::path &source, const fs::path &storeDir, Result &out,
+                           IoThrottle *throttle)
+{
+    std::ifstream in(source, std::ios::binary);
+    if (!in.is_open())
+        return false;
+
+    out = Result{};
+    const auto &gear = gearTable();
+    DigestPtr fileDigest = newSha256();
+
+    std::vector<char> readBuffer(ReadBufferSize);
+    std::vector<char> chunk;
+    chunk.reserve(MaxChunk);
+    std::uint64_t rolling = 0;
+
+    auto emit = [&]() -> bool
+    {
+        std::string hash = sha256Hex(chunk.data(), chunk.size());
+        fs::path path = chunkPath(storeDir, hash);
+
+        std::error_code ec;
+        if (!fs::exists(path, ec))
+        {
+            fs::create_directories(path.parent_path());
+            fs::path tmp = path;
+            tmp += ".tmp";
+            {
+                std::ofstream chunkOut(tmp, std::ios::binary | std::ios::trunc);
+                chunkOut.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                if (!chunkOut)
+                    return false;
+            }
+            // 一个块被多个槽位共享：必须落盘后再改名，否则崩溃后留下的空块会同时损坏所有引用它的槽位
+            std::string error;
+            if (!FileCopier::commit(tmp, path, error))
+            {
+                fs::remove(tmp, ec);
+                return false;
+            }
+            ++out.newChunks;
+            out.newBytes += chunk.size();
+        }
+
+        out.chunks.push_back(ChunkRef{std::move(hash), static_cast<std::uint32_t>(chunk.size())});
+        chunk.clear();
+        rolling = 0;
+        return true;
+    };
+
+    while (in)
+    {
+        if (throttle && !throttle->acquire(readBuffer.size()))
+            return false;
+        in.read(readBuffer.data(), static_cast<std::streamsize>(readBuffer.size()));
+        const auto n = static_cast<std::size_t>(in.gcount());
+        if (n == 0)
+            break;
+        EVP_DigestUpdate(fileDigest.get(), readBuffer.data(), n);
+        out.fileCrc = static_cast<std::uint32_t>(crc32(out.fileCrc, reinterpret_cast<const Bytef *>(readBuffer.data()), static_cast<uInt>(n)));
+        out.fileSize += n;
+
+        const auto *bytes = reinterpret_cast<const unsigned char *>(readBuffer.data());
+        std::size_t pos = 0;
+        while (pos < n)
+        {
+            std::size_t i = pos;
+            std::size_t length = chunk.size();
+            bool boundary = false;
+
+            // 不足最小块长的部分直接跳过，不参与滚动哈希
+            if (length < MinChunk)
+            {
+                std::size_t skip = std::min(MinChunk - length, n - i);
+                i += skip;
+                length += skip;
+            }
+
+            while (i < n && !boundary)
+            {
+                rolling = (rolling << 1) + gear[bytes[i]];
+                ++i;
+                ++length;
+                const std::uint64_t mask = length < AvgChunk ? MaskSmall : MaskLarge;
+                boundary = (rolling & mask) == 0 || length >= MaxChunk;
+            }
+
+            chunk.insert(chunk.end(), readBuffer.data() + pos, readBuffer.data() + i);
+            pos = i;
+            if (boundary && !emit())
+                return false;
+        }
+    }
+
+    if (in.bad())
+        return false;
+    if (!chunk.empty() && !emit())
+        return false;
+
+    out.fileHash = finishHex(fileDigest.get());
+    return true;
+}
+
+bool ChunkStore::materialize(const std::vector<ChunkRef> &chunks, const fs::path &storeDir, const fs::path &target)
+{
+    std::ofstream out(target, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+        return false;
+
+    std::vector<char> data;
+    for (const auto &ref : chunks)
+    {
+        std::ifstream in(chunkPath(storeDir, ref.hash), std::ios::binary);
+        data.resize(ref.size);
+        if (!in.read(data.data(), ref.size))
+            return false;
+        out.write(data.data(), ref.size);
+    }
+    return static_cast<bool>(out);
+}
+
+bool ChunkStore::collectGarbage(const fs::path &storeDir, const std::vector<fs::path> &manifests,
+                                std::size_t &removed, std::string &error)
+{
+    removed = 0;
+    std::unordered_set<std::string> live;
+    for (const auto &manifest : manifests)
+    {
+        std::vector<ChunkRef> chunks;
+        if (!readManifest(manifest, chunks))
+        {
+            error = "清单无法解析: " + manifest.string();
+            return false;
+        }
+        for (auto &ref : chunks)
+            live.insert(std::move(ref.hash));
+    }
+
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(storeDir, ec), end; it != end; it.increment(ec))
+    {
+        if (!it->is_regular_file(ec))
+            continue;
+        if (!live.count(it->path().filename().string()) && fs::remove(it->path(), ec))
+            ++removed;
+    }
+    return true;
+}
+
+bool ChunkStore::writeManifest(const fs::path &manifest, const Result &result, std::int64_t sourceMtime)
+{
+    json chunks = json::array();
+    for (const auto &ref : result.chunks)
+        chunks.push_back({ref.hash, ref.size});
+
+    json body = {
+        {"size", result.fileSize},
+        {"mtime", sourceMtime},
+        {"hash", result.fileHash},
+        {"chunks", std::move(chunks)}};
+
+    fs::path tmp = manifest;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        out << body.dump();
+        if (!out)
+            return false;
+    }
+    std::string error;
+    if (FileCopier::commit(tmp, manifest, error))
+        return true;
+    std::error_code ec;
+    fs::remove(tmp, ec);
+    return false;
+}
+
+bool ChunkStore::readManifest(const fs::path &manifest, std::vector<ChunkRef> &chunks)
+{
+    std::ifstream in(manifest);
+    if (!in.is_open())
+        return false;
+    try
+    {
+        json body;
+        in >> body;
+        chunks.clear();
+        for (const auto &entry : body.at("chunks"))
+            chunks.push_back(ChunkRef{entry.at(0).get<std::string>(), entry.at(1).get<std::uint32_t>()});
+        return true;
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+}
+
+std::string ChunkStore::hashFile(const fs::path &file, IoThrottle *throttle)
+{
+    std::ifstream in(file, std::ios::binary);
+    if (!in.is_open())
+        return {};
+
+    Sha256 digest;
+    std::vector<char> buffer(ReadBufferSize);
+    while (in)
+    {
+        if (throttle && !throttle->acquire(buffer.size()))
+            return {};
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (in.gcount() > 0)
+            digest.update(buffer.data(), static_cast<std::size_t>(in.gcount()));
+    }
+    if (in.bad())
+        return {};
+    return digest.hex();
+}
@@ -0,0 +1,233 @@
+#include "CommandHistory.hpp"
+#include "ConsoleOutputManager.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+std::mutex CommandHistory::historyMutex;
+fs::path CommandHistory::filePath;
+MappedFile CommandHistory::mapped;
+bool CommandHistory::needsNewline = false;
+std::vector<std::string_view> CommandHistory::entries;
+std::deque<std::string> CommandHistory::added;
+std::size_t CommandHistory::processed = 0;
+std::vector<CommandHistory::Distinct> CommandHistory::distinct;
+std::unordered_map<std::string_view, std::uint32_t> CommandHistory::distinctIds;
+std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> CommandHistory::postings;
+std::thread CommandHistory::indexThread;
+bool CommandHistory::stopping = false;
+
+CommandHistory::Finalizer CommandHistory::finalizer;
+
+namespace
+{
+    // 后台线程每次持锁处理的条数；搜索与追加最多等这么一批
+    constexpr std::size_t IndexBatch = 4096;
+
+    std::uint32_t trigramAt(std::string_view text, std::size_t i)
+    {
+        return static_cast<std::uint32_t>(static_cast<unsigned char>(text[i])) << 16 |
+               static_cast<std::uint32_t>(static_cast<unsigned char>(text[i + 1])) << 8 |
+               static_cast<std::uint32_t>(static_cast<unsigned char>(text[i + 2]));
+    }
+}
+
+bool CommandHistory::open(const fs::path &path)
+{
+    close();
+
+    std::lock_guard<std::mutex> lock(historyMutex);
+    filePath = path;
+
+    std::error_code ec;
+    if (!fs::exists(path, ec) || fs::file_size(path, ec) == 0)
+        return true; // 还没有历史
+    if (!mapped.open(path))
+        return false;
+
+    // 只找换行符，不复制内容；兼容 CRLF，空行跳过
+    const char *data = mapped.data();
+    const std::size_t size = mapped.size();
+    std::size_t begin = 0;
+    while (begin < size)
+    {
+        const void *found = std::memchr(data + begin, '\n', size - begin);
+        const std::size_t end = found ? static_cast<const char *>(found) - data : size;
+        std::size_t length = end - begin;
+        if (length > 0 && data[begin + length - 1] == '\r')
+            --length;
+        if (length > 0)
+            entries.emplace_back(data + begin, length);
+        begin = end + 1;
+    }
+    needsNewline = data[size - 1] != '\n';
+
+    stopping = false;
+    indexThread = std::thread(indexLoop);
+    return true;
+}
+
+void CommandHistory::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(historyMutex);
+        stopping = true;
+    }
+    if (indexThread.joinable())
+        indexThread.join();
+
+    std::lock_guard<std::mutex> lock(historyMutex);
+    postings.clear();
+    distinctIds.clear();
+    distinct.clear();
+    entries.clear();
+    added.clear();
+    processed = 0;
+    needsNewline = false;
+    mapped.close();
+    filePath.clear();
+    stopping = false;
+}
+
+void CommandHistory::indexLoop()
+{
+    while (true)
+    {
+        std::lock_guard<std::mutex> lock(historyMutex);
+        if (stopping || processed == entries.size())
+            return; // 之后新增的命令由 add() 直接并入
+        process(std::min(IndexBatch, entries.size() - processed));
+    }
+}
+
+void CommandHistory::process(std::size_t count)
+{
+    const std::size_t end = processed + count;
+    for (std::size_t i = processed; i < end; ++i)
+    {
+        const auto entry = static_cast<std::uint32_t>(i);
+        auto [it, inserted] = distinctIds.try_emplace(entries[i], static_cast<std::uint32_t>(distinct.size()));
+        if (inserted)
+        {
+            distinct.push_back({entries[i], entry});
+            indexText(it->second);
+        }
+        else
+            distinct[it->second].lastEntry = entry;
+    }
+    processed = end;
+}
+
+void CommandHistory::indexText(std::uint32_t id)
+{
+    const std::string_view text = distinct[id].text;
+    for (std::size_t i = 0; i + 3 <= text.size(); ++i)
+    {
+        auto &list = postings[trigramAt(text, i)];
+        if (list.empty() || list.back() != id) // 同一命令里重复的三元组只记一次
+            list.push_back(id);
+    }
+}
+
+bool CommandHistory::matches(std::string_view text, const std::string &query)
+{
+    return text.find(query) != std::string_view::npos;
+}
+
+void CommandHistory::add(const std::string &line)
+{
+    if (line.empty() || line.find('\n') != std::string::npos)
+        return;
+
+    std::lock_guard<std::mutex> lock(historyMutex);
+    if (!entries.empty() && entries.back() == line)
+        return;
+    added.push_back(line);
+    entries.emplace_back(added.back());
+    if (processed + 1 == entries.size())
+        process(1);
+
+    if (filePath.empty())
+        return;
+    std::ofstream out(filePath, std::ios::binary | std::ios::app);
+    if (needsNewline)
+        out << '\n';
+    out << line << '\n';
+    out.flush();
+    needsNewline = false;
+
+    static bool warned = false;
+    if (!out && !warned)
+    {
+        warned = true;
+        buffer("命令历史写入失败：" + filePath.string(), MessageType::Warning);
+    }
+}
+
+std::size_t CommandHistory::size()
+{
+    std::lock_guard<std::mutex> lock(historyMutex);
+    return entries.size();
+}
+
+std::string CommandHistory::at(std::size_t index)
+{
+    std::lock_guard<std::mutex> lock(historyMutex);
+    return index < entries.size() ? std::string(entries[index]) : std::string();
+}
+
+bool CommandHistory::indexed()
+{
+    std::lock_guard<std::mutex> lock(historyMutex);
+    return processed == entries.size();
+}
+
+long long CommandHistory::search(const std::string &query, std::size_t before)
+{
+    std::lock_guard<std::mutex> lock(historyMutex);
+    before = std::min(before, entries.size());
+
+    // 尚未并入索引的部分都比已索引的新，先从新到旧逐条比对
+    for (std::size_t i = before; i > processed; --i)
+        if (matches(entries[i - 1], query))
+            return static_cast<long long>(i - 1);
+
+    // 已索引部分：取 query 中最稀有的三元组的候选命令，再逐个核对
+    const std::vector<std::uint32_t> *candidates = nullptr;
+    if (query.size() >= 3)
+    {
+        for (std::size_t i = 0; i + 3 <= query.size(); ++i)
+        {
+            auto found = postings.find(trigramAt(query, i));
+            if (found == postings.end())
+                return -1; // 有三元组从未出现过，不可能匹配
+            if (!candidates || found->second.size() < candidates->size())
+                candidates = &found->second;
+        }
+    }
+
+    long long best = -1;
+    auto consider = [&](std::uint32_t id)
+    {
+        const Distinct &d = distinct[id];
+        if (d.lastEntry < before && static_cast<long long>(d.lastEntry) > best && matches(d.text, query))
+            best = d.lastEntry;
+    };
+    if (candidates)
+        for (std::uint32_t id : *candidates)
+            consider(id);
+    else
+        for (std::uint32_t id = 0; id < distinct.size(); ++id)
+            consider(id); // 少于三个字节的查询没有三元组可用
+    return best;
+}
+
+CommandHistory::Finalizer::~Finalizer()
+{
+    {
+        std::lock_guard<std::mutex> lock(historyMutex);
+        stopping = true;
+    }
+    if (indexThread.joinable())
+        indexThread.join();
+}
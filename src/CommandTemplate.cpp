@@ -0,0 +1,283 @@
+#include "CommandTemplate.hpp"
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    bool isNameChar(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    bool parseInteger(std::string_view text, std::int64_t &value)
+    {
+        if (!text.empty() && text.front() == '+')
+            text.remove_prefix(1);
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size() && !text.empty();
+    }
+
+    // 按 RFC 4180 拆分一行 CSV：双引号包裹的字段可含逗号，"" 表示一个双引号
+    std::vector<std::string> splitCsvLine(const std::string &line)
+    {
+        std::vector<std::string> fields(1);
+        bool quoted = false;
+        for (std::size_t i = 0; i < line.size(); ++i)
+        {
+            const char c = line[i];
+            if (quoted)
+            {
+                if (c == '"' && i + 1 < line.size() && line[i + 1] == '"')
+                {
+                    fields.back() += '"';
+                    ++i;
+                }
+                else if (c == '"')
+                    quoted = false;
+                else
+                    fields.back() += c;
+            }
+            else if (c == '"')
+                quoted = true;
+            else if (c == ',')
+                fields.emplace_back();
+            else if (c != '\r')
+                fields.back() += c;
+        }
+        return fields;
+    }
+}
+
+CommandTemplate::CommandTemplate(const std::string &text)
+    : source(text)
+{
+    auto addLiteral = [this](std::string_view piece)
+    {
+        if (piece.empty())
+            return;
+        // 相邻字面量（如转义的花括号前后）合并为一段
+        if (!segments.empty() && segments.back().variable < 0 &&
+            segments.back().offset + segments.back().length == literals.size())
+            segments.back().length += static_cast<std::uint32_t>(piece.size());
+        else
+            segments.push_back(Segment{static_cast<std::uint32_t>(literals.size()),
+                                       static_cast<std::uint32_t>(piece.size()), -1});
+        literals.append(piece);
+    };
+
+    std::size_t i = 0;
+    while (i < text.size())
+    {
+        const std::size_t brace = text.find_first_of("{}", i);
+        if (brace == std::string::npos)
+        {
+            addLiteral(std::string_view(text).substr(i));
+            break;
+        }
+        addLiteral(std::string_view(text).substr(i, brace - i));
+
+        const char c = text[brace];
+        if (brace + 1 < text.size() && text[brace + 1] == c)
+        {
+            addLiteral(std::string_view(text).substr(brace, 1)); // {{ 或 }}
+            i = brace + 2;
+            continue;
+        }
+        if (c == '}')
+            throw std::invalid_argument("模板第 " + std::to_string(brace + 1) + " 个字符处有多余的 }（字面的 } 请写作 }}）");
+
+        const std::size_t close = text.find('}', brace + 1);
+        if (close == std::string::npos)
+            throw std::invalid_argument("模板中的 { 没有闭合");
+        const std::string name = text.substr(brace + 1, close - brace - 1);
+        if (name.empty() || !std::all_of(name.begin(), name.end(), isNameChar))
+            throw std::invalid_argument("无效的变量名: {" + name + "}");
+
+        auto found = std::find(names.begin(), names.end(), name);
+        const int index = static_cast<int>(found - names.begin());
+        if (found == names.end())
+            names.push_back(name);
+        segments.push_back(Segment{0, 0, index});
+        i = close + 1;
+    }
+}
+
+void CommandTemplate::expand(const std::string_view *values, std::string &out) const
+{
+    out.clear();
+    for (const auto &segment : segments)
+    {
+        if (segment.variable < 0)
+            out.append(literals, segment.offset, segment.length);
+        else
+            out.append(values[segment.variable]);
+    }
+}
+
+std::string CommandTemplate::expand(std::initializer_list<std::string_view> values) const
+{
+    if (values.size() < names.size())
+        throw std::invalid_argument("模板需要 " + std::to_string(names.size()) + " 个变量值");
+    std::string out;
+    out.reserve(literals.size() + 16 * names.size());
+    expand(values.begin(), out);
+    return out;
+}
+
+std::string_view TemplateBindings::Column::at(std::size_t row, std::array<char, 24> &scratch) const
+{
+    if (!range)
+        return values[values.size() == 1 ? 0 : row];
+    const std::int64_t value = start + step * static_cast<std::int64_t>(count == 1 ? 0 : row);
+    auto result = std::to_chars(scratch.data(), scratch.data() + scratch.size(), value);
+    return std::string_view(scratch.data(), static_cast<std::size_t>(result.ptr - scratch.data()));
+}
+
+TemplateBindings::Column TemplateBindings::parseValue(const std::string &name, const std::string &text)
+{
+    Column column;
+    const std::size_t dots = text.find("..");
+    if (dots != std::string::npos)
+    {
+        // 范围：a..b 或 a..b:step
+        const std::size_t colon = text.find(':', dots + 2);
+        std::int64_t first = 0, last = 0, step = 1;
+        const bool ok = parseInteger(std::string_view(text).substr(0, dots), first) &&
+                        parseInteger(std::string_view(text).substr(dots + 2, colon == std::string::npos ? std::string::npos : colon - dots - 2), last) &&
+                        (colon == std::string::npos || parseInteger(std::string_view(text).substr(colon + 1), step));
+        if (!ok || step <= 0)
+            throw std::invalid_argument("无效的范围 " + name + "=" + text + "（应为 起..止 或 起..止:步长）");
+
+        const std::uint64_t span = first <= last ? static_cast<std::uint64_t>(last - first)
+                                                 : static_cast<std::uint64_t>(first - last);
+        if (span / static_cast<std::uint64_t>(step) >= MaxCommands)
+            throw std::invalid_argument("范围 " + name + "=" + text + " 超过 " + std::to_string(MaxCommands) + " 个值");
+        column.range = true;
+        column.start = first;
+        column.step = first <= last ? step : -step;
+        column.count = static_cast<std::size_t>(span / static_cast<std::uint64_t>(step)) + 1;
+        return column;
+    }
+
+    std::stringstream items(text);
+    std::string item;
+    while (std::getline(items, item, ','))
+        column.values.push_back(item);
+    if (column.values.empty())
+        column.values.emplace_back();
+    return column;
+}
+
+void TemplateBindings::readCsv(const std::string &path, const CommandTemplate &tpl, std::vector<Column> &columns,
+                               std::vector<bool> &bound)
+{
+    std::ifstream in(path);
+    if (!in.is_open())
+        throw std::invalid_argument("无法打开 CSV 文件: " + path);
+
+    std::string line;
+    if (!std::getline(in, line))
+        throw std::invalid_argument("CSV 文件为空: " + path);
+    if (line.size() >= 3 && line.compare(0, 3, "\xEF\xBB\xBF") == 0)
+        line.erase(0, 3); // UTF-8 BOM
+
+    // 列名 → 变量下标；模板没用到的列忽略
+    const auto &names = tpl.variables();
+    std::vector<int> target;
+    for (const auto &header : splitCsvLine(line))
+    {
+        auto found = std::find(names.begin(), names.end(), header);
+        const int index = found == names.end() ? -1 : static_cast<int>(found - names.begin());
+        target.push_back(index);
+        if (index >= 0)
+        {
+            columns[index] = Column{};
+            bound[index] = true;
+        }
+    }
+
+    std::size_t lineNumber = 1;
+    while (std::getline(in, line))
+    {
+        ++lineNumber;
+        if (line.empty() || line == "\r")
+            continue;
+        auto fields = splitCsvLine(line);
+        if (fields.size() != target.size())
+            throw std::invalid_argument(path + " 第 " + std::to_string(lineNumber) + " 行的列数与表头不一致");
+        for (std::size_t i = 0; i < fields.size(); ++i)
+            if (target[i] >= 0)
+                columns[target[i]].values.push_back(std::move(fields[i]));
+        if (lineNumber > MaxCommands + 1)
+            throw std::invalid_argument(path + " 超过 " + std::to_string(MaxCommands) + " 行");
+    }
+}
+
+TemplateBindings TemplateBindings::parse(const std::string &spec, const CommandTemplate &tpl)
+{
+    const auto &names = tpl.variables();
+    TemplateBindings bindings;
+    bindings.columns.resize(names.size());
+    std::vector<bool> bound(names.size(), false);
+
+    std::stringstream tokens(spec);
+    std::string token;
+    while (tokens >> token)
+    {
+        if (token.front() == '@')
+        {
+            readCsv(token.substr(1), tpl, bindings.columns, bound);
+            continue;
+        }
+        const std::size_t equals = token.find('=');
+        if (equals == std::string::npos || equals == 0)
+            throw std::invalid_argument("无法识别的取值 \"" + token + "\"（应为 变量=值 或 @文件.csv）");
+        const std::string name = token.substr(0, equals);
+        auto found = std::find(names.begin(), names.end(), name);
+        if (found == names.end())
+            throw std::invalid_argument("模板中没有变量 {" + name + "}");
+        const std::size_t index = static_cast<std::size_t>(found - names.begin());
+        bindings.columns[index] = parseValue(name, token.substr(equals + 1));
+        bound[index] = true;
+    }
+
+    // 各列按行对齐：长度为 1 的列广播到每一行，其余列长度必须相同
+    bindings.rows = names.empty() ? 1 : 0;
+    for (std::size_t i = 0; i < names.size(); ++i)
+    {
+        if (!bound[i])
+            throw std::invalid_argument("变量 {" + names[i] + "} 没有取值");
+        const std::size_t size = bindings.columns[i].size();
+        if (size == 0)
+            throw std::invalid_argument("变量 {" + names[i] + "} 的取值为空");
+        if (size == 1)
+            continue;
+        if (bindings.rows > 1 && size != bindings.rows)
+            throw std::invalid_argument("变量 {" + names[i] + "} 有 " + std::to_string(size) + " 个值，与其他变量的 " +
+                                        std::to_string(bindings.rows) + " 个不一致");
+        bindings.rows = size;
+    }
+    if (bindings.rows == 0)
+        bindings.rows = 1; // 全部是单值
+    return bindings;
+}
+
+std::size_t TemplateBindings::forEach(const CommandTemplate &tpl, const std::function<bool(const std::string &)> &fn) const
+{
+    // 缓冲区与数字格式化空间在整个批次中复用
+    std::vector<std::string_view> values(columns.size());
+    std::vector<std::array<char, 24>> scratch(columns.size());
+    std::string command;
+    for (std::size_t row = 0; row < rows; ++row)
+    {
+        for (std::size_t i = 0; i < columns.size(); ++i)
+            values[i] = columns[i].at(row, scratch[i]);
+        tpl.expand(values.data(), command);
+        if (!fn(command))
+            return row;
+    }
+    return rows;
+}
@@ -1,98 +1,366 @@
 #include "ConsoleInputManager.hpp"
 #include "ConsoleOutputManager.hpp"  // 提供 getTyping()
-#include <conio.h>                   // _kbhit(), _getch()
+#include "TerminalBackend.hpp"       // waitInput(), readKey()
+#include "CommandHistory.hpp"
 #include <iostream>
-#include <chrono>
-#include <thread>
 
 // 静态成员变量在 .cpp 中初始化
 std::string ConsoleInputManager::typingShadow;
 std::mutex   ConsoleInputManager::shadowMutex;
+std::string ConsoleInputManager::lineBuffer;
+std::queue<std::string> ConsoleInputManager::lines;
+std::mutex              ConsoleInputManager::linesMutex;
+std::condition_variable ConsoleInputManager::linesNotifier;
+std::atomic<bool>       ConsoleInputManager::capturing{false};
+std::queue<char>        ConsoleInputManager::keys;
+int                     ConsoleInputManager::escapeState = 0;
+std::size_t             ConsoleInputManager::historyPos = std::string::npos;
+std::string             ConsoleInputManager::draftLine;
+bool                    ConsoleInputManager::searching = false;
+std::string             ConsoleInputManager::searchQuery;
+long long               ConsoleInputManager::searchMatch = -1;
+std::string             ConsoleInputManager::searchOrigin;
 
-std::string ConsoleInputManager::read()
+// 输入来自管道或输出被重定向时不回显
+static bool echoEnabled()
 {
-    // 本次调用要返回的完整一行输入
-    std::string line;
+    return TerminalBackend::inputIsTty() && TerminalBackend::outputIsTty();
+}
 
-    // 每次 read 之前，清空旧的 shadow
-    {
-        std::lock_guard<std::mutex> lock(shadowMutex);
-        typingShadow.clear();
-    }
+void ConsoleInputManager::start()
+{
+    static std::once_flag once;
+    std::call_once(once, []
+                   { std::thread(inputLoop).detach(); });
+}
 
-    // 启动输入循环线程，线程跑到敲回车为止
-    std::thread t(&ConsoleInputManager::inputLoop, std::ref(line));
+std::string ConsoleInputManager::read()
+{
+    start();
 
-    // 阻塞等待输入线程结束
-    t.join();
+    // 阻塞等待输入线程交付一整行（输入结束后将一直等待，后台任务照常运行）
+    std::unique_lock<std::mutex> lock(linesMutex);
+    linesNotifier.wait(lock, []
+                       { return !lines.empty(); });
 
-    // 返回本次用户敲入的一行文本
+    std::string line = std::move(lines.front());
+    lines.pop();
     return line;
 }
 
-void ConsoleInputManager::inputLoop(std::string& outLine)
+void ConsoleInputManager::notifyOutputIdle()
+{
+    TerminalBackend::wakeInput();
+}
+
+void ConsoleInputManager::captureKeys(bool enabled)
+{
+    start();
+    std::lock_guard<std::mutex> lock(linesMutex);
+    capturing = enabled;
+    keys = std::queue<char>();
+}
+
+int ConsoleInputManager::nextKey(std::chrono::milliseconds timeout)
 {
-    std::string buffer;                  // 存放本次正在输入的内容
-    bool lastTyping = ConsoleOutputManager::getTyping();
+    std::unique_lock<std::mutex> lock(linesMutex);
+    if (!linesNotifier.wait_for(lock, timeout, []
+                                { return !keys.empty(); }))
+        return -1;
+    char ch = keys.front();
+    keys.pop();
+    return static_cast<unsigned char>(ch);
+}
 
+void ConsoleInputManager::inputLoop()
+{
     while (true)
     {
-        bool currentTyping = ConsoleOutputManager::getTyping();
-
-        // 输出线程从打印状态切换到非打印状态
-        if (lastTyping && !currentTyping)
+        if (TerminalBackend::waitInput() == InputEvent::Wake)
         {
+            if (capturing)
+                continue; // 全屏界面期间不重绘提示符
+            // 输出线程已打印完：恢复行首提示符及打印中敲的内容
+            // 若此时又有新消息开始打印，等它结束后的下一次唤醒再重绘
+            auto outputLock = ConsoleOutputManager::lockOutput();
+            if (!ConsoleOutputManager::isIdle())
+                continue;
             std::lock_guard<std::mutex> lock(shadowMutex);
-            // 恢复行首提示符及打印中敲的内容
-            std::cout << "\n> " << typingShadow;
-            buffer = typingShadow;       // 将 shadow 拷贝到本地 buffer
+            if (searching)
+            {
+                // 搜索中打印期间敲的字符属于搜索词
+                searchQuery += typingShadow;
+                if (!typingShadow.empty())
+                    refreshSearch(false);
+            }
+            else
+                lineBuffer += typingShadow;
             typingShadow.clear();
+            if (echoEnabled())
+                std::cout << "\n" << promptLine() << std::flush;
+            continue;
         }
-        lastTyping = currentTyping;
 
-        // 非阻塞检测键盘
-        if (_kbhit())
+        int key = TerminalBackend::readKey();
+        if (key < 0)
+        {
+            // 输入已结束（例如在 systemd 下 stdin 为 /dev/null）：交出最后一行后退出线程
+            if (!lineBuffer.empty())
+            {
+                std::lock_guard<std::mutex> lock(linesMutex);
+                lines.push(std::move(lineBuffer));
+                linesNotifier.notify_one();
+            }
+            return;
+        }
+
+        handleKey(static_cast<char>(key));
+    }
+}
+
+int ConsoleInputManager::decodeKey(char ch)
+{
+    const auto byte = static_cast<unsigned char>(ch);
+    switch (escapeState)
+    {
+    case 1: // ESC 之后
+        if (byte == '[' || byte == 'O')
         {
-            char ch = _getch();
+            escapeState = 2;
+            return 0;
+        }
+        escapeState = 0;
+        return byte; // 单独的 Esc：忽略，照常处理后面的字符
+    case 2: // CSI 参数，直到结束字节
+        if ((byte >= '0' && byte <= '9') || byte == ';')
+            return 0;
+        escapeState = 0;
+        return byte == 'A' ? KeyUp : byte == 'B' ? KeyDown : 0;
+#ifdef _WIN32
+    case 3: // _getch() 的功能键前缀之后
+        escapeState = 0;
+        return byte == 72 ? KeyUp : byte == 80 ? KeyDown : 0;
+#endif
+    default:
+        break;
+    }
+
+    if (byte == 0x1B)
+    {
+        escapeState = 1;
+        return 0;
+    }
+#ifdef _WIN32
+    if (byte == 0x00 || byte == 0xE0)
+    {
+        escapeState = 3;
+        return 0;
+    }
+#endif
+    return byte;
+}
+
+void ConsoleInputManager::handleKey(char ch)
+{
+    if (capturing)
+    {
+        std::lock_guard<std::mutex> lock(linesMutex);
+        keys.push(ch);
+        linesNotifier.notify_all();
+        return;
+    }
+
+    const int key = decodeKey(ch);
+    if (key == 0)
+        return;
+    const bool special = key == KeyUp || key == KeyDown || key == KeyCtrlR || key == KeyCtrlG;
 
-            if (currentTyping)
+    auto outputLock = ConsoleOutputManager::tryLockOutput();
+    if (!outputLock.owns_lock() || ConsoleOutputManager::getTyping())
+    {
+        // 输出线程正在打印，所有字符先存到 shadow，打印结束后再回显；翻阅与搜索键此时无法显示，直接丢弃
+        if (ch != '\r' && !special)
+        {
+            std::lock_guard<std::mutex> lock(shadowMutex);
+            if (ch == '\b')
             {
-                // 输出线程正在打印，所有字符先存到 shadow
-                if (ch != '\r')
-                {
-                    std::lock_guard<std::mutex> lock(shadowMutex);
-                    typingShadow.push_back(ch);
-                }
+                if (!typingShadow.empty())
+                    typingShadow.pop_back();
             }
             else
             {
-                // 普通输入模式
-                if (ch == '\r')
-                {
-                    // 回车：结束本次输入
-                    std::cout << std::endl;
-                    outLine = buffer;
-                    return;
-                }
-                else if (ch == '\b')
-                {
-                    // 退格：删除 buffer 最后一个字符并回退光标
-                    if (!buffer.empty())
-                    {
-                        buffer.pop_back();
-                        std::cout << "\b \b";
-                    }
-                }
-                else
-                {
-                    // 普通字符：追加并回显
-                    buffer.push_back(ch);
-                    std::cout << ch;
-                }
+                typingShadow.push_back(ch);
             }
         }
+        return;
+    }
 
-        // 降低 CPU 占用率
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    const bool echo = echoEnabled();
+    if (searching)
+    {
+        handleSearchKey(key);
+        return;
+    }
+    if (echo && (key == KeyUp || key == KeyDown))
+    {
+        browseHistory(key);
+        return;
+    }
+    if (echo && key == KeyCtrlR)
+    {
+        searching = true;
+        searchQuery.clear();
+        searchMatch = -1;
+        searchOrigin = lineBuffer;
+        redrawLine();
+        return;
     }
-}
\ No newline at end of file
+    if (special)
+        return;
+
+    if (ch == '\r')
+    {
+        // 回车：结束本次输入，整行交给 read()
+        submitLine(echo);
+    }
+    else if (ch == '\b')
+    {
+        // 退格：删除 buffer 最后一个字符并回退光标
+        if (!lineBuffer.empty())
+        {
+            lineBuffer.pop_back();
+            if (echo)
+                std::cout << "\b \b" << std::flush;
+        }
+    }
+    else
+    {
+        // 普通字符：追加并回显
+        lineBuffer.push_back(ch);
+        if (echo)
+            std::cout << ch << std::flush;
+    }
+}
+
+void ConsoleInputManager::submitLine(bool echo)
+{
+    if (echo)
+    {
+        std::cout << std::endl;
+        if (lineBuffer.size() >= MinHistoryLength)
+            CommandHistory::add(lineBuffer);
+    }
+    historyPos = std::string::npos;
+    draftLine.clear();
+
+    std::lock_guard<std::mutex> lock(linesMutex);
+    lines.push(std::move(lineBuffer));
+    lineBuffer.clear();
+    linesNotifier.notify_one();
+}
+
+void ConsoleInputManager::browseHistory(int key)
+{
+    const std::size_t count = CommandHistory::size();
+    if (key == KeyUp)
+    {
+        if (historyPos == std::string::npos)
+        {
+            draftLine = lineBuffer;
+            historyPos = count;
+        }
+        if (historyPos == 0)
+            return;
+        lineBuffer = CommandHistory::at(--historyPos);
+    }
+    else
+    {
+        if (historyPos == std::string::npos)
+            return;
+        if (++historyPos >= count)
+        {
+            // 翻过最新一条：回到翻阅前正在编辑的内容
+            lineBuffer = draftLine;
+            historyPos = std::string::npos;
+        }
+        else
+            lineBuffer = CommandHistory::at(historyPos);
+    }
+    redrawLine();
+}
+
+void ConsoleInputManager::handleSearchKey(int key)
+{
+    if (key == KeyCtrlR)
+    {
+        // 再按一次：继续往旧找同一搜索词
+        if (searchMatch > 0 && !searchQuery.empty())
+        {
+            const long long older = CommandHistory::search(searchQuery, static_cast<std::size_t>(searchMatch));
+            if (older >= 0)
+                searchMatch = older;
+        }
+        redrawLine();
+        return;
+    }
+    if (key == '\b')
+    {
+        // 按 UTF-8 字符退格
+        while (!searchQuery.empty() && (static_cast<unsigned char>(searchQuery.back()) & 0xC0) == 0x80)
+            searchQuery.pop_back();
+        if (!searchQuery.empty())
+            searchQuery.pop_back();
+        refreshSearch(true);
+        redrawLine();
+        return;
+    }
+    if (key >= 0x20 && key < 0x100 && key != 0x7F)
+    {
+        searchQuery.push_back(static_cast<char>(key));
+        refreshSearch(false);
+        redrawLine();
+        return;
+    }
+
+    // 其余按键结束搜索：Ctrl-G 恢复原内容，其他键采用命中的命令，回车直接提交
+    searching = false;
+    if (key == KeyCtrlG)
+        lineBuffer = searchOrigin;
+    else if (searchMatch >= 0)
+        lineBuffer = CommandHistory::at(static_cast<std::size_t>(searchMatch));
+    historyPos = std::string::npos;
+    redrawLine();
+    if (key == '\r')
+        submitLine(echoEnabled());
+}
+
+void ConsoleInputManager::refreshSearch(bool fromNewest)
+{
+    if (searchQuery.empty())
+    {
+        searchMatch = -1;
+        return;
+    }
+    // 搜索词变长时当前命中可能仍然匹配，从它（含）开始往旧找
+    const std::size_t before = fromNewest || searchMatch < 0 ? CommandHistory::size()
+                                                             : static_cast<std::size_t>(searchMatch) + 1;
+    searchMatch = CommandHistory::search(searchQuery, before);
+}
+
+std::string ConsoleInputManager::promptLine()
+{
+    if (!searching)
+        return "> " + lineBuffer;
+    const bool failed = !searchQuery.empty() && searchMatch < 0;
+    std::string line = failed ? "(反向搜索失败)`" : "(反向搜索)`";
+    line += searchQuery + "': ";
+    if (searchMatch >= 0)
+        line += CommandHistory::at(static_cast<std::size_t>(searchMatch));
+    return line;
+}
+
+void ConsoleInputManager::redrawLine()
+{
+    if (echoEnabled())
+        std::cout << "\r\x1B[K" << promptLine() << std::flush;
+}
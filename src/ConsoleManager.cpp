@@ -3,6 +3,7 @@
 #include "ConsoleManager.hpp"
 #include "ConsoleOutputManager.hpp"
 #include "SessionManager.hpp"
+#include "CommandTemplate.hpp"
 
 
 json ConsoleManager::config;
@@ -32,23 +33,51 @@ bool ConsoleManager::loadConfig(const std::string& filename)
 
 json ConsoleManager::GetServerStatus()
 {
-    return SessionManager::GetServerStatus(config["dispatchUrl"], config["adminKey"]);
+    return SessionManager::GetServerStatus(config.at("dispatchUrl"), config.at("adminKey"));
 }
 
 json ConsoleManager::GetPlayerMessageInfo(const std::string& playerUid)
 {
-    return SessionManager::GetPlayerInfo(config["dispatchUrl"], config["adminKey"], playerUid);
+    return SessionManager::GetPlayerInfo(config.at("dispatchUrl"), config.at("adminKey"), playerUid);
 }
 
 json ConsoleManager::SubmitCommand(const std::string& commandText, const std::string& playerUid)
 {
-    return SessionManager::SubmitCommand(config["dispatchUrl"], config["adminKey"], commandText, playerUid);
+    return SessionManager::SubmitCommand(config.at("dispatchUrl"), config.at("adminKey"), commandText, playerUid);
+}
+
+SessionManager::Session ConsoleManager::OpenSession()
+{
+    return SessionManager::OpenSession(config.at("dispatchUrl"), config.at("adminKey"));
+}
+
+json ConsoleManager::SubmitCommand(const SessionManager::Session& session, const std::string& commandText, const std::string& playerUid)
+{
+    return SessionManager::SubmitCommand(session, commandText, playerUid);
+}
+
+std::string ConsoleManager::buildGiveCommand(const std::string& itemId, int count)
+{
+    static const CommandTemplate give("give {id} x{n}");
+    const std::string n = std::to_string(count);
+    return give.expand({itemId, n});
+}
+
+std::string ConsoleManager::buildRelicCommand(const Relic& relic, int count)
+{
+    // 子词条为空时使用不带 {sub} 的模板
+    static const CommandTemplate withSub("relic {id} {main} {sub} {level} x{n}");
+    static const CommandTemplate withoutSub("relic {id} {main} {level} x{n}");
+    const std::string n = std::to_string(count);
+    const auto& sub = relic.getSubTag();
+    if (sub.empty())
+        return withoutSub.expand({relic.getId(), relic.getMainTag(), relic.getLevel(), n});
+    return withSub.expand({relic.getId(), relic.getMainTag(), sub, relic.getLevel(), n});
 }
 
 json ConsoleManager::CommandGive(const std::string& itemId, int count, const std::string& playerUid)
 {
-    std::string commandText = "give " + itemId + " x" + std::to_string(count);
-    return SubmitCommand(commandText, playerUid);
+    return SubmitCommand(buildGiveCommand(itemId, count), playerUid);
 }
 
 json ConsoleManager::CommandRelic(
@@ -56,20 +85,5 @@ json ConsoleManager::CommandRelic(
     int           count,
     const std::string& playerUid)
 {
-    // 拼接子词条，若为空则跳过
-    const auto& sub = relic.getSubTag();
-    std::string subPart = sub.empty() ? "" : (" " + sub);
-
-    // 构造命令文本
-    std::ostringstream oss;
-    oss  << "relic "
-         << relic.getId()
-         << " " << relic.getMainTag()
-         << subPart
-         << " " << relic.getLevel()
-         << " x" << count;
-    std::string commandText = oss.str();
-
-    // 提交命令
-    return SubmitCommand(commandText, playerUid);
+    return SubmitCommand(buildRelicCommand(relic, count), playerUid);
 }
\ No newline at end of file
@@ -1,21 +1,63 @@
 #include "ConsoleOutputManager.hpp"
 #include "ConsoleInputManager.hpp"
+#include "TerminalBackend.hpp"
+#include "Metrics.hpp"
 #include <thread>
 #include <chrono>
-#include <windows.h>
-#include <conio.h>
 
 // 延迟打印每个字符的时间（毫秒）
 int ConsoleOutputManager::delayMs = 2;
 
 // 输出队列和同步机制
-std::queue<ConsoleMessage> ConsoleOutputManager::queue;
+std::array<std::deque<ConsoleMessage>, ConsoleOutputManager::LaneCount> ConsoleOutputManager::lanes;
+std::size_t ConsoleOutputManager::queuedCount = 0;
+std::size_t ConsoleOutputManager::capacity = 1024;
+OverflowPolicy ConsoleOutputManager::policy = OverflowPolicy::Summarize;
+int ConsoleOutputManager::lastLane = -1;
+std::size_t ConsoleOutputManager::droppedCount = 0;
+std::uint64_t ConsoleOutputManager::nextSeq = 0;
+std::deque<ConsoleMessage> ConsoleOutputManager::recent;
+bool ConsoleOutputManager::suspended = false;
+std::deque<ConsoleMessage> ConsoleOutputManager::held;
+std::size_t ConsoleOutputManager::heldDropped = 0;
 std::mutex ConsoleOutputManager::queueMutex;
 std::condition_variable ConsoleOutputManager::queueNotifier;
+std::condition_variable ConsoleOutputManager::spaceNotifier;
 std::recursive_mutex ConsoleOutputManager::outputMutex;
 std::atomic<bool> ConsoleOutputManager::isTyping{false};
 
-static bool outputStarted = false;
+// 非终端输出时的待写缓冲，超过阈值或队列清空时成块写出
+std::string ConsoleOutputManager::pendingOutput;
+static constexpr std::size_t BatchBytes = 64 * 1024;
+
+static std::atomic<bool> outputStarted{false};
+static std::thread outputThread;
+static bool stopRequested = false; // 受 queueMutex 保护
+
+namespace
+{
+    struct OutputMetrics
+    {
+        Metrics::Gauge &queueDepth = Metrics::gauge("danheng_console_output_queue_depth", "输出队列中等待打印的消息数");
+        Metrics::Counter &merged = Metrics::counter("danheng_console_output_merged_total", "与上一条相同而合并计数的消息数");
+        Metrics::Counter &dropped = Metrics::counter("danheng_console_output_dropped_total", "输出队列溢出时丢弃的消息数");
+        std::array<Metrics::Counter *, 6> messages{};
+
+        OutputMetrics()
+        {
+            const char *types[] = {"success", "error", "warning", "info", "newline", "command"};
+            for (std::size_t i = 0; i < messages.size(); ++i)
+                messages[i] = &Metrics::counter("danheng_console_output_messages_total", "进入输出队列的消息数",
+                                                {{"type", types[i]}});
+        }
+    };
+
+    OutputMetrics &outputMetrics()
+    {
+        static OutputMetrics metrics;
+        return metrics;
+    }
+}
 
 // 启动后台输出线程（仅启动一次）
 void ConsoleOutputManager::start()
@@ -25,21 +67,153 @@ void ConsoleOutputManager::start()
 
     if (!outputStarted)
     {
-        std::thread(outputLoop).detach();
+        outputThread = std::thread(outputLoop);
         outputStarted = true;
     }
 }
 
+// 输出完队列中剩余消息后结束输出线程
+void ConsoleOutputManager::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopRequested = true;
+        suspended = false; // 暂存的消息也要在退出前输出
+    }
+    queueNotifier.notify_all();
+    if (outputThread.joinable())
+        outputThread.join();
+    if (TerminalBackend::outputIsTty())
+        std::cout << std::endl;
+}
+
+// 设置队列容量与溢出策略
+void ConsoleOutputManager::configure(std::size_t capacity_, OverflowPolicy policy_)
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        capacity = capacity_ > 0 ? capacity_ : 1;
+        policy = policy_;
+    }
+    spaceNotifier.notify_all();
+}
+
+// 消息类型对应的优先级分道，数值越小越先输出
+int ConsoleOutputManager::laneOf(MessageType type)
+{
+    switch (type)
+    {
+    case MessageType::Error:
+    case MessageType::Command:
+    case MessageType::Newline:
+        return 0;
+    case MessageType::Success:
+    case MessageType::Warning:
+        return 1;
+    default:
+        return 2;
+    }
+}
+
 // 添加消息到输出队列，只使用 text 和 type 两个参数
 void ConsoleOutputManager::buffer(const std::string &text, MessageType type)
 {
+    const int lane = laneOf(type);
+    OutputMetrics &metrics = outputMetrics();
+    metrics.messages[static_cast<std::size_t>(type)]->add();
     {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        queue.emplace(text, type);
+        std::unique_lock<std::mutex> lock(queueMutex);
+
+        // 与上一条仍在排队的消息相同：只累加重复次数
+        if (lane == lastLane && !lanes[lane].empty())
+        {
+            ConsoleMessage &last = lanes[lane].back();
+            if (last.type == type && last.content == text)
+            {
+                ++last.repeat;
+                metrics.merged.add();
+                return;
+            }
+        }
+
+        if (queuedCount >= capacity)
+        {
+            const int lowLane = LaneCount - 1;
+            const bool dropLow = policy != OverflowPolicy::Block;
+
+            if (dropLow && lane == lowLane)
+            {
+                // 新消息本身就是低优先级，直接丢弃
+                ++droppedCount;
+                metrics.dropped.add();
+                return;
+            }
+            if (dropLow && !lanes[lowLane].empty())
+            {
+                // 为高优先级消息腾出位置：淘汰最早的 [INFO]
+                lanes[lowLane].pop_front();
+                --queuedCount;
+                ++droppedCount;
+                metrics.dropped.add();
+            }
+            else if (outputStarted)
+            {
+                // 没有可淘汰的消息（或策略为阻塞）：等待输出线程消费
+                spaceNotifier.wait(lock, []
+                                   { return queuedCount < capacity; });
+            }
+        }
+
+        lanes[lane].emplace_back(text, type);
+        lanes[lane].back().seq = nextSeq++;
+        ++queuedCount;
+        lastLane = lane;
+        metrics.queueDepth.set(static_cast<std::int64_t>(queuedCount));
     }
     queueNotifier.notify_one();
 }
 
+// 按优先级取出下一条消息（调用方需持有 queueMutex）
+bool ConsoleOutputManager::popNext(ConsoleMessage &out)
+{
+    // 溢出丢弃过消息且队列已回落到半满以下时，先输出汇总
+    if (droppedCount > 0 && queuedCount <= capacity / 2)
+    {
+        if (policy == OverflowPolicy::Summarize)
+        {
+            out = ConsoleMessage("输出过载，已省略 " + std::to_string(droppedCount) + " 条 [INFO] 消息",
+                                 MessageType::Warning);
+            droppedCount = 0;
+            return true;
+        }
+        droppedCount = 0;
+    }
+
+    // 积压不多时按入队顺序输出；超过拥塞阈值后高优先级分道先出
+    const bool congested = queuedCount > CongestionThreshold;
+    std::deque<ConsoleMessage> *next = nullptr;
+    for (auto &lane : lanes)
+    {
+        if (lane.empty())
+            continue;
+        if (congested)
+        {
+            next = &lane;
+            break;
+        }
+        if (!next || lane.front().seq < next->front().seq)
+            next = &lane;
+    }
+    if (!next)
+        return false;
+
+    out = std::move(next->front());
+    next->pop_front();
+    --queuedCount;
+    outputMetrics().queueDepth.set(static_cast<std::int64_t>(queuedCount));
+    return true;
+}
+
 // 后台线程循环消费消息队列
 void ConsoleOutputManager::outputLoop()
 {
@@ -47,16 +221,152 @@ void ConsoleOutputManager::outputLoop()
     {
         std::unique_lock<std::mutex> lock(queueMutex);
         queueNotifier.wait(lock, []
-                           { return !queue.empty(); });
+                           { return queuedCount > 0 || droppedCount > 0 || stopRequested ||
+                                    (!suspended && (!held.empty() || heldDropped > 0)); });
+
+        if (stopRequested && queuedCount == 0 && droppedCount == 0 && held.empty() && heldDropped == 0)
+        {
+            lock.unlock();
+            if (!pendingOutput.empty())
+                flushPending();
+            return;
+        }
 
-        ConsoleMessage msg = queue.front();
-        queue.pop();
+        ConsoleMessage msg("", MessageType::Newline);
+        bool hasMessage = false;
+        if (!suspended && heldDropped > 0)
+        {
+            // 补打之前先说明暂停期间有多少条没能暂存
+            msg = ConsoleMessage("暂停输出期间另有 " + std::to_string(heldDropped) + " 条消息未保留", MessageType::Warning);
+            heldDropped = 0;
+            hasMessage = true;
+        }
+        else if (!suspended && !held.empty())
+        {
+            msg = std::move(held.front());
+            held.pop_front();
+            hasMessage = true;
+        }
+        else if (popNext(msg))
+        {
+            remember(msg);
+            hasMessage = true;
+            if (suspended)
+            {
+                // 暂停中：只记下，不打印，也不唤醒输入线程重绘提示符
+                if (held.size() < capacity)
+                    held.push_back(std::move(msg));
+                else
+                    ++heldDropped;
+                lock.unlock();
+                spaceNotifier.notify_all();
+                continue;
+            }
+        }
+        bool drained = queuedCount == 0 && held.empty();
+        if (hasMessage)
+            isTyping = true; // 出队即视为打印中，输入线程据此把按键暂存到 shadow
         lock.unlock();
+        spaceNotifier.notify_all();
+
+        if (hasMessage)
+        {
+            flushSingle(msg);
+            isTyping = false;
+        }
 
-        flushSingle(msg);
+        if (!pendingOutput.empty() && (drained || pendingOutput.size() >= BatchBytes))
+            flushPending();
+
+        // 队列已清空：通知输入线程重绘提示符与打印期间敲入的内容
+        if (hasMessage && drained)
+            ConsoleInputManager::notifyOutputIdle();
     }
 }
 
+// 记入最近消息（调用方需持有 queueMutex）
+void ConsoleOutputManager::remember(const ConsoleMessage &msg)
+{
+    if (msg.content.empty())
+        return;
+    recent.push_back(msg);
+    if (recent.size() > RecentCount)
+        recent.pop_front();
+}
+
+void ConsoleOutputManager::suspend()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        suspended = true;
+    }
+    // 等已出队的那条消息逐字打完，之后输出线程不再碰终端
+    while (isTyping)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+void ConsoleOutputManager::resume()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        suspended = false;
+    }
+    queueNotifier.notify_all();
+}
+
+std::vector<ConsoleMessage> ConsoleOutputManager::recentMessages()
+{
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return std::vector<ConsoleMessage>(recent.begin(), recent.end());
+}
+
+// 锁住终端输出，供输入线程回显时避免与消息打印交错
+std::unique_lock<std::recursive_mutex> ConsoleOutputManager::lockOutput()
+{
+    return std::unique_lock<std::recursive_mutex>(outputMutex);
+}
+
+// 尝试锁住终端输出；正在打印时立即返回未持有锁的 unique_lock
+std::unique_lock<std::recursive_mutex> ConsoleOutputManager::tryLockOutput()
+{
+    return std::unique_lock<std::recursive_mutex>(outputMutex, std::try_to_lock);
+}
+
+// 队列为空且没有正在打印的消息
+bool ConsoleOutputManager::isIdle()
+{
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return queuedCount == 0 && !isTyping;
+}
+
+// 丢弃所有尚未输出的消息
+std::size_t ConsoleOutputManager::discardQueued()
+{
+    std::size_t discarded = 0;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        for (auto &lane : lanes)
+        {
+            discarded += lane.size();
+            lane.clear();
+        }
+        queuedCount = 0;
+        droppedCount = 0;
+        lastLane = -1;
+        outputMetrics().queueDepth.set(0);
+    }
+    spaceNotifier.notify_all();
+    return discarded;
+}
+
+// 把待写缓冲一次性交给终端后端
+void ConsoleOutputManager::flushPending()
+{
+    std::cout.flush();
+    TerminalBackend::write(pendingOutput);
+    pendingOutput.clear();
+}
+
 // 返回消息类型对应的颜色代码
 std::string ConsoleOutputManager::getColorCode(MessageType type)
 {
@@ -77,14 +387,32 @@ std::string ConsoleOutputManager::getColorCode(MessageType type)
     }
 }
 
+// 返回消息类型对应的行首标签
+const char *ConsoleOutputManager::getPrefix(MessageType type)
+{
+    switch (type)
+    {
+    case MessageType::Success:
+        return "[SUCCESS] ";
+    case MessageType::Error:
+        return "[ERROR] ";
+    case MessageType::Warning:
+        return "[WARN] ";
+    case MessageType::Info:
+        return "[INFO] ";
+    case MessageType::Command:
+        return "[Command] ";
+    default:
+        return "";
+    }
+}
+
 // 逐字打出文本内容，带有字符延迟效果
 void ConsoleOutputManager::typeWrite(const std::string &text, std::ostream &out)
 {
     int counter = 0;
     for (char c : text)
     {
-        while (_kbhit())
-            _getch(); // 清除键盘输入缓存
         out << c << std::flush;
 
         if (++counter % 3 == 0 && c != '\n' && c != '\r')
@@ -96,7 +424,29 @@ void ConsoleOutputManager::typeWrite(const std::string &text, std::ostream &out)
 void ConsoleOutputManager::flushSingle(const ConsoleMessage &msg)
 {
     std::lock_guard<std::recursive_mutex> lock(outputMutex);
-    isTyping.exchange(true);
+
+    // 连续重复的消息合并为一行，末尾附加重复次数
+    std::string content = msg.content;
+    if (msg.repeat > 1)
+        content += " ×" + std::to_string(msg.repeat);
+
+    // 输出不是终端（管道、文件、journald）：不加颜色与动画，整行攒入缓冲成块写出
+    if (!TerminalBackend::outputIsTty())
+    {
+        std::string line = getPrefix(msg.type) + content + '\n';
+        if (msg.type == MessageType::Error)
+        {
+            // 错误仍写到标准错误，先写出之前攒下的内容以保持顺序
+            if (!pendingOutput.empty())
+                flushPending();
+            TerminalBackend::write(line, true);
+        }
+        else
+        {
+            pendingOutput += line;
+        }
+        return;
+    }
 
     std::ostream &out = (msg.type == MessageType::Error) ? std::cerr : std::cout;
 
@@ -107,25 +457,7 @@ void ConsoleOutputManager::flushSingle(const ConsoleMessage &msg)
     out << color;
 
     // 输出前缀
-    switch (msg.type)
-    {
-    case MessageType::Success:
-        out << "[SUCCESS] ";
-        break;
-    case MessageType::Error:
-        out << "[ERROR] ";
-        break;
-    case MessageType::Warning:
-        out << "[WARN] ";
-        break;
-    case MessageType::Info:
-        out << "[INFO] ";
-        break;
-    case MessageType::Command:
-        out << "[Command] ";
-    default:
-        break;
-    }
+    out << getPrefix(msg.type);
 
     // 动态打印处理（按类型自动判断）
     bool animated = (msg.type == MessageType::Success ||
@@ -135,13 +467,11 @@ void ConsoleOutputManager::flushSingle(const ConsoleMessage &msg)
                     msg.type == MessageType::Warning);
 
     if (animated)
-        typeWrite(msg.content, out);
+        typeWrite(content, out);
     else
-        out << msg.content;
+        out << content;
 
     // 重置颜色（仅在需要时）
     if (!color.empty() && msg.type != MessageType::Newline)
         out << "\x1B[0m";
-        
-    isTyping.exchange(false);
 }
\ No newline at end of file
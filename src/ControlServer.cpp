@@ -0,0 +1,556 @@
+#include "ControlServer.hpp"
+#include "Metrics.hpp"
+#include "SessionManager.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+
+namespace
+{
+    // 服务器拒绝了会话本身（不存在、过期或未授权）：请求没有被执行，换新会话重发是安全的
+    // 其他失败（如命令执行出错）不能重发，否则非幂等的 exec 可能执行两次
+    bool sessionRejected(const SessionManager::Response &raw, const json &response)
+    {
+        if (raw.httpStatus == 401 || raw.httpStatus == 403)
+            return true;
+        if (response.value("code", 0) == 0 || !response.contains("message") || !response["message"].is_string())
+            return false;
+        std::string message = response["message"].get<std::string>();
+        std::transform(message.begin(), message.end(), message.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        for (const char *hint : {"session", "expire", "unauthori", "not auth"})
+            if (message.find(hint) != std::string::npos)
+                return true;
+        return false;
+    }
+
+    // 经共享会话发一个 MUIP 请求；会话被拒绝时重建会话重试一次，其余失败原样返回
+    json callMuip(const ControlServer::Options &options, const char *path,
+                  const std::function<std::string(const SessionManager::Session &)> &body)
+    {
+        for (int attempt = 0;; ++attempt)
+        {
+            const SessionManager::Session session = SessionManager::SharedSession(options.serverUrl, options.adminKey);
+            const SessionManager::Response raw =
+                SessionManager::postOnce(session.serverUrl, path, body(session), options.requestTimeoutMs);
+            if (!raw.transportError.empty())
+                throw std::runtime_error(raw.transportError);
+            json response = raw.httpStatus == 200 ? SessionManager::parseResponse(raw.body) : json::object();
+            if (attempt == 0 && sessionRejected(raw, response))
+            {
+                SessionManager::InvalidateSharedSession(session.sessionId);
+                continue;
+            }
+            if (raw.httpStatus != 200)
+                throw std::runtime_error("HTTP " + std::to_string(raw.httpStatus));
+            return response;
+        }
+    }
+
+    std::string requireString(const json &request, const char *key)
+    {
+        if (!request.contains(key) || !request[key].is_string() || request[key].get<std::string>().empty())
+            throw std::invalid_argument(std::string("缺少参数 ") + key);
+        return request[key].get<std::string>();
+    }
+
+    Metrics::Counter &requestCounter(const std::string &op)
+    {
+        static Metrics::Counter &ping = Metrics::counter("danheng_console_control_requests_total", "控制套接字收到的请求数", {{"op", "ping"}});
+        static Metrics::Counter &status = Metrics::counter("danheng_console_control_requests_total", "控制套接字收到的请求数", {{"op", "status"}});
+        static Metrics::Counter &player = Metrics::counter("danheng_console_control_requests_total", "控制套接字收到的请求数", {{"op", "player"}});
+        static Metrics::Counter &exec = Metrics::counter("danheng_console_control_requests_total", "控制套接字收到的请求数", {{"op", "exec"}});
+        static Metrics::Counter &other = Metrics::counter("danheng_console_control_requests_total", "控制套接字收到的请求数", {{"op", "other"}});
+        return op == "ping" ? ping : op == "status" ? status : op == "player" ? player : op == "exec" ? exec : other;
+    }
+}
+
+json ControlServer::handle(const json &request, const Options &options)
+{
+    json response = {{"id", request.is_object() && request.contains("id") ? request["id"] : json()}};
+    static Metrics::Counter &errors = Metrics::counter("danheng_console_control_errors_total", "控制套接字返回失败的请求数");
+    try
+    {
+        if (!request.is_object())
+            throw std::invalid_argument("请求应为 JSON 对象");
+        const std::string op = request.value("op", std::string());
+        requestCounter(op).add();
+
+        json data;
+        if (op == "ping")
+        {
+            data = {{"time", std::chrono::duration_cast<std::chrono::seconds>(
+                                 std::chrono::system_clock::now().time_since_epoch())
+                                 .count()}};
+        }
+        else if (op == "status")
+        {
+            data = callMuip(options, "/muip/server_information", [](const SessionManager::Session &session)
+                            { return SessionManager::buildServerStatusBody(session.sessionId); });
+        }
+        else if (op == "player")
+        {
+            const std::string uid = requireString(request, "uid");
+            data = callMuip(options, "/muip/player_information", [&](const SessionManager::Session &session)
+                            { return SessionManager::buildPlayerInfoBody(session.sessionId, uid); });
+        }
+        else if (op == "exec")
+        {
+            const std::string uid = requireString(request, "uid");
+            const std::string command = requireString(request, "command");
+            data = callMuip(options, "/muip/exec_cmd", [&](const SessionManager::Session &session)
+                            { return SessionManager::buildCommandBody(session.sessionId, session.rsaPublicKey, command, uid); });
+            if (data.contains("data") && data["data"].is_object() && data["data"].contains("message") &&
+                data["data"]["message"].is_string())
+                response["output"] = SessionManager::base64Decode(data["data"]["message"].get<std::string>());
+        }
+        else
+            throw std::invalid_argument("未知操作：" + op);
+
+        response["ok"] = true;
+        response["data"] = std::move(data);
+    }
+    catch (const std::exception &e)
+    {
+        errors.add();
+        response["ok"] = false;
+        response["error"] = e.what();
+    }
+    return response;
+}
+
+void ControlServer::appendFrame(std::string &out, const std::string &payload)
+{
+    const auto length = static_cast<std::uint32_t>(payload.size());
+    out += static_cast<char>(length >> 24);
+    out += static_cast<char>(length >> 16);
+    out += static_cast<char>(length >> 8);
+    out += static_cast<char>(length);
+    out += payload;
+}
+
+#ifndef _WIN32
+
+#include "ThreadPool.hpp"
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // 客户端不读响应时，待写超过此字节数就暂停读取它的请求
+    constexpr std::size_t OutputHighWater = 4 << 20;
+
+    struct Client
+    {
+        int fd = -1;
+        std::string in;
+        std::size_t inStart = 0;  // in 中尚未解析的起点
+        std::string out;
+        std::size_t outStart = 0; // out 中尚未写出的起点
+        std::size_t pending = 0;  // 已交给工作线程、尚未写回的请求数
+        bool readClosed = false;  // 对端已关闭写端或协议错误：写完剩余响应后断开
+        bool broken = false;      // 协议错误，之后收到的数据不再解析
+    };
+
+    struct Completion
+    {
+        std::uint64_t client;
+        std::string frame;
+    };
+
+    std::mutex stateMutex; // 保护 isRunning 与启动/停止
+    bool isRunning = false;
+    std::thread loopThread;
+    std::atomic<bool> stopping{false};
+    int listenFd = -1;
+    int wakeReadFd = -1;
+    int wakeWriteFd = -1;
+    ControlServer::Options current;
+    std::unique_ptr<ThreadPool> pool;
+
+    std::mutex completionMutex;
+    std::vector<Completion> completions;
+
+    void setNonBlocking(int fd)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    void wake()
+    {
+        char one = 1;
+        ssize_t n = ::write(wakeWriteFd, &one, 1);
+        (void)n; // 管道已满时事件循环本来就会被唤醒
+    }
+
+    Metrics::Gauge &clientGauge()
+    {
+        static Metrics::Gauge &gauge = Metrics::gauge("danheng_console_control_clients", "控制套接字当前连接数");
+        return gauge;
+    }
+
+    void respond(Client &client, const json &response)
+    {
+        ControlServer::appendFrame(client.out, response.dump(-1, ' ', false, json::error_handler_t::replace));
+    }
+
+    // 解析 in 中的完整帧：ping 与无法解析的请求就地回复，其余交给工作线程
+    // 该连接在途请求达到上限时停下，剩余的帧留在 in 中，等有请求完成后再解析
+    void dispatch(std::uint64_t id, Client &client)
+    {
+        while (client.in.size() - client.inStart >= 4 && !client.broken &&
+               client.pending < current.maxInFlightPerClient)
+        {
+            const auto *p = reinterpret_cast<const unsigned char *>(client.in.data() + client.inStart);
+            const std::size_t length = static_cast<std::size_t>(p[0]) << 24 | static_cast<std::size_t>(p[1]) << 16 |
+                                       static_cast<std::size_t>(p[2]) << 8 | p[3];
+            if (length > current.maxFrameBytes)
+            {
+                respond(client, {{"id", nullptr}, {"ok", false}, {"error", "请求帧过长：" + std::to_string(length) + " 字节"}});
+                client.readClosed = client.broken = true;
+                break;
+            }
+            if (client.in.size() - client.inStart < 4 + length)
+                break;
+
+            json request = json::parse(client.in.begin() + client.inStart + 4,
+                                       client.in.begin() + client.inStart + 4 + length, nullptr, false);
+            client.inStart += 4 + length;
+            if (request.is_discarded())
+            {
+                respond(client, {{"id", nullptr}, {"ok", false}, {"error", "请求不是合法的 JSON"}});
+                continue;
+            }
+            if (!request.is_object() || request.value("op", json()) == "ping")
+            {
+                respond(client, ControlServer::handle(request, current));
+                continue;
+            }
+
+            ++client.pending;
+            pool->submit([id, request = std::move(request)]
+                         {
+                std::string frame;
+                ControlServer::appendFrame(frame, ControlServer::handle(request, current).dump(-1, ' ', false, json::error_handler_t::replace));
+                {
+                    std::lock_guard<std::mutex> lock(completionMutex);
+                    completions.push_back({id, std::move(frame)});
+                }
+                wake(); });
+        }
+        // 已解析的部分超过一半时再搬移，避免每帧都移动剩余数据
+        if (client.inStart > 0 && client.inStart * 2 >= client.in.size())
+        {
+            client.in.erase(0, client.inStart);
+            client.inStart = 0;
+        }
+    }
+
+    // 读到 EAGAIN 为止；返回 false 表示连接出错应立即关闭
+    bool readClient(std::uint64_t id, Client &client)
+    {
+        char chunk[64 * 1024];
+        while (true)
+        {
+            const ssize_t n = ::read(client.fd, chunk, sizeof chunk);
+            if (n > 0)
+            {
+                client.in.append(chunk, static_cast<std::size_t>(n));
+                continue;
+            }
+            if (n == 0)
+                client.readClosed = true;
+            else if (errno == EINTR)
+                continue;
+            else if (errno != EAGAIN && errno != EWOULDBLOCK)
+                return false;
+            break;
+        }
+        dispatch(id, client);
+        return true;
+    }
+
+    bool writeClient(Client &client)
+    {
+        while (client.outStart < client.out.size())
+        {
+#ifdef MSG_NOSIGNAL
+            const int flags = MSG_NOSIGNAL; // 对端已关闭时返回 EPIPE 而不是发 SIGPIPE
+#else
+            const int flags = 0;
+#endif
+            const ssize_t n = ::send(client.fd, client.out.data() + client.outStart, client.out.size() - client.outStart, flags);
+            if (n > 0)
+            {
+                client.outStart += static_cast<std::size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return true;
+            return false;
+        }
+        client.out.clear();
+        client.outStart = 0;
+        return true;
+    }
+
+    void eventLoop()
+    {
+        std::map<std::uint64_t, Client> clients;
+        std::uint64_t nextClient = 1;
+        std::vector<pollfd> fds;
+        std::vector<std::uint64_t> owners; // fds[i]（i >= 2）对应的客户端
+
+        auto closeClient = [&](std::map<std::uint64_t, Client>::iterator it)
+        {
+            ::close(it->second.fd);
+            clients.erase(it);
+            clientGauge().set(static_cast<std::int64_t>(clients.size()));
+        };
+
+        while (!stopping)
+        {
+            fds.assign({{wakeReadFd, POLLIN, 0}, {listenFd, POLLIN, 0}});
+            owners.clear();
+            for (auto &[id, client] : clients)
+            {
+                short events = 0;
+                if (!client.readClosed && client.out.size() - client.outStart < OutputHighWater &&
+                    client.pending < current.maxInFlightPerClient)
+                    events |= POLLIN;
+                if (client.outStart < client.out.size())
+                    events |= POLLOUT;
+                fds.push_back({client.fd, events, 0});
+                owners.push_back(id);
+            }
+
+            if (poll(fds.data(), fds.size(), -1) < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+
+            if (fds[0].revents & POLLIN)
+            {
+                char drain[256];
+                while (::read(wakeReadFd, drain, sizeof drain) > 0)
+                {
+                }
+                std::vector<Completion> done;
+                {
+                    std::lock_guard<std::mutex> lock(completionMutex);
+                    done.swap(completions);
+                }
+                for (auto &completion : done)
+                {
+                    auto it = clients.find(completion.client);
+                    if (it == clients.end())
+                        continue; // 客户端已断开，丢弃结果
+                    --it->second.pending;
+                    it->second.out += completion.frame;
+                    dispatch(it->first, it->second); // 在途数回落，继续解析积压的帧
+                }
+            }
+
+            if (fds[1].revents & POLLIN)
+            {
+                while (true)
+                {
+                    const int fd = ::accept(listenFd, nullptr, nullptr);
+                    if (fd < 0)
+                        break;
+                    if (clients.size() >= current.maxClients)
+                    {
+                        ::close(fd);
+                        continue;
+                    }
+                    setNonBlocking(fd);
+#ifdef SO_NOSIGPIPE
+                    int one = 1;
+                    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof one);
+#endif
+                    clients[nextClient++].fd = fd;
+                    clientGauge().set(static_cast<std::int64_t>(clients.size()));
+                }
+            }
+
+            for (std::size_t i = 2; i < fds.size(); ++i)
+            {
+                auto it = clients.find(owners[i - 2]);
+                Client &client = it->second;
+                bool alive = true;
+                if (fds[i].revents & (POLLIN | POLLHUP))
+                    alive = readClient(it->first, client);
+                // 对端已完全关闭（而非只关闭写端）：响应已无法送达，不必等进行中的请求
+                if (fds[i].revents & (POLLHUP | POLLERR))
+                    alive = false;
+                if (alive && client.outStart < client.out.size())
+                    alive = writeClient(client);
+                if (!alive || (client.readClosed && client.pending == 0 && client.outStart >= client.out.size()))
+                    closeClient(it);
+            }
+        }
+
+        while (!clients.empty())
+            closeClient(clients.begin());
+    }
+
+    // 程序结束时停止事件循环（正常退出路径已先调用 stop()）
+    struct StopAtExit
+    {
+        ~StopAtExit() { ControlServer::stop(); }
+    } stopAtExit;
+}
+
+bool ControlServer::supported()
+{
+    return true;
+}
+
+bool ControlServer::start(const Options &options, std::string &error)
+{
+    std::lock_guard<std::mutex> lock(stateMutex);
+    if (isRunning)
+    {
+        error = "控制套接字已在运行";
+        return false;
+    }
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    const std::string path = options.path.string();
+    if (path.empty() || path.size() >= sizeof(address.sun_path))
+    {
+        error = "套接字路径为空或过长：" + path;
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    // 路径已存在：能连上说明另一个控制台正在使用；连不上的残留套接字直接删除
+    struct stat info;
+    if (::lstat(path.c_str(), &info) == 0)
+    {
+        if (!S_ISSOCK(info.st_mode))
+        {
+            error = "路径已存在且不是套接字：" + path;
+            return false;
+        }
+        const int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        const bool inUse = probe >= 0 && ::connect(probe, reinterpret_cast<sockaddr *>(&address), sizeof address) == 0;
+        if (probe >= 0)
+            ::close(probe);
+        if (inUse)
+        {
+            error = "已有进程在监听 " + path;
+            return false;
+        }
+        ::unlink(path.c_str());
+    }
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        error = std::string("无法创建套接字：") + std::strerror(errno);
+        return false;
+    }
+    setNonBlocking(fd);
+    // 只允许本用户连接：套接字可以代替管理员执行命令。listen() 之前无法连接，先改权限再监听
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof address) != 0 ||
+        ::chmod(path.c_str(), S_IRUSR | S_IWUSR) != 0 || ::listen(fd, 16) != 0)
+    {
+        error = "无法监听 " + path + "：" + std::strerror(errno);
+        ::close(fd);
+        ::unlink(path.c_str());
+        return false;
+    }
+
+    int pipeFds[2];
+    if (::pipe(pipeFds) != 0)
+    {
+        error = std::string("无法创建唤醒管道：") + std::strerror(errno);
+        ::close(fd);
+        ::unlink(path.c_str());
+        return false;
+    }
+    setNonBlocking(pipeFds[0]);
+    setNonBlocking(pipeFds[1]);
+
+    listenFd = fd;
+    wakeReadFd = pipeFds[0];
+    wakeWriteFd = pipeFds[1];
+    current = options;
+    if (current.maxInFlightPerClient < 1)
+        current.maxInFlightPerClient = 1;
+    pool = std::make_unique<ThreadPool>(options.workers > 0 ? options.workers : 1);
+    stopping = false;
+    isRunning = true;
+    loopThread = std::thread(eventLoop);
+    return true;
+}
+
+void ControlServer::stop()
+{
+    std::lock_guard<std::mutex> lock(stateMutex);
+    if (!isRunning)
+        return;
+    stopping = true;
+    wake();
+    loopThread.join();
+    pool.reset(); // 等进行中的请求结束；结果已无人接收
+    completions.clear();
+
+    ::close(listenFd);
+    ::close(wakeReadFd);
+    ::close(wakeWriteFd);
+    listenFd = wakeReadFd = wakeWriteFd = -1;
+    ::unlink(current.path.c_str());
+    isRunning = false;
+}
+
+bool ControlServer::running()
+{
+    std::lock_guard<std::mutex> lock(stateMutex);
+    return isRunning;
+}
+
+#else
+
+bool ControlServer::supported()
+{
+    return false;
+}
+
+bool ControlServer::start(const Options &, std::string &error)
+{
+    error = "当前平台不支持 Unix 域控制套接字";
+    return false;
+}
+
+void ControlServer::stop()
+{
+}
+
+bool ControlServer::running()
+{
+    return false;
+}
+
+#endif
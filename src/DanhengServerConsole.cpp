@@ -5,11 +5,13 @@
 #include <iostream>
 #include <fstream>
 #include <string>
-#include <windows.h>
-#include <conio.h>
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <limits>
+#include <sstream>
 #include <nlohmann/json.hpp>
 
 #include "SessionManager.hpp"
@@ -17,6 +19,23 @@
 #include "ConsoleOutputManager.hpp"
 #include "ConsoleInputManager.hpp"
 #include "ConsoleManager.hpp"
+#include "TerminalBackend.hpp"
+#include "ItemCatalogue.hpp"
+#include "BackupManager.hpp"
+#include "JobManager.hpp"
+#include "CommandTemplate.hpp"
+#include "PlayerWatcher.hpp"
+#include "RelicSimulator.hpp"
+#include "LoadTester.hpp"
+#include "Dashboard.hpp"
+#include "Metrics.hpp"
+#include "CommandHistory.hpp"
+#include "ControlServer.hpp"
+#include "InventoryReconciler.hpp"
+#include "PlayerExport.hpp"
+#include <functional>
+#include <memory>
+#include <random>
 
 using json = nlohmann::json;
 using namespace std;
@@ -33,31 +52,222 @@ constexpr MessageType Newline = MessageType::Newline;
 json&   config    = ConsoleManager::config;
 string& playerUid = ConsoleManager::playerUid;
 
+/// 读取线程数/工作线程数配置并限制在 minimum 到 64 之间（minimum 为 0 时 0 表示硬件并发数）
+static unsigned ConfigThreadCount(const json& source, const string& key, int fallback, int minimum = 1)
+{
+    // 以有符号数读取：负数不能回绕成约 40 亿个线程
+    constexpr int MaxThreads = 64;
+    const int requested = source.value(key, fallback);
+    const int count = clamp(requested, minimum, MaxThreads);
+    if (requested != count)
+        buffer(key + " 应在 " + to_string(minimum) + " 到 " + to_string(MaxThreads) + " 之间，已调整为 " + to_string(count), Warn);
+    return static_cast<unsigned>(count);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//                            输出队列配置
+////////////////////////////////////////////////////////////////////////////////
+
+/// 按配置设置输出队列容量与溢出策略（block / drop_info / summarize）
+static void ConfigureOutput()
+{
+    // 以有符号数读取：负数不能回绕成巨大的容量
+    const long long requested = config.value("output_queue_capacity", 1024LL);
+    const size_t capacity = static_cast<size_t>(clamp(requested, 16LL, 1LL << 20));
+    if (requested != static_cast<long long>(capacity))
+        buffer("output_queue_capacity 应在 16 到 1048576 之间，已调整为 " + to_string(capacity), Warn);
+    string policyName = config.value("output_overflow_policy", string("summarize"));
+
+    OverflowPolicy policy = OverflowPolicy::Summarize;
+    if (policyName == "block")
+        policy = OverflowPolicy::Block;
+    else if (policyName == "drop_info")
+        policy = OverflowPolicy::DropInfo;
+    else if (policyName != "summarize")
+        buffer("未知的输出溢出策略: " + policyName + "，使用 summarize", Warn);
+
+    ConsoleOutputManager::configure(capacity, policy);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //                            自动保存启动
 ////////////////////////////////////////////////////////////////////////////////
 
-/// 如果配置开启，则启动自动保存
+/// 解析保存方式：copy（整文件复制，默认）/ incremental（分块去重）/ compressed（并行 gzip）/ sqlite（在线备份）
+static SaveMode ParseSaveMode(const string& modeName)
+{
+    if (modeName == "incremental")
+        return SaveMode::Incremental;
+    if (modeName == "compressed")
+        return SaveMode::Compressed;
+    if (modeName == "sqlite")
+        return SaveMode::Sqlite;
+    if (modeName != "copy")
+        buffer("未知的自动保存方式: " + modeName + "，使用 copy", Warn);
+    return SaveMode::Copy;
+}
+
+/// 注册自动保存任务：旧版 autosave_* 单文件配置，以及 backup_jobs 数组中的多个任务
 static void StartAutoSave()
 {
-    if (!config.value("autosave", false))
+    int registered = 0;
+    try
+    {
+        if (config.value("autosave", false))
+        {
+            BackupJob::Options options;
+            options.name = "database";
+            options.source = config.at("database_file").get<string>();
+            options.destination = config.at("autosave_file").get<string>();
+            options.intervalSeconds = config.at("intervalSeconds").get<int>();
+            options.slotCount = config.at("slotCount").get<int>();
+            options.mode = ParseSaveMode(config.value("autosave_mode", string("copy")));
+            options.watch = config.value("autosave_watch", false);
+            options.debounceSeconds = config.value("autosave_debounce_seconds", 2);
+            options.compressLevel = config.value("autosave_compress_level", 6);
+            options.compressThreads = ConfigThreadCount(config, "autosave_threads", 0, 0);
+            options.sqlitePagesPerStep = config.value("sqlite_pages_per_step", 64);
+            options.sqlitePauseMs = config.value("sqlite_step_pause_ms", 5);
+            options.maxMegabytesPerSecond = config.value("autosave_max_mbps", 0.0);
+            options.lowIoPriority = config.value("autosave_low_io_priority", false);
+            AutoSaver::addJob(options);
+            ++registered;
+            buffer("自动保存已启动，保存路径: " + options.destination.string(), Info);
+        }
+
+        // 每个任务：{ "name", "source", "destination", "interval", "slots", "mode", ... }
+        for (const auto& entry : config.value("backup_jobs", json::array()))
+        {
+            BackupJob::Options options;
+            options.source = entry.at("source").get<string>();
+            options.destination = entry.at("destination").get<string>();
+            options.name = entry.value("name", options.source.filename().string());
+            options.intervalSeconds = entry.value("interval", 300);
+            options.slotCount = entry.value("slots", 5);
+            options.saveImmediately = entry.value("save_immediately", true);
+            options.mode = ParseSaveMode(entry.value("mode", string("copy")));
+            options.watch = entry.value("watch", false);
+            options.debounceSeconds = entry.value("debounce", 2);
+            options.compressLevel = entry.value("compress_level", 6);
+            options.compressThreads = ConfigThreadCount(entry, "threads", 0, 0);
+            options.copyThreads = ConfigThreadCount(entry, "copy_threads", 4, 0);
+            options.sqlitePagesPerStep = entry.value("pages_per_step", 64);
+            options.sqlitePauseMs = entry.value("step_pause_ms", 5);
+            options.maxMegabytesPerSecond = entry.value("max_mbps", 0.0);
+            options.lowIoPriority = entry.value("low_io_priority", false);
+            AutoSaver::addJob(options);
+            ++registered;
+            buffer("备份任务 [" + options.name + "] 已注册，每 " + to_string(options.intervalSeconds) +
+                   " 秒保存到 " + options.destination.string(), Info);
+        }
+    }
+    catch (const exception& ex)
+    {
+        buffer("自动保存开启失败: " + string(ex.what()), Error);
+    }
+
+    if (registered > 0)
+        AutoSaver::start();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//                              运行指标
+////////////////////////////////////////////////////////////////////////////////
+
+/// 配置了 metrics_textfile 时，定期把指标写成 Prometheus 文本文件（供 node-exporter textfile 收集器读取）
+static void StartMetricsExport()
+{
+    string path = config.value("metrics_textfile", string());
+    if (path.empty())
+        return;
+    int interval = config.value("metrics_interval", 15);
+    Metrics::startExport(path, interval);
+    buffer("运行指标每 " + to_string(max(interval, 1)) + " 秒写入 " + path, Info);
+}
+
+/// 列出当前全部指标
+static void MetricsMenu()
+{
+    vector<string> lines = Metrics::describe();
+    if (lines.empty())
+    {
+        buffer("暂无指标", Info);
+        return;
+    }
+    for (const auto& line : lines)
+        buffer(line, Info);
+
+    string path = config.value("metrics_textfile", string());
+    if (!path.empty())
+        buffer("Prometheus 文本文件：" + path, Info);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//                              控制套接字
+////////////////////////////////////////////////////////////////////////////////
+
+/// 配置了 control_socket 时在该路径监听本地控制请求（见 tools/danheng_ctl.py）
+static void StartControlSocket()
+{
+    string path = config.value("control_socket", string());
+    if (path.empty())
+        return;
+
+    ControlServer::Options options;
+    options.path = path;
+    options.serverUrl = config.at("dispatchUrl").get<string>();
+    options.adminKey = config.at("adminKey").get<string>();
+    options.workers = ConfigThreadCount(config, "control_workers", 4);
+    options.maxInFlightPerClient = static_cast<size_t>(max(1, config.value("control_max_inflight", 16)));
+    string error;
+    if (ControlServer::start(options, error))
+        buffer("控制套接字已在 " + path + " 监听", Info);
+    else
+        buffer("控制套接字启动失败：" + error, Warn);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//                              命令历史
+////////////////////////////////////////////////////////////////////////////////
+
+/// 打开持久化命令历史（history_file 为空时只在本次运行内记录）
+static void OpenCommandHistory()
+{
+    string path = config.value("history_file", string("command_history.txt"));
+    if (path.empty())
+        return;
+    if (!CommandHistory::open(path))
+        buffer("命令历史加载失败：" + path, Warn);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//                            物品表加载
+////////////////////////////////////////////////////////////////////////////////
+
+/// 如果配置了物品表，则加载（或编译）物品表索引，用于本地校验与名称搜索
+static void LoadItemCatalogue()
+{
+    if (!config.contains("item_catalogue"))
         return;
 
     try
     {
-        AutoSaver::start(
-            config.at("database_file").get<string>(),
-            config.at("autosave_file").get<string>(),
-            config.at("intervalSeconds").get<int>(),
-            config.at("slotCount").get<int>()
-        );
-        buffer("自动保存已启动，保存路径: " +
-               config.at("autosave_file").get<string>(),
-               Info);
+        vector<fs::path> sources;
+        const json& entry = config.at("item_catalogue");
+        if (entry.is_array())
+            for (const auto& path : entry)
+                sources.emplace_back(path.get<string>());
+        else
+            sources.emplace_back(entry.get<string>());
+
+        if (!ItemCatalogue::load(sources,
+                                 config.value("item_textmap", string()),
+                                 config.value("item_index", string("item_catalogue.idx"))))
+            buffer("物品表加载失败，将跳过本地校验", Warn);
     }
     catch (const exception& ex)
     {
-        buffer("自动保存开启失败: " + string(ex.what()), Error);
+        buffer("物品表配置错误: " + string(ex.what()), Error);
     }
 }
 
@@ -101,7 +311,87 @@ static int readIntOrDefault(int defaultValue = 1)
     }
 }
 
-inline void RandomRelics(Relic::Type type,
+/// 输出服务器对命令的响应，返回命令是否执行成功
+static bool ReportResponse(const JobManager::Job& job, const json& resp)
+{
+    if (!resp.contains("data") ||
+        !resp["data"].contains("message"))
+        throw runtime_error("响应数据格式错误，返回信息：" + resp.value("message", string()));
+
+    bool ok = resp["message"].get<string>() == "Success";
+    job.print(SessionManager::base64Decode(resp["data"]["message"].get<string>()), ok ? Success : Error);
+    return ok;
+}
+
+/// 把单条命令作为后台任务提交，菜单立即返回
+static void SubmitCommandJob(const string& title, function<json(const string& uid)> request)
+{
+    int id = JobManager::submit(title, playerUid, [request](JobManager::Job& job)
+    {
+        job.setTotal(1);
+        job.step(ReportResponse(job, request(job.uid())));
+    });
+    buffer("已提交后台任务 #" + to_string(id) + "：" + title, Info);
+}
+
+/// 含 {变量} 的自定义命令：编译模板、读取取值表，展开后作为一个后台任务逐条提交
+static void SubmitTemplateJob(const string& text)
+{
+    shared_ptr<const CommandTemplate> tpl;
+    shared_ptr<const TemplateBindings> bindings;
+    try
+    {
+        tpl = make_shared<const CommandTemplate>(text);
+        string names;
+        for (const auto& name : tpl->variables())
+            names += (names.empty() ? "{" : " {") + name + "}";
+        buffer("模板变量: " + (names.empty() ? string("无") : names), Info);
+        buffer("请输入取值（如 id=1001..1100 n=1、part=1,2,3 或 @items.csv）: ", Command);
+        bindings = make_shared<const TemplateBindings>(TemplateBindings::parse(read(), *tpl));
+    }
+    catch (const exception& e)
+    {
+        buffer(string("模板无效: ") + e.what(), Error);
+        return;
+    }
+
+    // 预览第一条，避免整批都写错
+    const size_t count = bindings->size();
+    bindings->forEach(*tpl, [](const string& command)
+    {
+        buffer("第一条: " + command, Info);
+        return false;
+    });
+
+    const string title = "模板 " + text + " ×" + to_string(count);
+    int id = JobManager::submit(title, playerUid, [tpl, bindings](JobManager::Job& job)
+    {
+        job.setTotal(static_cast<int>(bindings->size()));
+        const auto session = ConsoleManager::OpenSession();
+        bindings->forEach(*tpl, [&](const string& command)
+        {
+            if (job.cancelled())
+                return false;
+            try
+            {
+                job.step(ReportResponse(job, ConsoleManager::SubmitCommand(session, command, job.uid())));
+            }
+            catch (const exception& ex)
+            {
+                job.print(command + " 执行异常: " + string(ex.what()), Error);
+                job.step(false);
+            }
+            return true;
+        });
+    });
+    buffer("已提交后台任务 #" + to_string(id) + "：" + title + "（UID " + playerUid + "），可在 F.后台任务 中查看进度", Info);
+}
+
+/// 在后台任务中逐条提交随机主词条的遗器，每条完成后计入进度；取消后在下一条之前停止
+/// 整个任务共用一个已授权的会话
+static void RandomRelics(JobManager::Job& job,
+                         const SessionManager::Session& session,
+                         Relic::Type type,
                          int starRank,
                          const std::string& relicBaseId,
                          int partId,
@@ -111,21 +401,11 @@ inline void RandomRelics(Relic::Type type,
 {
     // 根据部位确定主词条范围
     int minTag = 1;
-    int maxTag = 1;
-        switch (partId) {
-            case 1: case 2: maxTag = 1; break;    // 头/手
-            case 3:         maxTag = 7; break;    // 躯
-            case 4:         maxTag = 4; break;    // 脚
-            case 5:         maxTag = 10; break;   // 位面球
-            case 6:         maxTag = 5;  break;   // 连接绳
-            default: throw std::invalid_argument("Invalid partId");
-        }
-
-    static thread_local std::mt19937 gen{ std::random_device{}() };
-    std::uniform_int_distribution<> dist(minTag, maxTag);
+    int maxTag = Relic::maxMainTag(partId);
+    if (maxTag == 0)
+        throw std::invalid_argument("Invalid partId");
 
-    for (int i = 0; i < count; ++i) {
-        std::string mainTag = std::to_string(dist(gen));
+    for (int i = 0; i < count && !job.cancelled(); ++i) {
         auto relic = Relic::Random(
             type,
             starRank,
@@ -136,23 +416,15 @@ inline void RandomRelics(Relic::Type type,
             subTag,
             level
         );
-            try
-            {
-                json resp = ConsoleManager::CommandRelic(relic, 1, ConsoleManager::playerUid);
-
-                if (!resp.contains("data") ||
-                    !resp["data"].contains("message"))
-                    throw runtime_error("响应数据格式错误，返回信息：" + resp["message"].get<string>());
-
-                auto mt = resp["message"].get<string>() == "Success"
-                            ? Success
-                            : Error;
-                buffer(SessionManager::base64Decode(resp["data"]["message"].get<string>()), mt);
-            }
-            catch (const exception& ex)
-            {
-                buffer("命令执行异常: " + string(ex.what()), Error);
-            }
+        try
+        {
+            job.step(ReportResponse(job, ConsoleManager::SubmitCommand(session, ConsoleManager::buildRelicCommand(relic, 1), job.uid())));
+        }
+        catch (const exception& ex)
+        {
+            job.print("命令执行异常: " + string(ex.what()), Error);
+            job.step(false);
+        }
     }
 }
 
@@ -160,14 +432,86 @@ inline void RandomRelics(Relic::Type type,
 //                          自定义物品与遗器
 ////////////////////////////////////////////////////////////////////////////////
 
+/// 是否为纯数字
+static bool isNumeric(const string& text)
+{
+    return !text.empty() && all_of(text.begin(), text.end(), [](unsigned char c) { return isdigit(c); });
+}
+
+/// 在物品表中校验物品 ID；未加载物品表时直接放行
+static bool checkItemId(const string& itemId)
+{
+    if (!ItemCatalogue::isLoaded())
+        return true;
+
+    CatalogueItem item;
+    if (!isNumeric(itemId) || itemId.size() > 9 || !ItemCatalogue::find(stoul(itemId), item))
+    {
+        buffer("物品ID不存在于物品表: " + itemId + "，已取消提交", Warn);
+        return false;
+    }
+    buffer("物品: " + string(item.name) + " (" + itemId + ")", Info);
+    return true;
+}
+
 /// A1. 读取并提交“普通物品”指令
 static void handleCustomItem()
 {
-    buffer("请依次输入: 物品ID 数量", Command);
+    buffer(ItemCatalogue::isLoaded()
+               ? "请依次输入: 物品ID(或名称前缀) 数量"
+               : "请依次输入: 物品ID 数量",
+           Command);
     string itemId = read();
+
+    // 输入的不是数字：按名称前缀搜索并列出候选
+    if (ItemCatalogue::isLoaded() && !isNumeric(itemId))
+    {
+        auto matches = ItemCatalogue::searchPrefix(itemId, 10);
+        if (matches.empty())
+        {
+            buffer("物品表中没有以 \"" + itemId + "\" 开头的物品", Warn);
+            return;
+        }
+        for (const auto& item : matches)
+            buffer(to_string(item.id) + "  " + string(item.name), Info);
+        if (matches.size() == 1)
+            itemId = to_string(matches.front().id);
+        else
+        {
+            buffer("请输入物品ID: ", Command);
+            itemId = read();
+        }
+    }
+
+    if (!checkItemId(itemId))
+        return;
     int    count  = readIntOrDefault(1);
 
-    ConsoleManager::CommandGive(itemId, count, playerUid);
+    SubmitCommandJob("给予物品 " + itemId + " x" + to_string(count), [itemId, count](const string& uid)
+                     { return ConsoleManager::CommandGive(itemId, count, uid); });
+}
+
+/// 提交前在本地校验遗器的部位、主词条范围与完整物品 ID
+static bool checkRelic(const Relic& relic)
+{
+    if (!Relic::isValidPart(relic.getType(), relic.getPartId()))
+    {
+        buffer(relic.getType() == Relic::Type::Tunnel
+                   ? "隧洞遗器部位ID应为 1–4"
+                   : "位面饰品部位ID应为 5–6",
+               Warn);
+        return false;
+    }
+
+    int maxTag = Relic::maxMainTag(relic.getPartId());
+    if (!isNumeric(relic.getMainTag()) || relic.getMainTag().size() > 3 ||
+        stoi(relic.getMainTag()) < 1 || stoi(relic.getMainTag()) > maxTag)
+    {
+        buffer("部位 " + to_string(relic.getPartId()) + " 的主词条ID应为 1–" + to_string(maxTag), Warn);
+        return false;
+    }
+
+    return checkItemId(relic.getId());
 }
 
 /// A2. 读取并提交“自定义遗器”指令
@@ -197,9 +541,15 @@ static void handleCustomRelic()
     // 数量
     int count = readIntOrDefault(1);
 
-    // 构造并提交遗器指令
+    // 构造、校验并提交遗器指令
     Relic relic(type, starRank, relicId, partId, mainTag, subTag, level);
-    ConsoleManager::CommandRelic(relic, count, playerUid);
+    if (!checkRelic(relic))
+    {
+        buffer("遗器参数校验未通过，已取消提交", Warn);
+        return;
+    }
+    SubmitCommandJob("遗器 " + relic.getId() + " x" + to_string(count), [relic, count](const string& uid)
+                     { return ConsoleManager::CommandRelic(relic, count, uid); });
 }
 
 /// A. 先选“普通物品”还是“自定义遗器”
@@ -238,23 +588,230 @@ static void handleRandomBundle(
         return;
     }
 
-    // 2) 按预设生成每个部位
-    for (auto& rc : it->second)
+    // 2) 按预设生成每个部位：对于位面饰品，部位从 5 开始；隧洞遗器仍从 1 开始
+    const vector<pair<int,int>> preset = it->second;
+    int startPart = (type == Relic::Type::Plane) ? 5 : 1;
+    // 间隔连续，结束部位 = 起始部位 + 部位数量 - 1
+    int endPart   = startPart + partCount - 1;
+    int total = 0;
+    for (auto& rc : preset)
+        total += rc.second * partCount;
+
+    // 3) 作为后台任务提交，菜单立即返回；任务记下当前 UID
+    string jobTitle = string(type == Relic::Type::Plane ? "随机位面饰品 " : "随机隧洞遗器 ") + rid;
+    int id = JobManager::submit(jobTitle, playerUid, [=](JobManager::Job& job)
+    {
+        job.setTotal(total);
+        const auto session = ConsoleManager::OpenSession();
+        for (auto& rc : preset)
+        {
+            int rarity = rc.first;
+            int cnt    = rc.second;
+            for (int part = startPart; part <= endPart && !job.cancelled(); ++part)
+                RandomRelics(job, session, type, rarity, rid, part, cnt);
+        }
+    });
+    buffer("已提交后台任务 #" + to_string(id) + "：" + jobTitle + "（" + to_string(total) +
+           " 条命令，UID " + playerUid + "），可在 F.后台任务 中查看进度", Info);
+}
+
+/// 模拟大量候选遗器，按权重方案挑出每个部位得分最高的若干件，确认后作为后台任务提交
+static void handleSimulatedRelics()
+{
+    char tc = askChoice("T.隧洞遗器  P.位面饰品", {'T','P'});
+    RelicSimulator::Options options;
+    options.type = tc == 'P' ? Relic::Type::Plane : Relic::Type::Tunnel;
+
+    buffer("请输入遗器ID（两位）：", Command);
+    options.relicId = read();
+    if (options.relicId.size() != 2 || !isNumeric(options.relicId))
+    {
+        buffer("遗器ID应为两位数字", Warn);
+        return;
+    }
+    buffer("每个部位保留几件（默认 5）：", Command);
+    options.top = static_cast<size_t>(max(1, min(readIntOrDefault(5), 100)));
+    buffer("随机种子（直接回车随机生成，填写相同种子可复现结果）：", Command);
+    string seedText = read();
+    options.seed = isNumeric(seedText) && seedText.size() < 20 ? stoull(seedText)
+                                                                : (uint64_t(random_device{}()) << 32) | random_device{}();
+    options.candidates = config.value("relic_sim_candidates", uint64_t(1000000));
+    options.threads = ConfigThreadCount(config, "relic_sim_threads", 0, 0);
+
+    // 权重方案：配置 relic_profiles 中按名称选择，未配置时使用内置的暴击向方案
+    string profileName = "默认";
+    if (config.contains("relic_profiles") && config["relic_profiles"].is_object() && !config["relic_profiles"].empty())
     {
-        int rarity = rc.first;
-        int cnt    = rc.second;
+        string names;
+        for (const auto& item : config["relic_profiles"].items())
+            names += " " + item.key();
+        buffer("权重方案:" + names + "（直接回车使用第一个）", Command);
+        profileName = read();
+        if (profileName.empty())
+            profileName = config["relic_profiles"].begin().key();
+        if (!config["relic_profiles"].contains(profileName))
+        {
+            buffer("没有权重方案 " + profileName, Warn);
+            return;
+        }
+        options.profile = RelicSimulator::Profile::fromJson(config["relic_profiles"][profileName]);
+    }
+
+    const int firstPart = options.type == Relic::Type::Plane ? 5 : 1;
+    const int lastPart  = options.type == Relic::Type::Plane ? 6 : 4;
+    vector<Relic> relics;
+    for (int part = firstPart; part <= lastPart; ++part)
+    {
+        options.partId = part;
+        RelicSimulator::Result result = RelicSimulator::run(options);
+        char header[128];
+        snprintf(header, sizeof(header), "部位 %d：%llu 件候选，用时 %.0f 毫秒", part,
+                 static_cast<unsigned long long>(options.candidates), result.seconds * 1000);
+        buffer(header, Info);
+        for (const auto& candidate : result.best)
+        {
+            string subs;
+            for (int i = 0; i < candidate.subCount; ++i)
+                subs += string(" ") + RelicSimulator::statName(RelicSimulator::subStat(candidate.subIds[i])) +
+                        "×" + to_string(candidate.rolls[i]);
+            char score[32];
+            snprintf(score, sizeof(score), "%.2f", candidate.score);
+            buffer(string("  ") + score + "  " +
+                   RelicSimulator::statName(RelicSimulator::mainStat(part, candidate.mainTag)) + " |" + subs, Info);
+            relics.push_back(candidate.toRelic(options));
+        }
+    }
+
+    buffer("种子 " + to_string(options.seed) + "，权重方案 " + profileName, Info);
+    if (askChoice("提交以上 " + to_string(relics.size()) + " 件遗器？Y.提交  N.取消", {'Y','N'}) != 'Y')
+        return;
+
+    string title = "精选遗器 " + options.relicId + " ×" + to_string(relics.size());
+    int id = JobManager::submit(title, playerUid, [relics](JobManager::Job& job)
+    {
+        job.setTotal(static_cast<int>(relics.size()));
+        const auto session = ConsoleManager::OpenSession();
+        for (const auto& relic : relics)
+        {
+            if (job.cancelled())
+                break;
+            try
+            {
+                job.step(ReportResponse(job, ConsoleManager::SubmitCommand(session, ConsoleManager::buildRelicCommand(relic, 1), job.uid())));
+            }
+            catch (const exception& ex)
+            {
+                job.print("命令执行异常: " + string(ex.what()), Error);
+                job.step(false);
+            }
+        }
+    });
+    buffer("已提交后台任务 #" + to_string(id) + "：" + title + "（UID " + playerUid + "）", Info);
+}
+
+/// 背包补齐：读取期望背包规格，在后台任务中查询玩家当前持有量，只给予缺少的部分
+static void handleReconcile()
+{
+    const string defaultSpec = config.value("inventory_spec", string());
+    buffer(defaultSpec.empty() ? "请输入背包规格文件路径："
+                               : "请输入背包规格文件路径（直接回车使用 " + defaultSpec + "）：",
+           Command);
+    string specPath = read();
+    if (specPath.empty())
+        specPath = defaultSpec;
+    if (specPath.empty())
+        return;
 
-        // 对于位面饰品，部位从 5 开始；隧洞遗器仍从 1 开始
-        int startPart = (type == Relic::Type::Plane) ? 5 : 1;
-        // 间隔连续，结束部位 = 起始部位 + 部位数量 - 1
-        int endPart   = startPart + partCount - 1;
+    auto desired = make_shared<InventoryReconciler::Counts>();
+    try
+    {
+        *desired = InventoryReconciler::loadSpec(specPath);
+    }
+    catch (const exception& e)
+    {
+        buffer(e.what(), Error);
+        return;
+    }
 
-        for (int part = startPart; part <= endPart; ++part)
+    // 已加载物品表时先在本地校验全部物品ID
+    if (ItemCatalogue::isLoaded())
+    {
+        vector<uint32_t> unknown;
+        CatalogueItem item;
+        for (const auto& entry : *desired)
+            if (!ItemCatalogue::find(entry.first, item))
+                unknown.push_back(entry.first);
+        if (!unknown.empty())
         {
-            RandomRelics(type, rarity, rid, part, cnt);
+            sort(unknown.begin(), unknown.end());
+            string ids;
+            for (size_t i = 0; i < unknown.size() && i < 10; ++i)
+                ids += " " + to_string(unknown[i]);
+            buffer("背包规格中有 " + to_string(unknown.size()) + " 个物品ID不存在于物品表:" + ids +
+                   (unknown.size() > 10 ? " ……" : "") + "，已取消提交", Warn);
+            return;
         }
     }
 
+    // 物品列表字段与标量字段（如 credit、jade）对应的物品ID，可在配置 inventory_list_fields、inventory_scalar_fields 中覆盖
+    auto fields = InventoryReconciler::defaultFields();
+    if (config.contains("inventory_list_fields") && config["inventory_list_fields"].is_array())
+    {
+        fields.lists.clear();
+        for (const auto& name : config["inventory_list_fields"])
+            if (name.is_string())
+                fields.lists.push_back(name.get<string>());
+    }
+    if (config.contains("inventory_scalar_fields") && config["inventory_scalar_fields"].is_object())
+    {
+        fields.scalars.clear();
+        for (const auto& item : config["inventory_scalar_fields"].items())
+            if (item.value().is_number_unsigned())
+                fields.scalars[item.key()] = item.value().get<uint32_t>();
+    }
+    // give 的数量为 int，超过时拆成多条
+    const int64_t maxPerCommand = min(config.value("give_max_count", int64_t(numeric_limits<int>::max())),
+                                      int64_t(numeric_limits<int>::max()));
+
+    const string title = "背包补齐 " + fs::path(specPath).filename().string();
+    int id = JobManager::submit(title, playerUid, [desired, fields, maxPerCommand](JobManager::Job& job)
+    {
+        const auto session = ConsoleManager::OpenSession();
+        json response = SessionManager::parseResponse(SessionManager::GetPlayerInfoRaw(session, job.uid()));
+        if (response.value("message", string()) != "Success" || !response.contains("data"))
+            throw runtime_error("查询玩家信息失败，返回信息：" + response.value("message", string()));
+
+        // 持有量不明的物品一律不给，避免把未识别的背包当成空背包而重复给予
+        const auto current = InventoryReconciler::parseHoldings(response["data"], fields);
+        const auto plan = InventoryReconciler::diff(*desired, current, maxPerCommand);
+        if (plan.unknownItems == plan.wantedItems && plan.wantedItems > 0)
+            throw runtime_error("玩家信息中没有物品列表（inventory_list_fields），无法确定持有量，已取消");
+        if (plan.unknownItems > 0)
+            job.print("玩家信息中没有物品列表，只补齐标量字段对应的物品，其余 " + to_string(plan.unknownItems) +
+                      " 种持有量未知，未给予", Warn);
+        job.print("规格 " + to_string(plan.wantedItems) + " 种 " + to_string(plan.wantedCount) + " 件，已满足 " +
+                  to_string(plan.satisfiedItems) + " 种；需补 " + to_string(plan.missingCount) + " 件，共 " +
+                  to_string(plan.gives.size()) + " 条命令", Info);
+
+        job.setTotal(static_cast<int>(plan.gives.size()));
+        for (const auto& give : plan.gives)
+        {
+            if (job.cancelled())
+                break;
+            const string command = ConsoleManager::buildGiveCommand(to_string(give.id), static_cast<int>(give.count));
+            try
+            {
+                job.step(ReportResponse(job, ConsoleManager::SubmitCommand(session, command, job.uid())));
+            }
+            catch (const exception& ex)
+            {
+                job.print(command + " 执行异常: " + string(ex.what()), Error);
+                job.step(false);
+            }
+        }
+    });
+    buffer("已提交后台任务 #" + to_string(id) + "：" + title + "（规格 " + to_string(desired->size()) +
+           " 种物品，UID " + playerUid + "），可在 F.后台任务 中查看进度", Info);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -264,8 +821,8 @@ static void handleRandomBundle(
 static void GetItemMenu()
 {
     char choice = askChoice(
-        "A.自定义  B.随机位面饰品  C.随机隧洞遗器",
-        {'A','B','C'}
+        "A.自定义  B.随机位面饰品  C.随机隧洞遗器  D.模拟精选遗器  E.背包补齐",
+        {'A','B','C','D','E'}
     );
 
     try
@@ -307,6 +864,14 @@ static void GetItemMenu()
                 );
                 break;
             }
+
+            case 'D': // 模拟精选遗器
+                handleSimulatedRelics();
+                break;
+
+            case 'E': // 背包补齐
+                handleReconcile();
+                break;
         }
     }
     catch (const exception& ex)
@@ -315,15 +880,353 @@ static void GetItemMenu()
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//                              备份管理
+////////////////////////////////////////////////////////////////////////////////
+
+/// Unix 时间格式化为本地时间 "YYYY-MM-DD HH:MM:SS"
+static string formatTime(int64_t seconds)
+{
+    time_t t = static_cast<time_t>(seconds);
+    tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &t);
+#else
+    localtime_r(&t, &local);
+#endif
+    char text[32];
+    strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &local);
+    return text;
+}
+
+/// 并行校验某个任务的全部槽位，列出结果，并可选择一个槽位原子恢复
+static void BackupMenu()
+{
+    vector<BackupJob::Options> jobs = AutoSaver::jobList();
+    if (jobs.empty())
+    {
+        buffer("没有已注册的备份任务", Warn);
+        return;
+    }
+
+    int jobId = 0;
+    if (jobs.size() > 1)
+    {
+        string prompt;
+        vector<char> allowed;
+        for (size_t i = 0; i < jobs.size() && i < 26; ++i)
+        {
+            char key = static_cast<char>('A' + i);
+            prompt += string(1, key) + "." + jobs[i].name + "  ";
+            allowed.push_back(key);
+        }
+        jobId = askChoice(prompt, allowed) - 'A';
+    }
+    const BackupJob::Options& job = jobs[jobId];
+
+    if (askChoice("A.立即保存  B.校验与恢复", {'A','B'}) == 'A')
+    {
+        // 只唤醒调度线程，不等待保存完成；结果照常输出，也可在 I.仪表盘 查看
+        AutoSaver::triggerSaveNow(jobId);
+        buffer("已请求立即保存 [" + job.name + "]（源自上次保存后未变化时跳过）", Info);
+        return;
+    }
+
+    buffer("正在校验 [" + job.name + "] 的 " + to_string(job.slotCount) + " 个槽位……", Info);
+    auto startTime = chrono::steady_clock::now();
+    vector<BackupManager::SlotStatus> slots;
+    AutoSaver::withJob(jobId, [&](BackupJob& target) { slots = BackupManager::verifyAll(target.options()); });
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+    int recommended = BackupManager::newestValid(slots);
+    for (const auto& status : slots)
+    {
+        string line = "#" + to_string(status.slot) + "  ";
+        if (!status.hasManifest)
+        {
+            buffer(line + "（空或未记录）", Info);
+            continue;
+        }
+        char size[32];
+        snprintf(size, sizeof(size), "%.1f MiB", status.manifest.sourceSize / (1024.0 * 1024.0));
+        line += formatTime(status.manifest.savedAt) + "  " + size + "  " + status.manifest.mode + "  ";
+        if (status.valid)
+            buffer(line + "校验通过" + (status.slot == recommended ? "（最新可用）" : ""), Success);
+        else
+            buffer(line + "校验失败：" + status.error, Error);
+    }
+    char elapsed[64];
+    snprintf(elapsed, sizeof(elapsed), "校验用时 %.2f 秒", seconds);
+    buffer(elapsed, Info);
+
+    if (recommended < 0)
+    {
+        buffer("没有可恢复的槽位", Warn);
+        return;
+    }
+
+    buffer("输入要恢复的槽位编号（直接回车恢复 #" + to_string(recommended) + "，输入 Q 返回）：", Command);
+    string input = read();
+    if (!input.empty() && toupper(static_cast<unsigned char>(input[0])) == 'Q')
+        return;
+    int slot = input.empty() || !isNumeric(input) ? recommended : stoi(input);
+    auto chosen = find_if(slots.begin(), slots.end(), [slot](const auto& status) { return status.slot == slot; });
+    if (chosen == slots.end() || !chosen->valid)
+    {
+        buffer("槽位 #" + to_string(slot) + " 不可用", Error);
+        return;
+    }
+
+    if (askChoice("将用槽位 #" + to_string(slot) + " 覆盖 " + job.source.string() +
+                  "，请先停止 DanhengServer。Y.确认  N.取消", {'Y','N'}) != 'Y')
+        return;
+
+    string error;
+    bool restored = false;
+    startTime = chrono::steady_clock::now();
+    AutoSaver::withJob(jobId, [&](BackupJob& target) { restored = BackupManager::restore(target.options(), slot, error); });
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+    if (!restored)
+    {
+        buffer("恢复失败：" + error, Error);
+        return;
+    }
+    snprintf(elapsed, sizeof(elapsed), "（%.2f 秒）", seconds);
+    buffer("已从槽位 #" + to_string(slot) + " 恢复 " + job.source.string() + elapsed, Success);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//                              后台任务
+////////////////////////////////////////////////////////////////////////////////
+
+/// 列出后台任务的进度与吞吐，可取消排队中或运行中的任务
+static void JobsMenu()
+{
+    vector<JobManager::Info> jobs = JobManager::list();
+    if (jobs.empty())
+    {
+        buffer("没有后台任务", Info);
+        return;
+    }
+
+    bool active = false;
+    for (const auto& job : jobs)
+    {
+        char line[256];
+        snprintf(line, sizeof(line), "#%d  %s  UID %s  %s  %d/%d  失败 %d  %.1f 秒  %.1f 条/秒",
+                 job.id, job.title.c_str(), job.uid.c_str(), JobManager::stateName(job.state),
+                 job.done, job.total, job.failed, job.seconds, job.perSecond);
+
+        MessageType type = Info;
+        if (job.state == JobManager::State::Done)
+            type = job.failed == 0 ? Success : Warn;
+        else if (job.state == JobManager::State::Cancelled)
+            type = Warn;
+        else if (job.state == JobManager::State::Failed)
+            type = Error;
+        else
+            active = true;
+        buffer(line, type);
+    }
+    if (!active)
+        return;
+
+    buffer("输入任务编号取消该任务，输入 A 取消全部，直接回车返回：", Command);
+    string input = read();
+    if (input.empty())
+        return;
+    if (toupper(static_cast<unsigned char>(input[0])) == 'A')
+    {
+        buffer("已请求取消 " + to_string(JobManager::cancelAll()) + " 个任务", Warn);
+        return;
+    }
+    if (isNumeric(input) && input.size() < 9 && JobManager::cancel(stoi(input)))
+        buffer("已请求取消任务 #" + input + "，当前这条命令完成后停止", Warn);
+    else
+        buffer("没有可取消的任务 #" + input, Warn);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//                              玩家监视
+////////////////////////////////////////////////////////////////////////////////
+
+/// 开启或停止玩家监视；监视期间只输出各玩家信息的变化
+static void WatchMenu()
+{
+    if (PlayerWatcher::running())
+    {
+        string uids;
+        for (const auto& uid : PlayerWatcher::watchedUids())
+            uids += " " + uid;
+        buffer("正在监视:" + uids, Info);
+        if (askChoice("S.停止监视  Q.返回", {'S','Q'}) == 'S')
+        {
+            PlayerWatcher::stop();
+            buffer("已停止监视", Info);
+        }
+        return;
+    }
+
+    buffer("请输入要监视的 UID，以空格分隔（直接回车监视当前 UID " + playerUid + "）：", Command);
+    PlayerWatcher::Options options;
+    istringstream input(read());
+    string uid;
+    while (input >> uid)
+        if (find(options.uids.begin(), options.uids.end(), uid) == options.uids.end())
+            options.uids.push_back(uid);
+    if (options.uids.empty())
+        options.uids.push_back(playerUid);
+
+    options.intervalSeconds = config.value("watch_interval", 5);
+    options.threads = ConfigThreadCount(config, "watch_threads", 4);
+    PlayerWatcher::start(options);
+    buffer("开始监视 " + to_string(options.uids.size()) + " 名玩家，每 " + to_string(options.intervalSeconds) +
+           " 秒查询一次，只输出变化；再次进入 G.玩家监视 可停止", Success);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//                              玩家导出
+////////////////////////////////////////////////////////////////////////////////
+
+/// 把一段 UID 的玩家信息导出为列式文件，作为后台任务并发查询
+static void ExportMenu()
+{
+    buffer("请输入要导出的 UID 范围（如 10001-20000）：", Command);
+    const string range = read();
+    PlayerExport::Options options;
+    const size_t dash = range.find('-');
+    const string first = range.substr(0, dash);
+    const string last = dash == string::npos ? first : range.substr(dash + 1);
+    if (!isNumeric(first) || !isNumeric(last) || first.size() > 12 || last.size() > 12 ||
+        stoll(last) < stoll(first) || stoll(last) - stoll(first) >= numeric_limits<int>::max())
+    {
+        buffer("UID 范围无效: " + range, Warn);
+        return;
+    }
+    options.firstUid = stoll(first);
+    options.lastUid = stoll(last);
+
+    const string defaultPath = "players_" + first + "_" + last + ".dhpx";
+    buffer("导出文件（直接回车使用 " + defaultPath + "）：", Command);
+    const string path = read();
+    options.path = path.empty() ? defaultPath : path;
+    options.threads = ConfigThreadCount(config, "export_threads", 8);
+    options.groupRows = config.value("export_group_rows", size_t(4096));
+
+    const int count = static_cast<int>(options.lastUid - options.firstUid + 1);
+    const string title = "导出玩家 " + first + "-" + last;
+    int id = JobManager::submit(title, playerUid, [options, count](JobManager::Job& job)
+    {
+        job.setTotal(count);
+        const auto stats = PlayerExport::exportRange(options, [&job](bool ok)
+        {
+            job.step(ok);
+            return !job.cancelled();
+        });
+
+        char summary[256];
+        snprintf(summary, sizeof(summary), "%llu 名玩家写入 %s，%.1f KiB（响应 JSON 共 %.1f KiB），用时 %.1f 秒",
+                 static_cast<unsigned long long>(stats.rows), options.path.string().c_str(),
+                 stats.fileBytes / 1024.0, stats.rawBytes / 1024.0, stats.seconds);
+        job.print(summary, stats.cancelled ? Warn : Success);
+        if (stats.failed > 0)
+            job.print(to_string(stats.failed) + " 个 UID 查询失败，未写入（首个错误：" + stats.firstError + "）", Warn);
+    });
+    buffer("已提交后台任务 #" + to_string(id) + "：" + title + "，可在 F.后台任务 中查看进度", Info);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//                              压力测试
+////////////////////////////////////////////////////////////////////////////////
+
+/// 对 MUIP 接口压测，输出吞吐、延迟百分位与错误分布
+static void LoadTestMenu()
+{
+    LoadTester::Options options;
+    char target = askChoice("压测接口：A.exec_cmd  B.player_information  C.server_information", {'A','B','C'});
+    options.target = target == 'A' ? LoadTester::Target::ExecCommand
+                   : target == 'B' ? LoadTester::Target::PlayerInformation
+                                   : LoadTester::Target::ServerInformation;
+    options.uid = playerUid;
+    if (options.target == LoadTester::Target::ExecCommand)
+    {
+        buffer("请输入要反复执行的命令（直接回车为 help）：", Command);
+        string cmd = read();
+        if (!cmd.empty())
+            options.command = cmd;
+    }
+
+    char mode = askChoice("O.开环（固定到达率）  C.闭环（固定并发）", {'O','C'});
+    options.mode = mode == 'O' ? LoadTester::Mode::Open : LoadTester::Mode::Closed;
+    if (options.mode == LoadTester::Mode::Open)
+    {
+        buffer("每秒请求数（默认 100）：", Command);
+        options.rate = max(1, readIntOrDefault(100));
+        buffer("最大并发连接数（默认 64）：", Command);
+        options.connections = static_cast<unsigned>(max(1, min(readIntOrDefault(64), 1024)));
+    }
+    else
+    {
+        buffer("并发连接数（默认 16）：", Command);
+        options.connections = static_cast<unsigned>(max(1, min(readIntOrDefault(16), 1024)));
+    }
+    buffer("持续秒数（默认 10）：", Command);
+    options.durationSeconds = max(1, min(readIntOrDefault(10), 3600));
+
+    if (askChoice("将对 " + config.at("dispatchUrl").get<string>() + " 发起压测，请确认是测试服务器。Y.开始  N.取消", {'Y','N'}) != 'Y')
+        return;
+
+    LoadTester::Report report;
+    try
+    {
+        const auto session = ConsoleManager::OpenSession();
+        report = LoadTester::run(session, options, [](int second, uint64_t completed, uint64_t failed)
+        {
+            buffer("第 " + to_string(second) + " 秒：" + to_string(completed) + " 个响应" +
+                   (failed ? "，错误 " + to_string(failed) : string()), Info);
+        });
+    }
+    catch (const exception& e)
+    {
+        buffer(string("压测失败: ") + e.what(), Error);
+        return;
+    }
+
+    char line[256];
+    snprintf(line, sizeof(line), "%s %s：%llu 个请求，成功 %llu，%.1f 秒，吞吐 %.1f 请求/秒（成功 %.1f/秒）",
+             LoadTester::targetName(options.target), options.mode == LoadTester::Mode::Open ? "开环" : "闭环",
+             static_cast<unsigned long long>(report.sent), static_cast<unsigned long long>(report.succeeded),
+             report.seconds, report.sent / report.seconds, report.succeeded / report.seconds);
+    buffer(line, report.errors.empty() ? Success : Warn);
+
+    auto printLatency = [&line](const char* title, const LatencyHistogram& h)
+    {
+        auto ms = [](uint64_t us) { return us / 1000.0; };
+        snprintf(line, sizeof(line), "%s（毫秒）：p50 %.2f  p90 %.2f  p99 %.2f  p999 %.2f  最大 %.2f  平均 %.2f", title,
+                 ms(h.percentile(50)), ms(h.percentile(90)), ms(h.percentile(99)), ms(h.percentile(99.9)),
+                 ms(h.max()), h.mean() / 1000.0);
+        buffer(line, Info);
+    };
+    if (options.mode == LoadTester::Mode::Open)
+        printLatency("延迟（自排定发出时刻起）", report.latency);
+    else
+    {
+        printLatency("服务时间", report.latency);
+        printLatency("校正协调遗漏后", report.corrected);
+    }
+    for (const auto& error : report.errors)
+        buffer("  " + error.first + "：" + to_string(error.second) + " 次", Error);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //                               主函数
 ////////////////////////////////////////////////////////////////////////////////
 
 int main()
 {
-    // 设为 UTF-8 控制台
-    SetConsoleOutputCP(CP_UTF8);
-    SetConsoleCP(CP_UTF8);
+    // 初始化终端（Windows 控制台 UTF-8 / POSIX termios）
+    TerminalBackend::init();
 
     buffer("欢迎使用 DanhengServer-Console！", Info);
     buffer("仅供学习交流，请勿用于商业用途", Info);
@@ -337,18 +1240,33 @@ int main()
     }
 
     // 启动 IO 管理
+    ConfigureOutput();
     ConsoleOutputManager::start();
 
+    // 命令历史
+    OpenCommandHistory();
+
+    // 物品表索引
+    LoadItemCatalogue();
+
     // 自动保存
     StartAutoSave();
 
+    // 指标导出
+    StartMetricsExport();
+
+    // 后台任务：curl 全局初始化须在工作线程发请求之前完成
+    SessionManager::initialize();
+    JobManager::start(ConfigThreadCount(config, "job_workers", 4));
+    StartControlSocket();
+
     // 主循环
     while (true)
     {
         buffer("当前玩家UID: " + playerUid, Info);
-        buffer("A.获取物品  B.自定义指令  C.设置UID  D.退出", Command);
+        buffer("A.获取物品  B.自定义指令  C.设置UID  D.退出  E.备份管理  F.后台任务  G.玩家监视  H.压力测试  I.仪表盘  J.运行指标  K.导出玩家", Command);
 
-        char c = askChoice("", {'A','B','C','D'});
+        char c = askChoice("", {'A','B','C','D','E','F','G','H','I','J','K'});
         switch (c)
         {
             case 'A':
@@ -359,23 +1277,13 @@ int main()
             {
                 buffer("请输入要执行的命令: ", Command);
                 string cmd = read();
-                try
-                {
-                    json resp = ConsoleManager::SubmitCommand(cmd, playerUid);
-
-                    if (!resp.contains("data") ||
-                        !resp["data"].contains("message"))
-                        throw runtime_error("响应数据格式错误，返回信息：" + resp["message"].get<string>());
-
-                    auto mt = resp["message"].get<string>() == "Success"
-                                ? Success
-                                : Error;
-                    buffer(SessionManager::base64Decode(resp["data"]["message"].get<string>()), mt);
-                }
-                catch (const exception& ex)
+                if (cmd.find('{') != string::npos)
                 {
-                    buffer("命令执行异常: " + string(ex.what()), Error);
+                    SubmitTemplateJob(cmd);
+                    break;
                 }
+                SubmitCommandJob("命令 " + cmd, [cmd](const string& uid)
+                                 { return ConsoleManager::SubmitCommand(cmd, uid); });
                 break;
             }
 
@@ -385,8 +1293,48 @@ int main()
                 buffer("玩家UID已更新为: " + playerUid, Info);
                 break;
 
+            case 'E':
+                BackupMenu();
+                break;
+
+            case 'F':
+                JobsMenu();
+                break;
+
+            case 'G':
+                WatchMenu();
+                break;
+
+            case 'H':
+                LoadTestMenu();
+                break;
+
+            case 'I':
+            {
+                Dashboard::Options options;
+                options.fps = config.value("dashboard_fps", 4);
+                options.statusIntervalSeconds = config.value("dashboard_status_interval", 5);
+                if (!Dashboard::run(options))
+                    buffer("仪表盘需要在交互式终端中运行", Warn);
+                break;
+            }
+
+            case 'J':
+                MetricsMenu();
+                break;
+
+            case 'K':
+                ExportMenu();
+                break;
+
             default:  // 'D' 退出
                 buffer("程序退出中……", Info);
+                ControlServer::stop();
+                PlayerWatcher::stop();
+                JobManager::stop();
+                AutoSaver::stop();
+                Metrics::stopExport(); // 退出前最后写一次
+                ConsoleOutputManager::stop();
                 return 0;
         }
     }
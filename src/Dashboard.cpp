@@ -0,0 +1,510 @@
+#include "Dashboard.hpp"
+#include "ConsoleInputManager.hpp"
+#include "ConsoleManager.hpp"
+#include "PlayerWatcher.hpp"
+#include "SessionManager.hpp"
+#include "TerminalBackend.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    using Style = ScreenBuffer::Style;
+
+    constexpr long RequestTimeoutMs = 3000;
+
+    // 仪表盘自己的请求：有超时、失败时不经 buffer() 报错（错误显示在状态栏里）
+    json request(const std::string &serverUrl, const char *path, const std::string &body)
+    {
+        const SessionManager::Response response = SessionManager::postOnce(serverUrl, path, body, RequestTimeoutMs);
+        if (!response.transportError.empty())
+            throw std::runtime_error(response.transportError);
+        if (response.httpStatus != 200)
+            throw std::runtime_error("HTTP " + std::to_string(response.httpStatus));
+        json parsed = json::parse(response.body, nullptr, false);
+        if (parsed.is_discarded() || !parsed.is_object())
+            throw std::runtime_error("响应无法解析");
+        const std::string message = parsed.value("message", std::string());
+        if (message != "Success")
+            throw std::runtime_error("返回 " + message);
+        return parsed.value("data", json::object());
+    }
+
+    // 后台线程按间隔查询服务器状态，会话失效或出错后下一轮重新建立
+    class StatusPoller
+    {
+    public:
+        explicit StatusPoller(int intervalSeconds)
+            : interval(std::max(intervalSeconds, 1)), worker([this]
+                                                           { run(); })
+        {
+        }
+
+        ~StatusPoller()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            notifier.notify_all();
+            worker.join();
+        }
+
+        void refresh()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                refreshRequested = true;
+            }
+            notifier.notify_all();
+        }
+
+        void fill(Dashboard::Snapshot &snapshot)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            snapshot.statusKnown = known;
+            snapshot.statusOk = ok;
+            snapshot.statusError = error;
+            snapshot.status = data;
+            snapshot.statusLatencyMs = latencyMs;
+            snapshot.statusAgeSeconds = known ? static_cast<int>(std::chrono::duration_cast<std::chrono::seconds>(
+                                                                     Clock::now() - finishedAt)
+                                                                     .count())
+                                              : 0;
+        }
+
+    private:
+        void run()
+        {
+            const std::string serverUrl = ConsoleManager::config.value("dispatchUrl", std::string());
+            const std::string adminKey = ConsoleManager::config.value("adminKey", std::string());
+            std::unique_ptr<SessionManager::Session> session;
+
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping)
+            {
+                lock.unlock();
+                json result;
+                std::string failure;
+                const auto started = Clock::now();
+                try
+                {
+                    if (!session)
+                    {
+                        const json created = request(serverUrl, "/muip/create_session", SessionManager::buildCreateSessionBody());
+                        session = std::make_unique<SessionManager::Session>(SessionManager::Session{
+                            serverUrl, created.at("sessionId").get<std::string>(), created.at("rsaPublicKey").get<std::string>()});
+                        request(serverUrl, "/muip/auth_admin",
+                                SessionManager::buildAuthorizeBody(session->sessionId, session->rsaPublicKey, adminKey));
+                    }
+                    result = request(serverUrl, "/muip/server_information", SessionManager::buildServerStatusBody(session->sessionId));
+                }
+                catch (const std::exception &e)
+                {
+                    failure = e.what();
+                    session.reset();
+                }
+                const auto finished = Clock::now();
+                lock.lock();
+
+                known = true;
+                ok = failure.empty();
+                error = failure;
+                if (ok)
+                {
+                    data = std::move(result);
+                    latencyMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(finished - started).count());
+                }
+                finishedAt = finished;
+                refreshRequested = false;
+                notifier.wait_for(lock, std::chrono::seconds(interval), [this]
+                                  { return stopping || refreshRequested; });
+            }
+        }
+
+        const int interval;
+        std::mutex mutex;
+        std::condition_variable notifier;
+        bool stopping = false;
+        bool refreshRequested = false;
+        bool known = false;
+        bool ok = false;
+        std::string error;
+        json data;
+        int latencyMs = 0;
+        Clock::time_point finishedAt;
+        std::thread worker; // 最后构造：线程启动时其余成员均已初始化
+    };
+
+    std::string formatBytes(std::uint64_t bytes)
+    {
+        char text[32];
+        if (bytes >= 1024ull * 1024 * 1024)
+            std::snprintf(text, sizeof(text), "%.1f GiB", bytes / (1024.0 * 1024 * 1024));
+        else if (bytes >= 1024 * 1024)
+            std::snprintf(text, sizeof(text), "%.1f MiB", bytes / (1024.0 * 1024));
+        else if (bytes >= 1024)
+            std::snprintf(text, sizeof(text), "%.1f KiB", bytes / 1024.0);
+        else
+            std::snprintf(text, sizeof(text), "%llu B", static_cast<unsigned long long>(bytes));
+        return text;
+    }
+
+    std::string formatClock(std::time_t time, const char *format)
+    {
+        std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &time);
+#else
+        localtime_r(&time, &local);
+#endif
+        char text[32];
+        std::strftime(text, sizeof(text), format, &local);
+        return text;
+    }
+
+    // 分节标题：整行横线，左侧嵌入标题
+    void section(ScreenBuffer &screen, int y, const std::string &title)
+    {
+        screen.fill(0, y, screen.cols(), U'─', Style::Gray);
+        screen.put(2, y, " " + title + " ", Style::Bold);
+    }
+
+    // 依次写入若干段文字，返回行尾位置
+    struct Line
+    {
+        ScreenBuffer &screen;
+        int x;
+        int y;
+
+        Line &add(const std::string &text, std::uint8_t style = Style::Plain)
+        {
+            x += screen.put(x, y, text, style);
+            return *this;
+        }
+    };
+
+    std::uint8_t messageStyle(MessageType type)
+    {
+        switch (type)
+        {
+        case MessageType::Success:
+            return Style::Green;
+        case MessageType::Error:
+            return Style::Red;
+        case MessageType::Warning:
+            return Style::Yellow;
+        case MessageType::Info:
+            return Style::Cyan;
+        default:
+            return Style::Plain;
+        }
+    }
+
+    const char *messagePrefix(MessageType type)
+    {
+        switch (type)
+        {
+        case MessageType::Success:
+            return "[SUCCESS] ";
+        case MessageType::Error:
+            return "[ERROR] ";
+        case MessageType::Warning:
+            return "[WARN] ";
+        case MessageType::Info:
+            return "[INFO] ";
+        case MessageType::Command:
+            return "[Command] ";
+        default:
+            return "";
+        }
+    }
+
+    std::uint8_t jobStyle(const JobManager::Info &job)
+    {
+        switch (job.state)
+        {
+        case JobManager::State::Running:
+            return Style::Cyan;
+        case JobManager::State::Done:
+            return job.failed == 0 ? Style::Green : Style::Yellow;
+        case JobManager::State::Cancelled:
+            return Style::Yellow;
+        case JobManager::State::Failed:
+            return Style::Red;
+        default:
+            return Style::Gray;
+        }
+    }
+
+    void renderJobs(const Dashboard::Snapshot &s, ScreenBuffer &screen, int y, int lines)
+    {
+        if (s.jobs.empty())
+        {
+            screen.put(2, y, "没有后台任务", Style::Gray);
+            return;
+        }
+        // 排队与运行中的任务在前，其后是最近结束的，各自按编号从新到旧
+        std::vector<const JobManager::Info *> order;
+        for (auto it = s.jobs.rbegin(); it != s.jobs.rend(); ++it)
+            if (it->state == JobManager::State::Running || it->state == JobManager::State::Queued)
+                order.push_back(&*it);
+        for (auto it = s.jobs.rbegin(); it != s.jobs.rend(); ++it)
+            if (it->state != JobManager::State::Running && it->state != JobManager::State::Queued)
+                order.push_back(&*it);
+
+        const int barWidth = screen.cols() >= 100 ? 20 : 10;
+        for (int i = 0; i < lines && i < static_cast<int>(order.size()); ++i)
+        {
+            const JobManager::Info &job = *order[i];
+            Line line{screen, 2, y + i};
+            line.add("#" + std::to_string(job.id) + " ", Style::Bold)
+                .add(JobManager::stateName(job.state), jobStyle(job))
+                .add("  ");
+            if (job.total > 0)
+            {
+                const int filled = static_cast<int>(static_cast<long long>(job.done) * barWidth / job.total);
+                line.add(std::string(filled, '#'), jobStyle(job))
+                    .add(std::string(barWidth - filled, '.'), Style::Gray);
+            }
+            char stats[96];
+            std::snprintf(stats, sizeof(stats), " %d/%d  失败 %d  %.1f 秒  %.1f 条/秒  UID %s  ",
+                          job.done, job.total, job.failed, job.seconds, job.perSecond, job.uid.c_str());
+            line.add(stats).add(job.title, Style::Gray);
+        }
+    }
+
+    void renderAutosave(const Dashboard::Snapshot &s, ScreenBuffer &screen, int y, int lines)
+    {
+        if (s.autosave.empty())
+        {
+            screen.put(2, y, "未配置自动保存", Style::Gray);
+            return;
+        }
+        for (int i = 0; i < lines && i < static_cast<int>(s.autosave.size()); ++i)
+        {
+            const AutoSaver::Status &job = s.autosave[i];
+            Line line{screen, 2, y + i};
+            line.add(job.name + "  ", Style::Bold);
+            if (job.saving)
+                line.add("保存中", Style::Cyan);
+            else if (job.dirty)
+                line.add("有未保存的变化", Style::Yellow);
+            else
+                line.add(job.watched ? "监视中" : "等待中", Style::Green);
+
+            if (job.last.savedAt > 0)
+            {
+                char saved[128];
+                std::snprintf(saved, sizeof(saved), "  上次 %s 槽 #%d  %s  %.1f 秒",
+                              formatClock(static_cast<std::time_t>(job.last.savedAt), "%H:%M:%S").c_str(),
+                              job.last.slot, formatBytes(job.last.bytesWritten).c_str(), job.last.seconds);
+                line.add(saved);
+            }
+            else
+                line.add("  本次运行尚未保存", Style::Gray);
+            if (job.nextSaveSeconds >= 0)
+                line.add("  下次定时 " + std::to_string(job.nextSaveSeconds) + " 秒后", Style::Gray);
+            if (!job.last.error.empty())
+                line.add("  失败: " + job.last.error, Style::Red);
+        }
+    }
+
+    void renderMessages(const Dashboard::Snapshot &s, ScreenBuffer &screen, int y, int lines)
+    {
+        const int count = std::min(lines, static_cast<int>(s.messages.size()));
+        if (count == 0)
+        {
+            screen.put(2, y, "暂无消息", Style::Gray);
+            return;
+        }
+        const std::size_t first = s.messages.size() - count;
+        for (int i = 0; i < count; ++i)
+        {
+            const ConsoleMessage &msg = s.messages[first + i];
+            std::string text = msg.content;
+            std::replace(text.begin(), text.end(), '\n', ' ');
+            if (msg.repeat > 1)
+                text += " ×" + std::to_string(msg.repeat);
+            Line{screen, 2, y + i}.add(messagePrefix(msg.type), messageStyle(msg.type)).add(text);
+        }
+    }
+}
+
+void Dashboard::render(const Snapshot &s, ScreenBuffer &screen)
+{
+    screen.clear();
+    const int cols = screen.cols();
+    const int rows = screen.rows();
+    if (cols < 40 || rows < 12)
+    {
+        screen.put(0, 0, "终端太小（至少 40×12），按 Q 返回", Style::Yellow);
+        return;
+    }
+
+    // 标题栏
+    screen.fill(0, 0, cols, U' ', Style::Inverse);
+    screen.put(1, 0, "DanhengServer-Console 仪表盘", Style::Inverse | Style::Bold);
+    const std::string clock = formatClock(s.now, "%Y-%m-%d %H:%M:%S");
+    screen.put(cols - 1 - ScreenBuffer::displayWidth(clock), 0, clock, Style::Inverse);
+
+    // 服务器状态
+    Line server{screen, 1, 1};
+    server.add("服务器 ", Style::Gray).add(s.serverUrl + "  ");
+    if (!s.statusKnown)
+        server.add("查询中…", Style::Gray);
+    else if (s.statusOk)
+        server.add("● 正常", Style::Green);
+    else
+        server.add("● 无法访问", Style::Red);
+
+    Line detail{screen, 1, 2};
+    if (s.statusKnown && s.statusOk)
+    {
+        const json &status = s.status;
+        const json online = status.value("onlinePlayers", json::array());
+        char text[160];
+        std::snprintf(text, sizeof(text), "在线 %zu 人  内存 %.0f/%.0f MB  程序 %.0f MB  响应 %d ms",
+                      online.is_array() ? online.size() : 0,
+                      status.value("usedMemory", 0.0), status.value("maxMemory", 0.0),
+                      status.value("programUsedMemory", 0.0), s.statusLatencyMs);
+        detail.add(text);
+    }
+    else if (s.statusKnown)
+        detail.add(s.statusError, Style::Red);
+    if (s.statusKnown)
+        detail.add("  " + std::to_string(s.statusAgeSeconds) + " 秒前", Style::Gray);
+
+    Line player{screen, 1, 3};
+    player.add("当前 UID ", Style::Gray).add(s.uid, Style::Cyan | Style::Bold).add("   玩家监视 ", Style::Gray);
+    if (s.watchedUids.empty())
+        player.add("未开启", Style::Gray);
+    else
+    {
+        std::string uids;
+        for (const auto &uid : s.watchedUids)
+            uids += " " + uid;
+        player.add(std::to_string(s.watchedUids.size()) + " 名:" + uids);
+    }
+
+    // 其余行分给三个分节：任务与自动保存按条数取所需、各有上限，剩下的给最近消息
+    const int available = rows - 5 - 3; // 去掉上方 4 行、底栏 1 行与 3 个分节标题
+    const int jobLines = std::min(std::max(static_cast<int>(s.jobs.size()), 1), std::max(1, available / 3));
+    const int saveLines = std::min(std::max(static_cast<int>(s.autosave.size()), 1), std::max(1, available / 4));
+    const int messageLines = std::max(1, available - jobLines - saveLines);
+
+    int y = 4;
+    int active = 0;
+    for (const auto &job : s.jobs)
+        active += job.state == JobManager::State::Running || job.state == JobManager::State::Queued;
+    section(screen, y++, "后台任务（进行中 " + std::to_string(active) + "）");
+    renderJobs(s, screen, y, jobLines);
+    y += jobLines;
+
+    section(screen, y++, "自动保存");
+    renderAutosave(s, screen, y, saveLines);
+    y += saveLines;
+
+    section(screen, y++, "最近消息");
+    renderMessages(s, screen, y, messageLines);
+
+    // 底栏
+    screen.fill(0, rows - 1, cols, U' ', Style::Inverse);
+    screen.put(1, rows - 1, "Q 退出  R 立即刷新服务器状态", Style::Inverse, cols - 2);
+}
+
+bool Dashboard::run(const Options &options)
+{
+    if (!TerminalBackend::outputIsTty() || !TerminalBackend::enableVirtualTerminal())
+        return false;
+
+    const auto frameInterval = std::chrono::milliseconds(1000 / std::min(std::max(options.fps, 1), 30));
+    StatusPoller poller(options.statusIntervalSeconds);
+
+    ConsoleOutputManager::suspend();
+    ConsoleInputManager::captureKeys(true);
+    TerminalBackend::write("\x1B[?1049h\x1B[?25l"); // 切到备用屏幕并隐藏光标
+
+    ScreenBuffer front; // 终端上当前的内容；尺寸为 0，首帧会整屏重画
+    ScreenBuffer back;
+    std::string out;
+    std::uint64_t frames = 0, bytes = 0, firstFrameBytes = 0;
+    auto nextFrame = Clock::now();
+
+    bool quit = false;
+    while (!quit)
+    {
+        int cols = 80, rows = 24;
+        TerminalBackend::size(cols, rows);
+        if (back.cols() != cols || back.rows() != rows)
+            back.resize(cols, rows);
+
+        Snapshot snapshot;
+        snapshot.now = std::time(nullptr);
+        snapshot.serverUrl = ConsoleManager::config.value("dispatchUrl", std::string());
+        poller.fill(snapshot);
+        snapshot.uid = ConsoleManager::playerUid;
+        snapshot.watchedUids = PlayerWatcher::watchedUids();
+        snapshot.jobs = JobManager::list();
+        snapshot.autosave = AutoSaver::status();
+        snapshot.messages = ConsoleOutputManager::recentMessages();
+        render(snapshot, back);
+
+        out.clear();
+        ScreenBuffer::diff(front, back, out);
+        if (!out.empty())
+        {
+            TerminalBackend::write(out);
+            if (frames == 0)
+                firstFrameBytes = out.size();
+            ++frames;
+            bytes += out.size();
+        }
+        std::swap(front, back);
+
+        // 按键随到随处理，下一帧不早于帧间隔
+        nextFrame = std::max(nextFrame + frameInterval, Clock::now());
+        while (!quit)
+        {
+            const auto now = Clock::now();
+            if (now >= nextFrame)
+                break;
+            const int key = ConsoleInputManager::nextKey(std::chrono::duration_cast<std::chrono::milliseconds>(nextFrame - now) +
+                                                         std::chrono::milliseconds(1));
+            if (key == 'q' || key == 'Q')
+                quit = true;
+            else if (key == 'r' || key == 'R')
+                poller.refresh();
+            else if (key == 0x1B)
+            {
+                // 单独的 Esc 退出；方向键等转义序列紧随其后到达，整段丢弃
+                const int next = ConsoleInputManager::nextKey(std::chrono::milliseconds(30));
+                if (next < 0)
+                    quit = true;
+                else if (next == '[' || next == 'O')
+                    for (int k = ConsoleInputManager::nextKey(std::chrono::milliseconds(30)); k >= 0 && !(k >= 0x40 && k <= 0x7E);
+                         k = ConsoleInputManager::nextKey(std::chrono::milliseconds(30)))
+                    {
+                    }
+            }
+        }
+    }
+
+    TerminalBackend::write("\x1B[0m\x1B[?25h\x1B[?1049l"); // 恢复光标并回到原屏幕
+    ConsoleInputManager::captureKeys(false);
+    ConsoleOutputManager::resume();
+
+    char summary[160];
+    std::snprintf(summary, sizeof(summary), "已退出仪表盘：重绘 %llu 帧，共写出 %s（首帧 %s，之后平均每帧 %llu 字节）",
+                  static_cast<unsigned long long>(frames), formatBytes(bytes).c_str(), formatBytes(firstFrameBytes).c_str(),
+                  static_cast<unsigned long long>(frames > 1 ? (bytes - firstFrameBytes) / (frames - 1) : 0));
+    buffer(summary, MessageType::Info);
+    return true;
+}
@@ -0,0 +1,491 @@
+#include "FileCopier.hpp"
+#include "IoThrottle.hpp"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+#endif
+#endif
+
+const char *FileCopier::methodName(Method method)
+{
+    switch (method)
+    {
+    case Method::Clone:
+        return "reflink";
+    case Method::CopyFileRange:
+        return "copy_file_range";
+    case Method::Sendfile:
+        return "sendfile";
+    case Method::ReadWrite:
+        return "read/write";
+    case Method::Portable:
+        return "copy_file";
+    default:
+        return "auto";
+    }
+}
+
+#ifdef _WIN32
+
+bool FileCopier::commit(const fs::path &tmp, const fs::path &target, std::string &error)
+{
+    HANDLE file = CreateFileW(tmp.wstring().c_str(), GENERIC_WRITE, 0, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        error = "无法打开临时文件";
+        return false;
+    }
+    BOOL flushed = FlushFileBuffers(file);
+    CloseHandle(file);
+    if (!flushed)
+    {
+        error = "临时文件落盘失败";
+        return false;
+    }
+
+    // WRITE_THROUGH：改名操作完成前元数据已写入磁盘
+    if (!MoveFileExW(tmp.wstring().c_str(), target.wstring().c_str(),
+                     MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    {
+        error = "替换目标文件失败";
+        return false;
+    }
+    return true;
+}
+
+namespace
+{
+    // 写入 target 本身；失败时删除写了一半的文件
+    bool copyPlain(const fs::path &source, const fs::path &target,
+                   FileCopier::Stats &stats, std::string &error, IoThrottle *throttle)
+    {
+        std::error_code ec;
+        if (throttle && throttle->limited())
+        {
+            // copy_file 无法限速，改为按块读写
+            stats.method = FileCopier::Method::ReadWrite;
+            std::ifstream in(source, std::ios::binary);
+            std::ofstream out(target, std::ios::binary | std::ios::trunc);
+            std::vector<char> buffer(throttle->chunkSize());
+            bool cancelled = false;
+            while (in && out)
+            {
+                in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                const auto n = static_cast<std::size_t>(in.gcount());
+                if (n == 0)
+                    break;
+                if (!throttle->acquire(n))
+                {
+                    cancelled = true;
+                    break;
+                }
+                out.write(buffer.data(), static_cast<std::streamsize>(n));
+                stats.bytes += n;
+            }
+            if (cancelled || !in.is_open() || in.bad() || !out)
+            {
+                error = cancelled ? "复制已取消" : "复制失败 (read/write)";
+                out.close();
+                fs::remove(target, ec);
+                return false;
+            }
+            return true;
+        }
+
+        stats.method = FileCopier::Method::Portable;
+        fs::copy_file(source, target, fs::copy_options::overwrite_existing, ec);
+        if (ec)
+        {
+            error = ec.message();
+            fs::remove(target, ec);
+            return false;
+        }
+        stats.bytes = fs::file_size(target, ec);
+        return true;
+    }
+}
+
+bool FileCopier::copyAtomic(const fs::path &source, const fs::path &target,
+                            Stats &stats, std::string &error, Method, IoThrottle *throttle)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    stats = Stats{};
+
+    fs::path tmp = target;
+    tmp += ".tmp";
+    std::error_code ec;
+    if (!copyPlain(source, tmp, stats, error, throttle))
+        return false;
+    if (!commit(tmp, target, error))
+    {
+        fs::remove(tmp, ec);
+        return false;
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return true;
+}
+
+bool FileCopier::copyInto(const fs::path &source, const fs::path &target,
+                          Stats &stats, std::string &error, IoThrottle *throttle)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    stats = Stats{};
+    if (!copyPlain(source, target, stats, error, throttle))
+        return false;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return true;
+}
+
+bool FileCopier::syncTree(const fs::path &root, std::string &error)
+{
+    // Windows 没有按文件系统刷新的接口，目录项随 NTFS 日志落盘，这里只刷新文件
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec))
+    {
+        if (!it->is_regular_file())
+            continue;
+        HANDLE file = CreateFileW(it->path().wstring().c_str(), GENERIC_WRITE, 0, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            error = "无法打开文件: " + it->path().string();
+            return false;
+        }
+        BOOL flushed = FlushFileBuffers(file);
+        CloseHandle(file);
+        if (!flushed)
+        {
+            error = "文件落盘失败: " + it->path().string();
+            return false;
+        }
+    }
+    if (ec)
+    {
+        error = ec.message();
+        return false;
+    }
+    return true;
+}
+
+#else
+
+namespace
+{
+    constexpr std::size_t ReadWriteBuffer = 1024 * 1024;
+
+    struct Fd
+    {
+        int fd = -1;
+        ~Fd()
+        {
+            if (fd >= 0)
+                ::close(fd);
+        }
+    };
+
+    // 这些错误表示当前路径在此文件系统/内核上不可用，应换下一种方式
+    bool isUnsupported(int err)
+    {
+        return err == ENOSYS || err == EXDEV || err == EINVAL || err == EOPNOTSUPP ||
+               err == ENOTTY || err == ENOTSUP || err == EPERM;
+    }
+
+    // 改名后 fsync 所在目录，保证目录项本身也已持久化
+    bool renameAndSyncDir(const fs::path &tmp, const fs::path &target, std::string &error)
+    {
+        if (::rename(tmp.c_str(), target.c_str()) != 0)
+        {
+            error = std::string("替换目标文件失败: ") + std::strerror(errno);
+            return false;
+        }
+
+        fs::path dir = target.parent_path();
+        if (dir.empty())
+            dir = ".";
+        Fd dirFd{::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)};
+        if (dirFd.fd >= 0)
+            ::fsync(dirFd.fd);
+        return true;
+    }
+
+    // 限速时每次最多搬运一个令牌块
+    std::size_t stepSize(IoThrottle *throttle, std::size_t unlimited)
+    {
+        return throttle && throttle->limited() ? throttle->chunkSize() : unlimited;
+    }
+
+    // 取令牌；限速器已被取消时置 errno 为 ECANCELED 并返回 false，调用方按出错返回 -1
+    bool take(IoThrottle *throttle, std::size_t bytes)
+    {
+        if (!throttle || throttle->acquire(bytes))
+            return true;
+        errno = ECANCELED;
+        return false;
+    }
+
+    // 以下各路径都从偏移 done 继续，返回 1 成功、0 不支持、-1 出错
+    int copyReadWrite(int in, int out, std::uint64_t &done, IoThrottle *throttle)
+    {
+        std::vector<char> buffer(stepSize(throttle, ReadWriteBuffer));
+        while (true)
+        {
+            ssize_t n = ::pread(in, buffer.data(), buffer.size(), static_cast<off_t>(done));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0)
+                return -1;
+            if (n == 0)
+                return 1;
+            if (!take(throttle, static_cast<std::size_t>(n)))
+                return -1;
+
+            ssize_t written = 0;
+            while (written < n)
+            {
+                ssize_t w = ::pwrite(out, buffer.data() + written, static_cast<std::size_t>(n - written),
+                                     static_cast<off_t>(done + written));
+                if (w < 0 && errno == EINTR)
+                    continue;
+                if (w < 0)
+                    return -1;
+                written += w;
+            }
+            done += static_cast<std::uint64_t>(n);
+        }
+    }
+
+#ifdef __linux__
+    int copyClone(int in, int out, std::uint64_t &done, IoThrottle *)
+    {
+#ifdef FICLONE
+        if (done != 0)
+            return 0;
+        if (::ioctl(out, FICLONE, in) != 0)
+            return isUnsupported(errno) ? 0 : -1;
+        struct stat st;
+        if (::fstat(out, &st) != 0)
+            return -1;
+        done = static_cast<std::uint64_t>(st.st_size);
+        return 1;
+#else
+        return 0;
+#endif
+    }
+
+    int copyRange(int in, int out, std::uint64_t &done, IoThrottle *throttle)
+    {
+        const std::uint64_t start = done;
+        const std::size_t step = stepSize(throttle, 1u << 30);
+        while (true)
+        {
+            if (!take(throttle, step))
+                return -1;
+            loff_t inOff = static_cast<loff_t>(done);
+            loff_t outOff = static_cast<loff_t>(done);
+            ssize_t n = ::copy_file_range(in, &inOff, out, &outOff, step, 0);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0)
+                return (done == start && isUnsupported(errno)) ? 0 : -1;
+            if (n == 0)
+                return 1;
+            done += static_cast<std::uint64_t>(n);
+        }
+    }
+
+    int copySendfile(int in, int out, std::uint64_t &done, IoThrottle *throttle)
+    {
+        const std::uint64_t start = done;
+        const std::size_t step = stepSize(throttle, 1u << 30);
+        if (::lseek(out, static_cast<off_t>(done), SEEK_SET) < 0)
+            return -1;
+        while (true)
+        {
+            if (!take(throttle, step))
+                return -1;
+            off_t offset = static_cast<off_t>(done);
+            ssize_t n = ::sendfile(out, in, &offset, step);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0)
+                return (done == start && isUnsupported(errno)) ? 0 : -1;
+            if (n == 0)
+                return 1;
+            done += static_cast<std::uint64_t>(n);
+        }
+    }
+#endif
+
+    // 把 source 复制到 target（截断重写），从 preferred 开始依次降级；sync 为真时返回前 fsync
+    bool copyToPath(const fs::path &source, const fs::path &target, bool sync,
+                    FileCopier::Stats &stats, std::string &error,
+                    FileCopier::Method preferred, IoThrottle *throttle)
+    {
+        using Method = FileCopier::Method;
+
+        Fd in{::open(source.c_str(), O_RDONLY | O_CLOEXEC)};
+        struct stat st;
+        if (in.fd < 0 || ::fstat(in.fd, &st) != 0)
+        {
+            error = std::string("无法打开源文件: ") + std::strerror(errno);
+            return false;
+        }
+#ifdef POSIX_FADV_SEQUENTIAL
+        ::posix_fadvise(in.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+        Fd out{::open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, st.st_mode & 0777)};
+        if (out.fd < 0)
+        {
+            error = std::string("无法创建目标文件: ") + std::strerror(errno);
+            return false;
+        }
+
+        // 每种路径都从已复制的偏移继续
+        using Copy = int (*)(int, int, std::uint64_t &, IoThrottle *);
+        struct Path
+        {
+            Method method;
+            Copy copy;
+        };
+        static const Path paths[] = {
+#ifdef __linux__
+            {Method::Clone, copyClone},
+            {Method::CopyFileRange, copyRange},
+            {Method::Sendfile, copySendfile},
+#endif
+            {Method::ReadWrite, copyReadWrite},
+        };
+
+        std::uint64_t done = 0;
+        int rc = 0;
+        bool reached = true; // 本平台没有 preferred 对应的路径时，从头开始
+        for (const auto &path : paths)
+            if (path.method == preferred)
+                reached = false;
+        for (const auto &path : paths)
+        {
+            reached = reached || path.method == preferred;
+            if (!reached)
+                continue;
+            rc = path.copy(in.fd, out.fd, done, throttle);
+            if (rc != 0)
+            {
+                stats.method = path.method;
+                break;
+            }
+        }
+
+        if (rc != 1 || (sync && ::fsync(out.fd) != 0))
+        {
+            error = std::string("复制失败 (") + FileCopier::methodName(stats.method) + "): " + std::strerror(errno);
+            std::error_code ec;
+            fs::remove(target, ec);
+            return false;
+        }
+        stats.bytes = done;
+        return true;
+    }
+}
+
+bool FileCopier::commit(const fs::path &tmp, const fs::path &target, std::string &error)
+{
+    {
+        Fd file{::open(tmp.c_str(), O_RDONLY | O_CLOEXEC)};
+        if (file.fd < 0 || ::fsync(file.fd) != 0)
+        {
+            error = std::string("临时文件落盘失败: ") + std::strerror(errno);
+            return false;
+        }
+    }
+    return renameAndSyncDir(tmp, target, error);
+}
+
+bool FileCopier::copyAtomic(const fs::path &source, const fs::path &target,
+                            Stats &stats, std::string &error, Method preferred,
+                            IoThrottle *throttle)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    stats = Stats{};
+
+    fs::path tmp = target;
+    tmp += ".tmp";
+    if (!copyToPath(source, tmp, true, stats, error, preferred, throttle))
+        return false;
+    if (!renameAndSyncDir(tmp, target, error))
+    {
+        std::error_code ec;
+        fs::remove(tmp, ec);
+        return false;
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return true;
+}
+
+bool FileCopier::copyInto(const fs::path &source, const fs::path &target,
+                          Stats &stats, std::string &error, IoThrottle *throttle)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    stats = Stats{};
+    if (!copyToPath(source, target, false, stats, error, Method::Auto, throttle))
+        return false;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return true;
+}
+
+bool FileCopier::syncTree(const fs::path &root, std::string &error)
+{
+#ifdef __linux__
+    // 成千上万个小文件逐个 fsync 会串行等待日志提交；syncfs 一次把整个文件系统的脏数据写回
+    Fd dirFd{::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)};
+    if (dirFd.fd < 0 || ::syncfs(dirFd.fd) != 0)
+    {
+        error = std::string("目录落盘失败: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+#else
+    // 其他 POSIX 平台：文件与目录逐个 fsync
+    std::error_code ec;
+    auto syncOne = [&error](const fs::path &path, int flags)
+    {
+        Fd fd{::open(path.c_str(), flags | O_CLOEXEC)};
+        if (fd.fd < 0 || ::fsync(fd.fd) != 0)
+        {
+            error = "落盘失败: " + path.string() + ": " + std::strerror(errno);
+            return false;
+        }
+        return true;
+    };
+    for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec))
+    {
+        if (it->is_regular_file() && !syncOne(it->path(), O_RDONLY))
+            return false;
+        if (it->is_directory() && !syncOne(it->path(), O_RDONLY | O_DIRECTORY))
+            return false;
+    }
+    if (ec)
+    {
+        error = ec.message();
+        return false;
+    }
+    return syncOne(root, O_RDONLY | O_DIRECTORY);
+#endif
+}
+
+#endif
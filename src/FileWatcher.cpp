@@ -0,0 +1,214 @@
+#include "FileWatcher.hpp"
+
+#ifdef __linux__
+
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    constexpr std::uint32_t WatchMask = IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                                        IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF;
+
+    struct Watch
+    {
+        int id;
+        fs::path dir;
+        std::string fileName; // 非空时只关心该文件（及其 -wal/-journal）
+    };
+
+    std::mutex watchMutex;
+    // 同一目录被多个任务监视时 inotify 返回同一个 wd
+    std::unordered_map<int, std::vector<Watch>> watches;
+    int inotifyFd = -1;
+    int wakeFd = -1;
+    std::thread watcherThread;
+    FileWatcher::Callback callback;
+
+    bool ensureInit()
+    {
+        if (inotifyFd >= 0)
+            return true;
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (inotifyFd >= 0 && wakeFd >= 0)
+            return true;
+        if (inotifyFd >= 0)
+            ::close(inotifyFd);
+        if (wakeFd >= 0)
+            ::close(wakeFd);
+        inotifyFd = wakeFd = -1;
+        return false;
+    }
+
+    // 需持有 watchMutex
+    bool addWatch(int id, const fs::path &dir, const std::string &fileName)
+    {
+        int wd = inotify_add_watch(inotifyFd, dir.c_str(), WatchMask);
+        if (wd < 0)
+            return false;
+        watches[wd].push_back(Watch{id, dir, fileName});
+        return true;
+    }
+
+    // 递归监视目录树；需持有 watchMutex
+    bool addTree(int id, const fs::path &root)
+    {
+        if (!addWatch(id, root, {}))
+            return false;
+        std::error_code ec;
+        for (fs::recursive_directory_iterator it(root, ec), end; it != end; it.increment(ec))
+            if (it->is_directory(ec))
+                addWatch(id, it->path(), {});
+        return true;
+    }
+
+    bool matches(const std::string &name, const std::string &fileName)
+    {
+        return name == fileName || name == fileName + "-wal" || name == fileName + "-journal";
+    }
+
+    void watcherLoop()
+    {
+        // inotify_event 要求按其自身对齐
+        alignas(inotify_event) char events[64 * 1024];
+        pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {wakeFd, POLLIN, 0}};
+
+        while (true)
+        {
+            if (::poll(fds, 2, -1) < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return;
+            }
+            if (fds[1].revents)
+                return;
+
+            std::set<int> changed;
+            ssize_t n;
+            while ((n = ::read(inotifyFd, events, sizeof(events))) > 0)
+            {
+                std::lock_guard<std::mutex> lock(watchMutex);
+                for (char *p = events; p < events + n;)
+                {
+                    const auto *event = reinterpret_cast<const inotify_event *>(p);
+                    p += sizeof(inotify_event) + event->len;
+
+                    // 事件队列溢出：无法得知具体变化，所有任务都视为已修改
+                    if (event->mask & IN_Q_OVERFLOW)
+                    {
+                        for (const auto &entry : watches)
+                            for (const auto &watch : entry.second)
+                                changed.insert(watch.id);
+                        continue;
+                    }
+
+                    auto it = watches.find(event->wd);
+                    if (it == watches.end())
+                        continue;
+                    const std::string name = event->len ? event->name : "";
+
+                    // 迭代过程中 addTree 可能使 watches 重新散列，先拷贝
+                    const std::vector<Watch> targets = it->second;
+                    for (const auto &watch : targets)
+                    {
+                        if (!watch.fileName.empty())
+                        {
+                            if (!matches(name, watch.fileName))
+                                continue;
+                        }
+                        else if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)))
+                            addTree(watch.id, watch.dir / name);
+                        changed.insert(watch.id);
+                    }
+
+                    if (event->mask & IN_IGNORED)
+                        watches.erase(event->wd);
+                }
+            }
+
+            for (int id : changed)
+                callback(id);
+        }
+    }
+}
+
+bool FileWatcher::supported()
+{
+    return true;
+}
+
+bool FileWatcher::watch(int id, const fs::path &path)
+{
+    std::lock_guard<std::mutex> lock(watchMutex);
+    if (!ensureInit())
+        return false;
+
+    std::error_code ec;
+    if (fs::is_directory(path, ec))
+        return addTree(id, path);
+
+    fs::path dir = path.parent_path();
+    if (dir.empty())
+        dir = ".";
+    return addWatch(id, dir, path.filename().string());
+}
+
+void FileWatcher::start(Callback onChange)
+{
+    std::lock_guard<std::mutex> lock(watchMutex);
+    if (watcherThread.joinable() || !ensureInit())
+        return;
+    callback = std::move(onChange);
+    watcherThread = std::thread(watcherLoop);
+}
+
+void FileWatcher::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(watchMutex);
+        if (!watcherThread.joinable())
+            return;
+        std::uint64_t one = 1;
+        (void)!::write(wakeFd, &one, sizeof(one));
+    }
+    watcherThread.join();
+
+    std::lock_guard<std::mutex> lock(watchMutex);
+    ::close(inotifyFd);
+    ::close(wakeFd);
+    inotifyFd = wakeFd = -1;
+    watches.clear();
+}
+
+#else
+
+bool FileWatcher::supported()
+{
+    return false;
+}
+
+bool FileWatcher::watch(int, const fs::path &)
+{
+    return false;
+}
+
+void FileWatcher::start(Callback)
+{
+}
+
+void FileWatcher::stop()
+{
+}
+
+#endif
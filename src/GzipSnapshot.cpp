@@ -0,0 +1,162 @@
+#include "GzipSnapshot.hpp"
+#include "ChunkStore.hpp"
+#include "ThreadPool.hpp"
+#include "FileCopier.hpp"
+#include "IoThrottle.hpp"
+#include <zlib.h>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct CompressedBlock
+    {
+        std::vector<char> data;
+        std::uint32_t crc;    // 原始块的 CRC32（gzip 尾部本来就要计算）
+        std::size_t inputSize;
+    };
+
+    // 把一块数据压缩为一个完整的 gzip 成员（windowBits 15 + 16 表示写 gzip 头尾）
+    CompressedBlock compressBlock(const std::vector<char> &input, int level)
+    {
+        z_stream zs{};
+        if (deflateInit2(&zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            throw std::runtime_error("deflateInit2 失败");
+
+        std::vector<char> output(deflateBound(&zs, static_cast<uLong>(input.size())) + 32);
+        zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+        zs.avail_in = static_cast<uInt>(input.size());
+        zs.next_out = reinterpret_cast<Bytef *>(output.data());
+        zs.avail_out = static_cast<uInt>(output.size());
+
+        int rc = deflate(&zs, Z_FINISH);
+        output.resize(zs.total_out);
+        // gzip 模式下 adler 字段保存的是输入的 CRC32
+        const auto crc = static_cast<std::uint32_t>(zs.adler);
+        deflateEnd(&zs);
+        if (rc != Z_STREAM_END)
+            throw std::runtime_error("deflate 失败");
+        return CompressedBlock{std::move(output), crc, input.size()};
+    }
+}
+
+bool GzipSnapshot::compress(const fs::path &source, const fs::path &target,
+                            int level, unsigned threads, Stats &stats,
+                            IoThrottle *throttle,
+                            const std::function<bool(const Stats &)> &beforeCommit)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    stats = Stats{};
+
+    std::ifstream in(source, std::ios::binary);
+    if (!in.is_open())
+        return false;
+
+    fs::path tmp = target;
+    tmp += ".tmp";
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+        return false;
+
+    ThreadPool pool(threads);
+    // 在途块数上限：既让所有线程有活干，又限制内存占用
+    const std::size_t maxInFlight = pool.size() * 2;
+    std::deque<std::future<CompressedBlock>> inFlight;
+    ChunkStore::Sha256 digest;
+
+    auto writeOldest = [&]()
+    {
+        // 先出队再取结果：get() 抛出时该 future 已不在队列中，异常处理不会再等待它
+        std::future<CompressedBlock> oldest = std::move(inFlight.front());
+        inFlight.pop_front();
+        CompressedBlock block = oldest.get();
+        out.write(block.data.data(), static_cast<std::streamsize>(block.data.size()));
+        stats.outputBytes += block.data.size();
+        stats.crc = static_cast<std::uint32_t>(crc32_combine(stats.crc, block.crc, static_cast<z_off_t>(block.inputSize)));
+    };
+
+    try
+    {
+        while (in)
+        {
+            std::vector<char> block(BlockSize);
+            if (throttle && !throttle->acquire(block.size()))
+                throw std::runtime_error("压缩已取消");
+            in.read(block.data(), static_cast<std::streamsize>(block.size()));
+            const auto n = static_cast<std::size_t>(in.gcount());
+            if (n == 0)
+                break;
+            block.resize(n);
+            stats.inputBytes += n;
+            digest.update(block.data(), n);
+
+            inFlight.push_back(pool.submit([data = std::move(block), level]
+                                           { return compressBlock(data, level); }));
+            if (inFlight.size() >= maxInFlight)
+                writeOldest();
+        }
+        while (!inFlight.empty())
+            writeOldest();
+    }
+    catch (const std::exception &)
+    {
+        // 等待剩余任务结束后再删除临时文件
+        for (auto &future : inFlight)
+            future.wait();
+        out.close();
+        fs::remove(tmp);
+        throw;
+    }
+
+    // 空文件也写出一个空成员，保证结果是合法的 gzip
+    if (stats.inputBytes == 0)
+    {
+        CompressedBlock empty = compressBlock({}, level);
+        out.write(empty.data.data(), static_cast<std::streamsize>(empty.data.size()));
+        stats.outputBytes += empty.data.size();
+    }
+
+    out.close();
+    if (in.bad() || !out)
+    {
+        fs::remove(tmp);
+        return false;
+    }
+    stats.sha256 = digest.hex();
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    if (beforeCommit && !beforeCommit(stats))
+    {
+        fs::remove(tmp);
+        return true;
+    }
+    std::string error;
+    if (!FileCopier::commit(tmp, target, error))
+    {
+        fs::remove(tmp);
+        return false;
+    }
+
+    return true;
+}
+
+bool GzipSnapshot::decompress(const fs::path &source, const fs::path &target)
+{
+    gzFile gz = gzopen(source.string().c_str(), "rb");
+    if (!gz)
+        return false;
+    gzbuffer(gz, 256 * 1024);
+
+    std::ofstream out(target, std::ios::binary | std::ios::trunc);
+    std::vector<char> buffer(1024 * 1024);
+    int n;
+    while ((n = gzread(gz, buffer.data(), static_cast<unsigned>(buffer.size()))) > 0)
+        out.write(buffer.data(), n);
+
+    bool ok = n == 0 && static_cast<bool>(out);
+    gzclose(gz);
+    return ok;
+}
@@ -0,0 +1,224 @@
+#include "InventoryReconciler.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    // 字段名归一化：小写并去掉下划线，itemId、ItemId、item_id 视为同一个名字
+    std::string normalizeKey(const std::string &key)
+    {
+        std::string out;
+        out.reserve(key.size());
+        for (unsigned char c : key)
+            if (c != '_')
+                out += static_cast<char>(std::tolower(c));
+        return out;
+    }
+
+    bool isIdKey(const std::string &key) { return key == "id" || key == "itemid"; }
+    bool isCountKey(const std::string &key) { return key == "count" || key == "num" || key == "amount"; }
+
+    // 物品ID：非负整数或纯数字字符串
+    bool readId(const json &value, std::uint32_t &id)
+    {
+        if (value.is_number_unsigned() || (value.is_number_integer() && value.get<std::int64_t>() >= 0))
+        {
+            const auto v = value.get<std::uint64_t>();
+            if (v > std::numeric_limits<std::uint32_t>::max())
+                return false;
+            id = static_cast<std::uint32_t>(v);
+            return true;
+        }
+        if (value.is_string())
+        {
+            const auto &text = value.get_ref<const std::string &>();
+            if (text.empty() || text.size() > 9 ||
+                !std::all_of(text.begin(), text.end(), [](unsigned char c) { return std::isdigit(c); }))
+                return false;
+            id = static_cast<std::uint32_t>(std::stoul(text));
+            return true;
+        }
+        return false;
+    }
+
+    bool readCount(const json &value, std::int64_t &count)
+    {
+        if (!value.is_number_integer() && !value.is_number_unsigned())
+            return false;
+        count = value.get<std::int64_t>();
+        return count >= 0;
+    }
+
+    void addCount(InventoryReconciler::Counts &counts, std::uint32_t id, std::int64_t count)
+    {
+        auto &total = counts[id];
+        total = count > std::numeric_limits<std::int64_t>::max() - total ? std::numeric_limits<std::int64_t>::max()
+                                                                         : total + count;
+    }
+
+    // 读取一个物品列表：每一项都必须是 {物品ID, 数量}
+    void readList(const std::string &name, const json &list, InventoryReconciler::Counts &counts)
+    {
+        if (!list.is_array())
+            throw std::runtime_error("物品列表 " + name + " 不是数组");
+        for (const auto &element : list)
+        {
+            std::uint32_t id = 0;
+            std::int64_t count = 0;
+            bool hasId = false, hasCount = false;
+            if (element.is_object())
+                for (const auto &field : element.items())
+                {
+                    const std::string key = normalizeKey(field.key());
+                    if (!hasId && isIdKey(key))
+                        hasId = readId(field.value(), id);
+                    else if (!hasCount && isCountKey(key))
+                        hasCount = readCount(field.value(), count);
+                }
+            if (!hasId || !hasCount)
+                throw std::runtime_error("物品列表 " + name + " 中有无法识别的项: " + element.dump().substr(0, 200));
+            addCount(counts, id, count);
+        }
+    }
+
+    // 在 value 的任意层级查找名为 lists 之一的字段并读取
+    void collectLists(const json &value, const std::unordered_set<std::string> &lists,
+                      InventoryReconciler::Holdings &holdings)
+    {
+        if (value.is_object())
+        {
+            for (const auto &item : value.items())
+            {
+                if (lists.count(normalizeKey(item.key())))
+                {
+                    readList(item.key(), item.value(), holdings.counts);
+                    holdings.listFound = true;
+                }
+                else
+                    collectLists(item.value(), lists, holdings);
+            }
+        }
+        else if (value.is_array())
+            for (const auto &element : value)
+                collectLists(element, lists, holdings);
+    }
+}
+
+InventoryReconciler::Counts InventoryReconciler::loadSpec(const fs::path &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("无法打开背包规格文件: " + path.string());
+    json spec;
+    try
+    {
+        in >> spec;
+    }
+    catch (const json::exception &e)
+    {
+        throw std::runtime_error("背包规格文件不是合法的 JSON: " + path.string() + "（" + e.what() + "）");
+    }
+    return parseSpec(spec);
+}
+
+InventoryReconciler::Counts InventoryReconciler::parseSpec(const json &spec)
+{
+    Counts desired;
+    std::uint32_t id = 0;
+    std::int64_t count = 0;
+
+    if (spec.is_object())
+    {
+        for (const auto &item : spec.items())
+        {
+            if (!readId(json(item.key()), id))
+                throw std::runtime_error("背包规格中的物品ID无效: " + item.key());
+            if (!readCount(item.value(), count))
+                throw std::runtime_error("背包规格中物品 " + item.key() + " 的数量无效");
+            addCount(desired, id, count);
+        }
+        return desired;
+    }
+
+    if (!spec.is_array())
+        throw std::runtime_error("背包规格应为对象或数组");
+    for (const auto &element : spec)
+    {
+        if (!element.is_object() || !element.contains("id") || !readId(element["id"], id))
+            throw std::runtime_error("背包规格数组的每一项应为 {\"id\": 物品ID, \"count\": 数量}: " + element.dump());
+        if (!element.contains("count") || !readCount(element["count"], count))
+            throw std::runtime_error("背包规格中物品 " + std::to_string(id) + " 的数量无效");
+        addCount(desired, id, count);
+    }
+    return desired;
+}
+
+InventoryReconciler::Holdings InventoryReconciler::parseHoldings(const json &data, const Fields &fields)
+{
+    Holdings holdings;
+    std::unordered_set<std::string> lists;
+    for (const auto &name : fields.lists)
+        lists.insert(normalizeKey(name));
+    collectLists(data, lists, holdings);
+
+    std::unordered_map<std::string, std::uint32_t> normalized;
+    for (const auto &[name, id] : fields.scalars)
+        normalized.emplace(normalizeKey(name), id);
+
+    if (data.is_object())
+    {
+        for (const auto &item : data.items())
+        {
+            auto scalar = normalized.find(normalizeKey(item.key()));
+            std::int64_t count = 0;
+            if (scalar != normalized.end() && readCount(item.value(), count))
+            {
+                // 标量字段是该物品的专门字段，以它为准
+                holdings.counts[scalar->second] = count;
+                holdings.scalarIds.insert(scalar->second);
+            }
+        }
+    }
+    return holdings;
+}
+
+InventoryReconciler::Fields InventoryReconciler::defaultFields()
+{
+    return {{"itemList", "items", "inventory"}, {{"credit", 2}, {"jade", 1}}};
+}
+
+InventoryReconciler::Plan InventoryReconciler::diff(const Counts &desired, const Holdings &current, std::int64_t maxPerCommand)
+{
+    Plan plan;
+    maxPerCommand = std::max<std::int64_t>(maxPerCommand, 1);
+    plan.wantedItems = desired.size();
+
+    for (const auto &[id, wanted] : desired)
+    {
+        plan.wantedCount += wanted;
+        if (!current.known(id))
+        {
+            ++plan.unknownItems;
+            continue;
+        }
+        auto held = current.counts.find(id);
+        const std::int64_t have = held == current.counts.end() ? 0 : held->second;
+        if (have >= wanted)
+        {
+            ++plan.satisfiedItems;
+            continue;
+        }
+        std::int64_t missing = wanted - have;
+        plan.missingCount += missing;
+        for (; missing > 0; missing -= std::min(missing, maxPerCommand))
+            plan.gives.push_back({id, std::min(missing, maxPerCommand)});
+    }
+
+    // 哈希表的遍历顺序不固定，排序后输出与提交顺序可复现
+    std::sort(plan.gives.begin(), plan.gives.end(), [](const Give &a, const Give &b)
+              { return a.id != b.id ? a.id < b.id : a.count > b.count; });
+    return plan;
+}
@@ -0,0 +1,105 @@
+#include "IoThrottle.hpp"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+IoThrottle::IoThrottle(double megabytesPerSecond)
+    : rate(megabytesPerSecond > 0 ? megabytesPerSecond * 1024 * 1024 : 0),
+      capacity(rate / 4),
+      tokens(rate / 4),
+      last(Clock::now())
+{
+}
+
+bool IoThrottle::acquire(std::size_t bytes)
+{
+    if (stopRequested)
+        return false;
+    if (rate <= 0)
+        return true;
+
+    std::unique_lock<std::mutex> lock(bucketMutex);
+    const auto now = Clock::now();
+    tokens = std::min(capacity, tokens + std::chrono::duration<double>(now - last).count() * rate);
+    last = now;
+
+    // 先扣除再按欠额等待：单次请求大于桶容量时也能通过
+    tokens -= static_cast<double>(bytes);
+    if (tokens >= 0)
+        return true;
+    // 等待期间释放锁，其他线程照常扣除；cancel() 通过条件变量提前唤醒
+    const auto wait = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(-tokens / rate));
+    return !cancelNotifier.wait_for(lock, wait, [this]
+                                    { return stopRequested.load(); });
+}
+
+void IoThrottle::cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(bucketMutex);
+        stopRequested = true;
+    }
+    cancelNotifier.notify_all();
+}
+
+std::size_t IoThrottle::chunkSize() const
+{
+    const auto eighth = static_cast<std::size_t>(rate / 8);
+    return std::clamp<std::size_t>(eighth, 64 * 1024, 1024 * 1024);
+}
+
+#ifdef _WIN32
+
+IoPriorityScope::IoPriorityScope(bool enable)
+{
+    // 后台模式同时降低线程的 CPU、磁盘与内存优先级
+    active = enable && SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+}
+
+IoPriorityScope::~IoPriorityScope()
+{
+    if (active)
+        SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
+}
+
+#elif defined(__linux__)
+
+namespace
+{
+    // <linux/ioprio.h> 在较旧的内核头文件中不存在，这里直接定义
+    constexpr int IoprioWhoProcess = 1; // who 为 0 时指调用线程
+    constexpr int IoprioClassShift = 13;
+    constexpr int IoprioClassIdle = 3;
+}
+
+IoPriorityScope::IoPriorityScope(bool enable)
+{
+    if (!enable)
+        return;
+    previous = static_cast<int>(syscall(SYS_ioprio_get, IoprioWhoProcess, 0));
+    active = previous >= 0 &&
+             syscall(SYS_ioprio_set, IoprioWhoProcess, 0, IoprioClassIdle << IoprioClassShift) == 0;
+}
+
+IoPriorityScope::~IoPriorityScope()
+{
+    if (active)
+        syscall(SYS_ioprio_set, IoprioWhoProcess, 0, previous);
+}
+
+#else
+
+IoPriorityScope::IoPriorityScope(bool)
+{
+}
+
+IoPriorityScope::~IoPriorityScope()
+{
+}
+
+#endif
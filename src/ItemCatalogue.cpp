@@ -0,0 +1,460 @@
+#include "ItemCatalogue.hpp"
+#include "ConsoleOutputManager.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+using json = nlohmann::json;
+
+MappedFile ItemCatalogue::index;
+
+namespace
+{
+    constexpr char IndexMagic[8] = {'D', 'H', 'I', 'T', 'E', 'M', '0', '1'};
+
+    // 字典树最大深度（字节）；更长的前缀在该深度节点的区间内再逐条比较
+    constexpr std::uint32_t MaxTrieDepth = 24;
+
+    // 索引文件布局：Header | IndexItem[itemCount] | uint32 slots[slotCount] | TrieNode[nodeCount] | 字符串区
+    struct IndexHeader
+    {
+        char magic[8];
+        std::uint64_t sourceStamp; // 源文件大小与修改时间的摘要，不一致时重新编译
+        std::uint32_t itemCount;
+        std::uint32_t slotCount;   // 哈希槽数，2 的幂
+        std::uint32_t nodeCount;
+        std::uint32_t reserved;
+        std::uint64_t itemsOffset;
+        std::uint64_t slotsOffset;
+        std::uint64_t nodesOffset;
+        std::uint64_t stringsOffset;
+        std::uint64_t stringsSize;
+    };
+
+    // 记录按名称排序存放
+    struct IndexItem
+    {
+        std::uint32_t id;
+        std::uint32_t nameOffset;
+        std::uint32_t nameLength;
+        std::uint32_t typeOffset;
+        std::uint32_t typeLength;
+    };
+
+    // 子节点以 firstChild / nextSibling 链接，0 表示无（根节点永远不是子节点）
+    // [begin, end) 为以该节点路径为前缀的记录区间
+    struct TrieNode
+    {
+        std::uint32_t firstChild;
+        std::uint32_t nextSibling;
+        std::uint32_t begin;
+        std::uint32_t end;
+        std::uint8_t  byte;
+        std::uint8_t  padding[3];
+    };
+
+    struct SourceItem
+    {
+        std::uint32_t id;
+        std::string   name;
+        std::string   mainType;
+    };
+
+    std::uint32_t slotOf(std::uint32_t id, std::uint32_t slotCount)
+    {
+        return (id * 2654435761u) & (slotCount - 1);
+    }
+
+    // 源文件摘要：FNV-1a 混合每个文件的路径、大小与修改时间
+    std::uint64_t sourceStampOf(const std::vector<fs::path> &files)
+    {
+        std::uint64_t h = 1469598103934665603ull;
+        auto mix = [&h](std::uint64_t v)
+        {
+            for (int i = 0; i < 8; ++i)
+            {
+                h ^= (v >> (i * 8)) & 0xFF;
+                h *= 1099511628211ull;
+            }
+        };
+        for (const auto &file : files)
+        {
+            std::error_code ec;
+            for (unsigned char c : file.generic_string())
+                mix(c);
+            mix(static_cast<std::uint64_t>(fs::file_size(file, ec)));
+            mix(static_cast<std::uint64_t>(fs::last_write_time(file, ec).time_since_epoch().count()));
+        }
+        return h;
+    }
+
+    const IndexHeader &headerOf(const MappedFile &file)
+    {
+        return *reinterpret_cast<const IndexHeader *>(file.data());
+    }
+
+    // 区段 [offset, offset + count * unit) 完整落在文件内，且按 align 对齐
+    bool sectionFits(std::uint64_t offset, std::uint64_t count, std::uint64_t unit, std::uint64_t align, std::uint64_t fileSize)
+    {
+        return offset % align == 0 && offset <= fileSize && count <= (fileSize - offset) / unit;
+    }
+
+    // 映射后逐项检查索引：截断或损坏的文件在这里被拒绝，之后的查找不再做边界检查
+    bool indexIntact(const MappedFile &file)
+    {
+        const std::uint64_t fileSize = file.size();
+        const IndexHeader &h = headerOf(file);
+        if (h.slotCount == 0 || (h.slotCount & (h.slotCount - 1)) != 0 || h.itemCount >= h.slotCount || h.nodeCount == 0 ||
+            !sectionFits(h.itemsOffset, h.itemCount, sizeof(IndexItem), alignof(IndexItem), fileSize) ||
+            !sectionFits(h.slotsOffset, h.slotCount, sizeof(std::uint32_t), alignof(std::uint32_t), fileSize) ||
+            !sectionFits(h.nodesOffset, h.nodeCount, sizeof(TrieNode), alignof(TrieNode), fileSize) ||
+            !sectionFits(h.stringsOffset, h.stringsSize, 1, 1, fileSize))
+            return false;
+
+        const auto *records = reinterpret_cast<const IndexItem *>(file.data() + h.itemsOffset);
+        for (std::uint32_t i = 0; i < h.itemCount; ++i)
+        {
+            const IndexItem &r = records[i];
+            if (std::uint64_t(r.nameOffset) + r.nameLength > h.stringsSize ||
+                std::uint64_t(r.typeOffset) + r.typeLength > h.stringsSize)
+                return false;
+        }
+
+        // 槽位为 0（空）或记录下标 + 1；至少要有一个空槽，否则查找不会终止
+        const auto *slots = reinterpret_cast<const std::uint32_t *>(file.data() + h.slotsOffset);
+        bool hasEmpty = false;
+        for (std::uint32_t s = 0; s < h.slotCount; ++s)
+        {
+            if (slots[s] > h.itemCount)
+                return false;
+            hasEmpty = hasEmpty || slots[s] == 0;
+        }
+        if (!hasEmpty)
+            return false;
+
+        // 编译时子节点与后继兄弟总在当前节点之后，据此排除越界与环
+        const auto *nodes = reinterpret_cast<const TrieNode *>(file.data() + h.nodesOffset);
+        for (std::uint32_t n = 0; n < h.nodeCount; ++n)
+        {
+            const TrieNode &node = nodes[n];
+            if ((node.firstChild != 0 && (node.firstChild <= n || node.firstChild >= h.nodeCount)) ||
+                (node.nextSibling != 0 && (node.nextSibling <= n || node.nextSibling >= h.nodeCount)) ||
+                node.begin > node.end || node.end > h.itemCount)
+                return false;
+        }
+        return true;
+    }
+
+    // 递归建立 [begin, end) 区间在 depth 处的子节点
+    void buildTrie(std::vector<TrieNode> &nodes, std::uint32_t parent,
+                   const std::vector<SourceItem> &items,
+                   std::uint32_t begin, std::uint32_t end, std::uint32_t depth)
+    {
+        if (depth >= MaxTrieDepth)
+            return;
+
+        // 名称恰好在此深度结束的记录排序时位于最前，不产生子节点
+        std::uint32_t i = begin;
+        while (i < end && items[i].name.size() <= depth)
+            ++i;
+
+        std::uint32_t prevChild = 0;
+        while (i < end)
+        {
+            const auto byte = static_cast<std::uint8_t>(items[i].name[depth]);
+            std::uint32_t j = i;
+            while (j < end && static_cast<std::uint8_t>(items[j].name[depth]) == byte)
+                ++j;
+
+            const auto child = static_cast<std::uint32_t>(nodes.size());
+            nodes.push_back(TrieNode{0, 0, i, j, byte, {0, 0, 0}});
+            if (prevChild)
+                nodes[prevChild].nextSibling = child;
+            else
+                nodes[parent].firstChild = child;
+            prevChild = child;
+
+            buildTrie(nodes, child, items, i, j, depth + 1);
+            i = j;
+        }
+    }
+
+    // ItemName 既可能是字符串，也可能是 {"Hash": ...}
+    std::string resolveName(const json &nameField, const json &textMap)
+    {
+        if (nameField.is_string())
+            return nameField.get<std::string>();
+
+        const json &hashField = nameField.is_object() && nameField.contains("Hash") ? nameField["Hash"] : nameField;
+        std::string hash = hashField.is_string() ? hashField.get<std::string>() : hashField.dump();
+        auto it = textMap.find(hash);
+        if (it != textMap.end() && it->is_string())
+            return it->get<std::string>();
+        return "#" + hash;
+    }
+}
+
+bool ItemCatalogue::load(const std::vector<fs::path> &sources,
+                         const fs::path &textMap,
+                         const fs::path &indexFile)
+{
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::vector<fs::path> stampFiles = sources;
+    if (!textMap.empty())
+        stampFiles.push_back(textMap);
+    std::uint64_t stamp = sourceStampOf(stampFiles);
+
+    if (!mapIndex(indexFile, stamp))
+    {
+        buffer("物品表索引不存在或已过期，正在重新编译……", MessageType::Info);
+        if (!build(sources, textMap, indexFile, stamp) || !mapIndex(indexFile, stamp))
+            return false;
+    }
+
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - startTime)
+                  .count();
+    buffer("物品表已加载：" + std::to_string(size()) + " 条，用时 " + std::to_string(ms) + " ms",
+           MessageType::Info);
+    return true;
+}
+
+std::size_t ItemCatalogue::size()
+{
+    return isLoaded() ? headerOf(index).itemCount : 0;
+}
+
+bool ItemCatalogue::mapIndex(const fs::path &indexFile, std::uint64_t stamp)
+{
+    if (!index.open(indexFile))
+        return false;
+
+    const auto fileSize = index.size();
+    if (fileSize < sizeof(IndexHeader))
+    {
+        index.close();
+        return false;
+    }
+
+    const IndexHeader &h = headerOf(index);
+    const bool valid =
+        std::memcmp(h.magic, IndexMagic, sizeof(IndexMagic)) == 0 &&
+        h.sourceStamp == stamp &&
+        indexIntact(index);
+
+    if (!valid)
+        index.close();
+    return valid;
+}
+
+bool ItemCatalogue::build(const std::vector<fs::path> &sources,
+                          const fs::path &textMapFile,
+                          const fs::path &indexFile,
+                          std::uint64_t stamp)
+{
+    std::vector<SourceItem> items;
+    try
+    {
+        json textMap = json::object();
+        if (!textMapFile.empty())
+        {
+            std::ifstream in(textMapFile);
+            if (!in.is_open())
+                buffer("无法打开 TextMap: " + textMapFile.string() + "，名称将显示为哈希", MessageType::Warning);
+            else
+                in >> textMap;
+        }
+
+        std::unordered_map<std::uint32_t, bool> seen;
+        for (const auto &source : sources)
+        {
+            std::ifstream in(source);
+            if (!in.is_open())
+            {
+                buffer("无法打开物品表: " + source.string(), MessageType::Warning);
+                continue;
+            }
+            json table;
+            in >> table;
+
+            // ExcelOutput 既有数组形式，也有以 ID 为键的对象形式
+            for (const auto &entry : table)
+            {
+                if (!entry.is_object() || !entry.contains("ID") || !entry["ID"].is_number_unsigned())
+                    continue;
+                auto id = entry["ID"].get<std::uint32_t>();
+                if (!seen.emplace(id, true).second)
+                    continue;
+
+                SourceItem item{id, "", ""};
+                if (entry.contains("ItemName"))
+                    item.name = resolveName(entry["ItemName"], textMap);
+                if (entry.contains("ItemMainType") && entry["ItemMainType"].is_string())
+                    item.mainType = entry["ItemMainType"].get<std::string>();
+                items.push_back(std::move(item));
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        buffer("物品表解析失败: " + std::string(e.what()), MessageType::Error);
+        return false;
+    }
+
+    if (items.empty())
+    {
+        buffer("物品表为空，未生成索引", MessageType::Warning);
+        return false;
+    }
+
+    std::sort(items.begin(), items.end(), [](const SourceItem &a, const SourceItem &b)
+              { return a.name != b.name ? a.name < b.name : a.id < b.id; });
+
+    // 字符串区与记录
+    std::string strings;
+    std::vector<IndexItem> records;
+    records.reserve(items.size());
+    for (const auto &item : items)
+    {
+        IndexItem r{};
+        r.id = item.id;
+        r.nameOffset = static_cast<std::uint32_t>(strings.size());
+        r.nameLength = static_cast<std::uint32_t>(item.name.size());
+        strings += item.name;
+        r.typeOffset = static_cast<std::uint32_t>(strings.size());
+        r.typeLength = static_cast<std::uint32_t>(item.mainType.size());
+        strings += item.mainType;
+        records.push_back(r);
+    }
+
+    // 哈希槽：负载率不超过 1/2，存放 记录下标 + 1
+    std::uint32_t slotCount = 1;
+    while (slotCount < records.size() * 2)
+        slotCount <<= 1;
+    std::vector<std::uint32_t> slots(slotCount, 0);
+    for (std::uint32_t i = 0; i < records.size(); ++i)
+    {
+        std::uint32_t s = slotOf(records[i].id, slotCount);
+        while (slots[s] != 0)
+            s = (s + 1) & (slotCount - 1);
+        slots[s] = i + 1;
+    }
+
+    std::vector<TrieNode> nodes;
+    nodes.push_back(TrieNode{0, 0, 0, static_cast<std::uint32_t>(items.size()), 0, {0, 0, 0}});
+    buildTrie(nodes, 0, items, 0, static_cast<std::uint32_t>(items.size()), 0);
+
+    IndexHeader h{};
+    std::memcpy(h.magic, IndexMagic, sizeof(IndexMagic));
+    h.sourceStamp = stamp;
+    h.itemCount = static_cast<std::uint32_t>(records.size());
+    h.slotCount = slotCount;
+    h.nodeCount = static_cast<std::uint32_t>(nodes.size());
+    h.itemsOffset = sizeof(IndexHeader);
+    h.slotsOffset = h.itemsOffset + records.size() * sizeof(IndexItem);
+    h.nodesOffset = h.slotsOffset + slots.size() * sizeof(std::uint32_t);
+    h.stringsOffset = h.nodesOffset + nodes.size() * sizeof(TrieNode);
+    h.stringsSize = strings.size();
+
+    // 先写临时文件再改名，避免中途失败留下半截索引
+    index.close();
+    fs::path tmp = indexFile;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            buffer("无法写入物品表索引: " + tmp.string(), MessageType::Error);
+            return false;
+        }
+        out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(IndexItem));
+        out.write(reinterpret_cast<const char *>(slots.data()), slots.size() * sizeof(std::uint32_t));
+        out.write(reinterpret_cast<const char *>(nodes.data()), nodes.size() * sizeof(TrieNode));
+        out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+        if (!out)
+        {
+            buffer("写入物品表索引失败: " + tmp.string(), MessageType::Error);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmp, indexFile, ec);
+    if (ec)
+    {
+        buffer("物品表索引改名失败: " + ec.message(), MessageType::Error);
+        return false;
+    }
+    return true;
+}
+
+CatalogueItem ItemCatalogue::itemAt(std::uint32_t i)
+{
+    const IndexHeader &h = headerOf(index);
+    const auto *records = reinterpret_cast<const IndexItem *>(index.data() + h.itemsOffset);
+    const char *strings = index.data() + h.stringsOffset;
+    const IndexItem &r = records[i];
+    return CatalogueItem{r.id,
+                         std::string_view(strings + r.nameOffset, r.nameLength),
+                         std::string_view(strings + r.typeOffset, r.typeLength)};
+}
+
+bool ItemCatalogue::find(std::uint32_t id, CatalogueItem &out)
+{
+    if (!isLoaded())
+        return false;
+
+    const IndexHeader &h = headerOf(index);
+    const auto *records = reinterpret_cast<const IndexItem *>(index.data() + h.itemsOffset);
+    const auto *slots = reinterpret_cast<const std::uint32_t *>(index.data() + h.slotsOffset);
+
+    for (std::uint32_t s = slotOf(id, h.slotCount);; s = (s + 1) & (h.slotCount - 1))
+    {
+        std::uint32_t entry = slots[s];
+        if (entry == 0)
+            return false;
+        if (records[entry - 1].id == id)
+        {
+            out = itemAt(entry - 1);
+            return true;
+        }
+    }
+}
+
+std::vector<CatalogueItem> ItemCatalogue::searchPrefix(const std::string &prefix, std::size_t limit)
+{
+    std::vector<CatalogueItem> result;
+    if (!isLoaded())
+        return result;
+
+    const IndexHeader &h = headerOf(index);
+    const auto *nodes = reinterpret_cast<const TrieNode *>(index.data() + h.nodesOffset);
+
+    // 沿字典树走到前缀（至多 MaxTrieDepth 字节）对应的节点
+    std::uint32_t node = 0;
+    const std::size_t walk = std::min<std::size_t>(prefix.size(), MaxTrieDepth);
+    for (std::size_t depth = 0; depth < walk; ++depth)
+    {
+        const auto byte = static_cast<std::uint8_t>(prefix[depth]);
+        std::uint32_t child = nodes[node].firstChild;
+        while (child != 0 && nodes[child].byte != byte)
+            child = nodes[child].nextSibling;
+        if (child == 0)
+            return result;
+        node = child;
+    }
+
+    for (std::uint32_t i = nodes[node].begin; i < nodes[node].end && result.size() < limit; ++i)
+    {
+        CatalogueItem item = itemAt(i);
+        if (prefix.size() > MaxTrieDepth && item.name.substr(0, prefix.size()) != prefix)
+            continue;
+        result.push_back(item);
+    }
+    return result;
+}
@@ -0,0 +1,200 @@
+#include "JobManager.hpp"
+#include <cstdio>
+#include <exception>
+
+std::mutex JobManager::jobsMutex;
+std::map<int, std::shared_ptr<JobManager::Job>> JobManager::jobs;
+int JobManager::nextId = 1;
+std::unique_ptr<ThreadPool> JobManager::pool;
+
+JobManager::Finalizer JobManager::finalizer;
+
+void JobManager::Job::step(bool succeeded)
+{
+    ++done;
+    if (!succeeded)
+        ++failed;
+}
+
+void JobManager::Job::print(const std::string &text, MessageType type) const
+{
+    buffer("[#" + std::to_string(jobId) + "] " + text, type);
+}
+
+const char *JobManager::stateName(State state)
+{
+    switch (state)
+    {
+    case State::Queued:
+        return "排队中";
+    case State::Running:
+        return "运行中";
+    case State::Done:
+        return "已完成";
+    case State::Cancelled:
+        return "已取消";
+    default:
+        return "失败";
+    }
+}
+
+void JobManager::start(unsigned workers)
+{
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    if (!pool)
+        pool = std::make_unique<ThreadPool>(workers > 0 ? workers : 1);
+}
+
+int JobManager::submit(const std::string &title, const std::string &uid, Body body)
+{
+    start();
+
+    auto job = std::make_shared<Job>();
+    job->title = title;
+    job->playerUid = uid;
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        job->jobId = nextId++;
+        jobs[job->jobId] = job;
+        prune();
+        pool->submit([job, body = std::move(body)]
+                     { run(job, body); });
+    }
+    return job->jobId;
+}
+
+void JobManager::run(const std::shared_ptr<Job> &job, const Body &body)
+{
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        job->started = Job::Clock::now();
+        job->state = State::Running;
+    }
+
+    State result = State::Done;
+    if (job->cancelled())
+        result = State::Cancelled; // 排队期间已被取消，不再执行
+    else
+    {
+        try
+        {
+            body(*job);
+            if (job->cancelled())
+                result = State::Cancelled;
+        }
+        catch (const std::exception &e)
+        {
+            job->print(job->title + " 执行异常: " + e.what(), MessageType::Error);
+            result = State::Failed;
+        }
+    }
+
+    double seconds;
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        job->finished = Job::Clock::now();
+        job->state = result;
+        seconds = std::chrono::duration<double>(job->finished - job->started).count();
+    }
+
+    char detail[128];
+    std::snprintf(detail, sizeof(detail), "：%d/%d，失败 %d，用时 %.1f 秒", job->done.load(), job->total.load(),
+                  job->failed.load(), seconds);
+    MessageType type = result == State::Done && job->failed == 0 ? MessageType::Success : MessageType::Warning;
+    if (result != State::Failed)
+        job->print(job->title + " " + stateName(result) + detail, type);
+}
+
+bool JobManager::cancel(int id)
+{
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    auto found = jobs.find(id);
+    if (found == jobs.end())
+        return false;
+    const State state = found->second->state;
+    if (state != State::Queued && state != State::Running)
+        return false;
+    found->second->cancelRequested = true;
+    return true;
+}
+
+int JobManager::cancelAll()
+{
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    int count = 0;
+    for (auto &entry : jobs)
+    {
+        const State state = entry.second->state;
+        if (state == State::Queued || state == State::Running)
+        {
+            entry.second->cancelRequested = true;
+            ++count;
+        }
+    }
+    return count;
+}
+
+std::vector<JobManager::Info> JobManager::list()
+{
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    const auto now = Job::Clock::now();
+    std::vector<Info> result;
+    for (const auto &entry : jobs)
+    {
+        const Job &job = *entry.second;
+        Info info;
+        info.id = job.jobId;
+        info.title = job.title;
+        info.uid = job.playerUid;
+        info.state = job.state;
+        info.total = job.total;
+        info.done = job.done;
+        info.failed = job.failed;
+        if (job.state != State::Queued)
+        {
+            const auto end = job.state == State::Running ? now : job.finished;
+            info.seconds = std::chrono::duration<double>(end - job.started).count();
+            info.perSecond = info.seconds > 0 ? info.done / info.seconds : 0;
+        }
+        result.push_back(std::move(info));
+    }
+    return result;
+}
+
+void JobManager::prune()
+{
+    std::size_t finished = 0;
+    for (const auto &entry : jobs)
+        if (entry.second->state != State::Queued && entry.second->state != State::Running)
+            ++finished;
+
+    // map 按编号有序，从最早的开始删
+    for (auto it = jobs.begin(); it != jobs.end() && finished > KeepFinished;)
+    {
+        const State state = it->second->state;
+        if (state != State::Queued && state != State::Running)
+        {
+            it = jobs.erase(it);
+            --finished;
+        }
+        else
+            ++it;
+    }
+}
+
+void JobManager::stop()
+{
+    cancelAll();
+    std::unique_ptr<ThreadPool> stopping;
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        stopping = std::move(pool);
+    }
+    // 线程池析构时等待已提交的任务：排队中的任务已取消，会直接结束
+    stopping.reset();
+}
+
+JobManager::Finalizer::~Finalizer()
+{
+    JobManager::stop();
+}
@@ -0,0 +1,121 @@
+#include "LatencyHistogram.hpp"
+#include <algorithm>
+
+namespace
+{
+    int highestBit(std::uint64_t value)
+    {
+        int bit = 63;
+        while (bit > 0 && !(value >> bit))
+            --bit;
+        return bit;
+    }
+}
+
+LatencyHistogram::LatencyHistogram()
+    : counts(SubCount * (64 - SubBits + 1), 0)
+{
+}
+
+// 小于 2×SubCount 的值每个值一个桶；更大的值按最高位分段，每段取最高位之后的 SubBits 位
+std::size_t LatencyHistogram::bucketOf(std::uint64_t value)
+{
+    if (value < SubCount)
+        return static_cast<std::size_t>(value);
+    const int shift = highestBit(value) - static_cast<int>(SubBits);
+    return SubCount + static_cast<std::size_t>(shift) * SubCount + static_cast<std::size_t>((value >> shift) - SubCount);
+}
+
+std::uint64_t LatencyHistogram::lowestOf(std::size_t bucket)
+{
+    if (bucket < SubCount)
+        return bucket;
+    const std::size_t shift = bucket / SubCount - 1;
+    return static_cast<std::uint64_t>(bucket % SubCount + SubCount) << shift;
+}
+
+std::uint64_t LatencyHistogram::highestOf(std::size_t bucket)
+{
+    if (bucket < SubCount)
+        return bucket;
+    const std::size_t shift = bucket / SubCount - 1;
+    return lowestOf(bucket) + ((std::uint64_t(1) << shift) - 1);
+}
+
+void LatencyHistogram::recordCount(std::uint64_t value, std::uint64_t times)
+{
+    counts[bucketOf(value)] += times;
+    total += times;
+    maximum = std::max(maximum, value);
+    sum += static_cast<long double>(value) * times;
+}
+
+void LatencyHistogram::record(std::uint64_t value)
+{
+    recordCount(value, 1);
+}
+
+void LatencyHistogram::recordCorrected(std::uint64_t value, std::uint64_t expectedInterval)
+{
+    record(value);
+    if (expectedInterval == 0)
+        return;
+    for (std::uint64_t missing = value; missing > expectedInterval;)
+    {
+        missing -= expectedInterval;
+        record(missing);
+    }
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+    for (std::size_t i = 0; i < counts.size(); ++i)
+        counts[i] += other.counts[i];
+    total += other.total;
+    maximum = std::max(maximum, other.maximum);
+    sum += other.sum;
+}
+
+LatencyHistogram LatencyHistogram::corrected(std::uint64_t expectedInterval) const
+{
+    LatencyHistogram result;
+    for (std::size_t i = 0; i < counts.size(); ++i)
+    {
+        if (!counts[i])
+            continue;
+        // 桶内的值按桶的上界处理（最大值所在的桶用真实最大值）
+        const std::uint64_t value = std::min(highestOf(i), maximum);
+        result.recordCount(value, counts[i]);
+        if (expectedInterval == 0)
+            continue;
+        for (std::uint64_t missing = value; missing > expectedInterval;)
+        {
+            missing -= expectedInterval;
+            result.recordCount(missing, counts[i]);
+        }
+    }
+    return result;
+}
+
+double LatencyHistogram::mean() const
+{
+    return total ? static_cast<double>(sum / total) : 0.0;
+}
+
+std::uint64_t LatencyHistogram::percentile(double p) const
+{
+    if (total == 0)
+        return 0;
+    const double clamped = std::min(std::max(p, 0.0), 100.0);
+    // 至少覆盖 p% 的样本所需的个数
+    std::uint64_t wanted = static_cast<std::uint64_t>(clamped / 100.0 * static_cast<double>(total) + 0.5);
+    wanted = std::max<std::uint64_t>(wanted, 1);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < counts.size(); ++i)
+    {
+        seen += counts[i];
+        if (seen >= wanted)
+            return std::min(highestOf(i), maximum);
+    }
+    return maximum;
+}
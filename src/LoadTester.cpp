@@ -0,0 +1,179 @@
+#include "LoadTester.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // 每个工作线程独立统计，结束后再合并，记录时没有共享写
+    struct WorkerStats
+    {
+        LatencyHistogram latency;
+        std::map<std::string, std::uint64_t> errors;
+        std::uint64_t sent = 0;
+        std::uint64_t succeeded = 0;
+    };
+
+    // 返回错误种类，成功时返回空串
+    std::string classify(const SessionManager::Response &response)
+    {
+        if (!response.transportError.empty())
+            return "连接错误: " + response.transportError;
+        if (response.httpStatus != 200)
+            return "HTTP " + std::to_string(response.httpStatus);
+        json parsed = json::parse(response.body, nullptr, false);
+        if (parsed.is_discarded() || !parsed.is_object())
+            return "响应无法解析";
+        const std::string message = parsed.value("message", std::string());
+        return message == "Success" ? std::string() : "返回 " + message;
+    }
+
+    std::uint64_t micros(Clock::duration d)
+    {
+        return static_cast<std::uint64_t>(std::max<std::int64_t>(
+            0, std::chrono::duration_cast<std::chrono::microseconds>(d).count()));
+    }
+}
+
+const char *LoadTester::targetName(Target target)
+{
+    switch (target)
+    {
+    case Target::ExecCommand:
+        return "exec_cmd";
+    case Target::PlayerInformation:
+        return "player_information";
+    default:
+        return "server_information";
+    }
+}
+
+LoadTester::Report LoadTester::run(const SessionManager::Session &session, const Options &options, const Progress &progress)
+{
+    // 请求体只构造一次（exec_cmd 的 RSA 加密也只做一次），压测的是服务端而不是本地加密
+    std::string body;
+    switch (options.target)
+    {
+    case Target::ExecCommand:
+        body = SessionManager::buildCommandBody(session.sessionId, session.rsaPublicKey, options.command, options.uid);
+        break;
+    case Target::PlayerInformation:
+        body = SessionManager::buildPlayerInfoBody(session.sessionId, options.uid);
+        break;
+    default:
+        body = SessionManager::buildServerStatusBody(session.sessionId);
+        break;
+    }
+    const std::string path = std::string("/muip/") + targetName(options.target);
+
+    const unsigned connections = std::max(1u, options.connections);
+    const int duration = std::max(1, options.durationSeconds);
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / std::max(options.rate, 0.001)));
+
+    std::vector<WorkerStats> stats(connections);
+    std::atomic<std::uint64_t> nextSlot{0};
+    std::atomic<std::uint64_t> completed{0};
+    std::atomic<std::uint64_t> failed{0};
+
+    // 留出连接建立的时间，让第一批请求不至于全部迟到
+    const auto start = Clock::now() + std::chrono::milliseconds(100);
+    const auto end = start + std::chrono::seconds(duration);
+
+    auto worker = [&](WorkerStats &mine)
+    {
+        while (true)
+        {
+            Clock::time_point intended;
+            if (options.mode == Mode::Open)
+            {
+                intended = start + period * static_cast<Clock::rep>(nextSlot++);
+                if (intended >= end)
+                    break;
+                if (Clock::now() < end)
+                    std::this_thread::sleep_until(intended);
+                else
+                {
+                    // 时长结束后才轮到这个排定的请求（积压）：延迟至少为 end - intended，按此下界记入，不能丢弃
+                    mine.latency.record(micros(end - intended));
+                    ++mine.errors["到时未发出（并发连接不足）"];
+                    ++failed;
+                    ++completed;
+                    continue;
+                }
+            }
+            else
+            {
+                std::this_thread::sleep_until(start);
+                intended = Clock::now();
+                if (intended >= end)
+                    break;
+            }
+
+            const SessionManager::Response response = SessionManager::postOnce(session.serverUrl, path.c_str(), body, options.timeoutMs);
+            mine.latency.record(micros(Clock::now() - intended));
+            ++mine.sent;
+
+            const std::string error = classify(response);
+            if (error.empty())
+                ++mine.succeeded;
+            else
+            {
+                ++mine.errors[error];
+                ++failed;
+            }
+            ++completed;
+        }
+    };
+
+    ThreadPool pool(connections);
+    std::vector<std::future<void>> done;
+    for (auto &mine : stats)
+        done.push_back(pool.submit([&worker, &mine]
+                                   { worker(mine); }));
+
+    // 每秒汇报一次，直到所有工作线程结束（最后一批请求可能在时长之后才返回）
+    std::uint64_t lastCompleted = 0, lastFailed = 0;
+    for (int second = 1;; ++second)
+    {
+        const auto tick = start + std::chrono::seconds(second);
+        bool finished = true;
+        for (auto &f : done)
+            if (f.wait_until(tick) != std::future_status::ready)
+            {
+                finished = false;
+                break;
+            }
+        if (progress && (!finished || second <= duration))
+        {
+            const std::uint64_t c = completed, e = failed;
+            progress(second, c - lastCompleted, e - lastFailed);
+            lastCompleted = c;
+            lastFailed = e;
+        }
+        if (finished)
+            break;
+    }
+    for (auto &f : done)
+        f.get();
+
+    Report report;
+    report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for (const auto &mine : stats)
+    {
+        report.sent += mine.sent;
+        report.succeeded += mine.succeeded;
+        report.latency.merge(mine.latency);
+        for (const auto &entry : mine.errors)
+            report.errors[entry.first] += entry.second;
+    }
+    // 闭环：本应按中位延迟的节奏发出的请求在慢响应期间被推迟了，按此补记
+    report.corrected = options.mode == Mode::Closed ? report.latency.corrected(report.latency.percentile(50))
+                                                    : report.latency;
+    return report;
+}
@@ -0,0 +1,441 @@
+#include "Metrics.hpp"
+#include "ConsoleOutputManager.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+std::mutex Metrics::registryMutex;
+
+std::mutex Metrics::exportMutex;
+std::condition_variable Metrics::exportNotifier;
+std::thread Metrics::exportThread;
+bool Metrics::exportStopping = false;
+fs::path Metrics::exportPath;
+int Metrics::exportInterval = 15;
+
+Metrics::Finalizer Metrics::finalizer;
+
+namespace
+{
+    // 每个线程第一次写指标时轮流分到一个分片，之后固定使用
+    std::size_t shardIndex()
+    {
+        static std::atomic<std::size_t> next{0};
+        thread_local const std::size_t index = next.fetch_add(1, std::memory_order_relaxed) % Metrics::Shards;
+        return index;
+    }
+
+    std::uint64_t toBits(double value)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof bits);
+        return bits;
+    }
+
+    double fromBits(std::uint64_t bits)
+    {
+        double value;
+        std::memcpy(&value, &bits, sizeof value);
+        return value;
+    }
+
+    // Prometheus 数值格式：整数不带小数点，无穷写作 +Inf
+    std::string formatNumber(double value, int precision = 10)
+    {
+        if (std::isinf(value))
+            return value > 0 ? "+Inf" : "-Inf";
+        if (std::isnan(value))
+            return "NaN";
+        char text[32];
+        std::snprintf(text, sizeof text, "%.*g", precision, value);
+        return text;
+    }
+
+    std::string escapeLabel(const std::string &value)
+    {
+        std::string out;
+        out.reserve(value.size());
+        for (char c : value)
+        {
+            if (c == '\\')
+                out += "\\\\";
+            else if (c == '"')
+                out += "\\\"";
+            else if (c == '\n')
+                out += "\\n";
+            else
+                out += c;
+        }
+        return out;
+    }
+
+    std::string escapeHelp(const std::string &value)
+    {
+        std::string out;
+        for (char c : value)
+        {
+            if (c == '\\')
+                out += "\\\\";
+            else if (c == '\n')
+                out += "\\n";
+            else
+                out += c;
+        }
+        return out;
+    }
+
+    // 在已渲染的标签后追加一个标签：{a="b"} + le → {a="b",le="..."}
+    std::string withLabel(const std::string &labels, const char *name, const std::string &value)
+    {
+        const std::string pair = std::string(name) + "=\"" + value + "\"";
+        if (labels.empty())
+            return "{" + pair + "}";
+        return labels.substr(0, labels.size() - 1) + "," + pair + "}";
+    }
+
+    const char *typeName(int type)
+    {
+        switch (type)
+        {
+        case 0:
+            return "counter";
+        case 1:
+            return "gauge";
+        default:
+            return "histogram";
+        }
+    }
+}
+
+void Metrics::Counter::add(std::uint64_t n)
+{
+    cells[shardIndex()].value.fetch_add(n, std::memory_order_relaxed);
+}
+
+std::uint64_t Metrics::Counter::value() const
+{
+    std::uint64_t total = 0;
+    for (const auto &cell : cells)
+        total += cell.value.load(std::memory_order_relaxed);
+    return total;
+}
+
+Metrics::Histogram::Histogram(std::vector<double> upperBounds)
+    : bounds(std::move(upperBounds))
+{
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+    if (!bounds.empty() && std::isinf(bounds.back()))
+        bounds.pop_back(); // +Inf 桶总是隐含存在
+    for (auto &shard : shards)
+    {
+        // 过度对齐类型的 new[] 按 alignof(Line) 对齐（C++17）
+        const std::size_t lineCount = bounds.size() / 8 + 1;
+        shard.lines = std::make_unique<Line[]>(lineCount);
+        for (std::size_t i = 0; i < lineCount * 8; ++i)
+            shard.count(i).store(0, std::memory_order_relaxed);
+    }
+}
+
+void Metrics::Histogram::observe(double value)
+{
+    const std::size_t bucket = std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin();
+    Shard &shard = shards[shardIndex()];
+    shard.count(bucket).fetch_add(1, std::memory_order_relaxed);
+
+    // 同一分片通常只有一个线程在写，CAS 几乎总是一次成功
+    std::uint64_t expected = shard.sumBits.load(std::memory_order_relaxed);
+    while (!shard.sumBits.compare_exchange_weak(expected, toBits(fromBits(expected) + value),
+                                                std::memory_order_relaxed))
+    {
+    }
+}
+
+Metrics::Histogram::Snapshot Metrics::Histogram::snapshot() const
+{
+    Snapshot snap;
+    snap.bounds = bounds;
+    snap.cumulative.assign(bounds.size() + 1, 0);
+    for (const auto &shard : shards)
+    {
+        for (std::size_t i = 0; i <= bounds.size(); ++i)
+            snap.cumulative[i] += shard.count(i).load(std::memory_order_relaxed);
+        snap.sum += fromBits(shard.sumBits.load(std::memory_order_relaxed));
+    }
+    for (std::size_t i = 1; i < snap.cumulative.size(); ++i)
+        snap.cumulative[i] += snap.cumulative[i - 1];
+    snap.count = snap.cumulative.back();
+    return snap;
+}
+
+double Metrics::Histogram::Snapshot::quantile(double q) const
+{
+    if (count == 0)
+        return 0;
+    const double rank = std::clamp(q, 0.0, 1.0) * static_cast<double>(count);
+    for (std::size_t i = 0; i < cumulative.size(); ++i)
+    {
+        if (static_cast<double>(cumulative[i]) < rank)
+            continue;
+        // 落在 +Inf 桶：只能给出最后一个有限上界
+        if (i == bounds.size())
+            return bounds.empty() ? 0 : bounds.back();
+        const double lower = i == 0 ? 0 : bounds[i - 1];
+        const double below = i == 0 ? 0 : static_cast<double>(cumulative[i - 1]);
+        const double inBucket = static_cast<double>(cumulative[i]) - below;
+        if (inBucket <= 0)
+            return bounds[i];
+        return lower + (bounds[i] - lower) * ((rank - below) / inBucket);
+    }
+    return bounds.empty() ? 0 : bounds.back();
+}
+
+std::map<std::string, Metrics::Family> &Metrics::families()
+{
+    static auto *registry = new std::map<std::string, Family>();
+    return *registry;
+}
+
+std::string Metrics::renderLabels(const Labels &labels)
+{
+    if (labels.empty())
+        return "";
+    Labels sorted = labels;
+    std::sort(sorted.begin(), sorted.end());
+    std::string out = "{";
+    for (std::size_t i = 0; i < sorted.size(); ++i)
+    {
+        if (i > 0)
+            out += ',';
+        out += sorted[i].first + "=\"" + escapeLabel(sorted[i].second) + "\"";
+    }
+    out += '}';
+    return out;
+}
+
+Metrics::Series &Metrics::lookup(const std::string &name, const std::string &help, Type type, const Labels &labels)
+{
+    auto &all = families();
+    auto found = all.find(name);
+    if (found == all.end())
+    {
+        found = all.emplace(name, Family()).first;
+        found->second.help = help;
+        found->second.type = type;
+    }
+    else if (found->second.type != type)
+        throw std::logic_error("指标 " + name + " 已以其他类型注册");
+
+    const std::string key = renderLabels(labels);
+    Series &series = found->second.series[key];
+    series.labels = key;
+    return series;
+}
+
+Metrics::Counter &Metrics::counter(const std::string &name, const std::string &help, const Labels &labels)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    Series &series = lookup(name, help, Type::Counter, labels);
+    if (!series.counter)
+        series.counter = std::make_unique<Counter>();
+    return *series.counter;
+}
+
+Metrics::Gauge &Metrics::gauge(const std::string &name, const std::string &help, const Labels &labels)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    Series &series = lookup(name, help, Type::Gauge, labels);
+    if (!series.gauge)
+        series.gauge = std::make_unique<Gauge>();
+    return *series.gauge;
+}
+
+Metrics::Histogram &Metrics::histogram(const std::string &name, const std::string &help,
+                                       const std::vector<double> &upperBounds, const Labels &labels)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    Series &series = lookup(name, help, Type::Histogram, labels);
+    if (!series.histogram)
+        series.histogram = std::make_unique<Histogram>(upperBounds);
+    return *series.histogram;
+}
+
+const std::vector<double> &Metrics::requestBuckets()
+{
+    static const std::vector<double> bounds{0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+    return bounds;
+}
+
+const std::vector<double> &Metrics::saveBuckets()
+{
+    static const std::vector<double> bounds{0.01, 0.05, 0.1, 0.5, 1, 5, 10, 30, 60, 300};
+    return bounds;
+}
+
+std::string Metrics::renderPrometheus()
+{
+    std::string out;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto &[name, family] : families())
+    {
+        out += "# HELP " + name + " " + escapeHelp(family.help) + "\n";
+        out += "# TYPE " + name + " " + typeName(static_cast<int>(family.type)) + "\n";
+        for (const auto &[key, series] : family.series)
+        {
+            switch (family.type)
+            {
+            case Type::Counter:
+                out += name + key + " " + std::to_string(series.counter->value()) + "\n";
+                break;
+            case Type::Gauge:
+                out += name + key + " " + std::to_string(series.gauge->value()) + "\n";
+                break;
+            case Type::Histogram:
+            {
+                const auto snap = series.histogram->snapshot();
+                for (std::size_t i = 0; i < snap.cumulative.size(); ++i)
+                {
+                    const double bound = i < snap.bounds.size() ? snap.bounds[i] : std::numeric_limits<double>::infinity();
+                    out += name + "_bucket" + withLabel(key, "le", formatNumber(bound)) + " " +
+                           std::to_string(snap.cumulative[i]) + "\n";
+                }
+                out += name + "_sum" + key + " " + formatNumber(snap.sum) + "\n";
+                out += name + "_count" + key + " " + std::to_string(snap.count) + "\n";
+                break;
+            }
+            }
+        }
+    }
+    return out;
+}
+
+std::vector<std::string> Metrics::describe()
+{
+    std::vector<std::string> lines;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto &[name, family] : families())
+    {
+        for (const auto &[key, series] : family.series)
+        {
+            std::string line = name + key + "  ";
+            switch (family.type)
+            {
+            case Type::Counter:
+                line += std::to_string(series.counter->value());
+                break;
+            case Type::Gauge:
+                line += std::to_string(series.gauge->value());
+                break;
+            case Type::Histogram:
+            {
+                const auto snap = series.histogram->snapshot();
+                line += "次数 " + std::to_string(snap.count);
+                if (snap.count > 0)
+                {
+                    line += "，平均 " + formatNumber(snap.sum / static_cast<double>(snap.count), 4) +
+                            "，p50≈" + formatNumber(snap.quantile(0.5), 4) +
+                            "，p99≈" + formatNumber(snap.quantile(0.99), 4);
+                }
+                break;
+            }
+            }
+            lines.push_back(std::move(line));
+        }
+    }
+    return lines;
+}
+
+bool Metrics::writeTextfile(const fs::path &path, std::string &error)
+{
+    const std::string text = renderPrometheus();
+
+    // 临时文件不以 .prom 结尾，textfile 收集器不会读到它
+    fs::path temp = path;
+    temp += ".tmp";
+    std::error_code ec;
+    if (path.has_parent_path())
+        fs::create_directories(path.parent_path(), ec);
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            error = "无法写入 " + temp.string();
+            return false;
+        }
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        if (!out)
+        {
+            error = "写入 " + temp.string() + " 失败";
+            return false;
+        }
+    }
+    fs::rename(temp, path, ec);
+    if (ec)
+    {
+        error = "无法替换 " + path.string() + "：" + ec.message();
+        fs::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+void Metrics::startExport(const fs::path &path, int intervalSeconds)
+{
+    stopExport();
+    std::lock_guard<std::mutex> lock(exportMutex);
+    exportPath = path;
+    exportInterval = std::max(intervalSeconds, 1);
+    exportStopping = false;
+    exportThread = std::thread(exportLoop);
+}
+
+void Metrics::stopExport()
+{
+    {
+        std::lock_guard<std::mutex> lock(exportMutex);
+        if (!exportThread.joinable())
+            return;
+        exportStopping = true;
+    }
+    exportNotifier.notify_all();
+    exportThread.join();
+}
+
+void Metrics::exportLoop()
+{
+    std::string lastError;
+    std::unique_lock<std::mutex> lock(exportMutex);
+    while (true)
+    {
+        const fs::path path = exportPath;
+        const bool stopping = exportStopping;
+        lock.unlock();
+
+        std::string error;
+        if (!writeTextfile(path, error))
+        {
+            // 同一错误只提示一次，避免每个周期刷屏
+            if (error != lastError && !stopping)
+                buffer("指标导出失败：" + error, MessageType::Warning);
+            lastError = error;
+        }
+        else
+            lastError.clear();
+
+        lock.lock();
+        if (stopping)
+            return; // 退出前已写出最后一次
+        exportNotifier.wait_for(lock, std::chrono::seconds(exportInterval), []
+                                { return exportStopping; });
+    }
+}
+
+Metrics::Finalizer::~Finalizer()
+{
+    stopExport();
+}
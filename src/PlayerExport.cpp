@@ -0,0 +1,598 @@
+#include "PlayerExport.hpp"
+#include "ConsoleManager.hpp"
+#include "ThreadPool.hpp"
+#include <zlib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+
+namespace
+{
+    constexpr char Magic[4] = {'D', 'H', 'P', 'X'};
+    constexpr std::uint8_t Version = 1;
+    constexpr std::uint8_t CompressedFlag = 0x80;
+    constexpr std::uint64_t MaxColumnBytes = 1ull << 30; // 读取时的合理性上限，防止损坏的长度字段耗尽内存
+
+    void putVarint(std::string &out, std::uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out += static_cast<char>(value | 0x80);
+            value >>= 7;
+        }
+        out += static_cast<char>(value);
+    }
+
+    void putBytes(std::string &out, std::string_view bytes)
+    {
+        putVarint(out, bytes.size());
+        out.append(bytes.data(), bytes.size());
+    }
+
+    std::uint64_t zigzag(std::int64_t value)
+    {
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+
+    std::int64_t unzigzag(std::uint64_t value)
+    {
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    // 从内存中顺序解码
+    struct Cursor
+    {
+        const char *p;
+        const char *end;
+
+        bool varint(std::uint64_t &value)
+        {
+            value = 0;
+            for (int shift = 0; shift < 64 && p < end; shift += 7)
+            {
+                const auto byte = static_cast<unsigned char>(*p++);
+                value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80))
+                    return true;
+            }
+            return false;
+        }
+
+        bool bytes(std::string_view &out)
+        {
+            std::uint64_t size = 0;
+            if (!varint(size) || size > static_cast<std::uint64_t>(end - p))
+                return false;
+            out = std::string_view(p, size);
+            p += size;
+            return true;
+        }
+    };
+
+    bool readVarint(std::istream &in, std::uint64_t &value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            const int c = in.get();
+            if (c == std::char_traits<char>::eof())
+                return false;
+            value |= static_cast<std::uint64_t>(c & 0x7f) << shift;
+            if (!(c & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    std::string escapeKey(const std::string &key)
+    {
+        std::string out;
+        for (char c : key)
+        {
+            if (c == '~')
+                out += "~0";
+            else if (c == '/')
+                out += "~1";
+            else
+                out += c;
+        }
+        return out;
+    }
+
+    // 列名按 "/" 分段，"~1"、"~0" 还原为 "/"、"~"
+    std::vector<std::string> splitName(std::string_view name)
+    {
+        std::vector<std::string> keys(1);
+        for (std::size_t i = 0; i < name.size(); ++i)
+        {
+            if (name[i] == '/')
+                keys.emplace_back();
+            else if (name[i] == '~' && i + 1 < name.size())
+                keys.back() += name[++i] == '1' ? '/' : '~';
+            else
+                keys.back() += name[i];
+        }
+        return keys;
+    }
+
+    // 按列名各段把值放回对象中
+    void assign(json &row, const std::vector<std::string> &keys, json value)
+    {
+        json *node = &row;
+        for (std::size_t i = 0; i + 1 < keys.size(); ++i)
+        {
+            json &child = (*node)[keys[i]];
+            if (!child.is_object())
+                child = json::object();
+            node = &child;
+        }
+        (*node)[keys.back()] = std::move(value);
+    }
+}
+
+//==============================================================================
+//                                  写入
+//==============================================================================
+
+bool PlayerExport::Writer::open(const fs::path &path)
+{
+    close();
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+    out.write(Magic, sizeof(Magic));
+    out.put(static_cast<char>(Version));
+    written = sizeof(Magic) + 1;
+    totalRows = 0;
+    return static_cast<bool>(out);
+}
+
+void PlayerExport::Writer::add(std::int64_t uid, const json &value)
+{
+    Cell id;
+    id.i = uid;
+    put("#uid", std::move(id));
+    flatten(value, std::string());
+    ++totalRows;
+    if (++pendingRows >= groupRows || pendingBytes >= groupBytes)
+        flush();
+}
+
+void PlayerExport::Writer::flatten(const json &value, const std::string &path)
+{
+    Cell cell;
+    switch (value.type())
+    {
+    case json::value_t::object:
+        for (const auto &item : value.items())
+            flatten(item.value(), path.empty() ? escapeKey(item.key()) : path + '/' + escapeKey(item.key()));
+        return;
+    case json::value_t::null:
+    case json::value_t::discarded:
+        return; // 缺失与 null 一样不记录
+    case json::value_t::number_integer:
+        cell.i = value.get<std::int64_t>();
+        break;
+    case json::value_t::number_unsigned:
+        if (value.get<std::uint64_t>() > static_cast<std::uint64_t>(INT64_MAX))
+        {
+            cell.kind = Kind::Json;
+            cell.s = value.dump();
+            break;
+        }
+        cell.i = value.get<std::int64_t>();
+        break;
+    case json::value_t::number_float:
+        cell.kind = Kind::Double;
+        cell.d = value.get<double>();
+        break;
+    case json::value_t::string:
+        cell.kind = Kind::String;
+        cell.s = value.get<std::string>();
+        break;
+    default: // 数组、布尔值等保留为 JSON 文本，读取时原样还原
+        cell.kind = Kind::Json;
+        cell.s = value.dump();
+        break;
+    }
+    put(path.empty() ? std::string("#value") : path, std::move(cell));
+}
+
+void PlayerExport::Writer::put(const std::string &name, Cell cell)
+{
+    auto [it, inserted] = columnIndex.try_emplace(name, columns.size());
+    if (inserted)
+        columns.push_back({name, {}});
+    pendingBytes += sizeof(std::pair<std::uint32_t, Cell>) + cell.s.size();
+    columns[it->second].cells.emplace_back(pendingRows, std::move(cell));
+}
+
+std::string PlayerExport::Writer::encode(const Column &column, Kind &kind) const
+{
+    // 同一列在本行组内的统一类型：全为整数用 Int，整数与小数混合用 Double，其余一律用 Json
+    kind = column.cells.front().second.kind;
+    for (const auto &[row, cell] : column.cells)
+    {
+        if (cell.kind == kind)
+            continue;
+        const bool numeric = (kind == Kind::Int || kind == Kind::Double) &&
+                             (cell.kind == Kind::Int || cell.kind == Kind::Double);
+        kind = numeric ? Kind::Double : Kind::Json;
+        if (kind == Kind::Json)
+            break;
+    }
+
+    std::string raw((pendingRows + 7) / 8, '\0');
+    for (const auto &entry : column.cells)
+        raw[entry.first / 8] = static_cast<char>(raw[entry.first / 8] | (1 << (entry.first % 8)));
+
+    if (kind == Kind::Int)
+    {
+        std::int64_t previous = 0;
+        for (const auto &[row, cell] : column.cells)
+        {
+            putVarint(raw, zigzag(static_cast<std::int64_t>(static_cast<std::uint64_t>(cell.i) - static_cast<std::uint64_t>(previous))));
+            previous = cell.i;
+        }
+    }
+    else if (kind == Kind::Double)
+    {
+        for (const auto &[row, cell] : column.cells)
+        {
+            const double value = cell.kind == Kind::Double ? cell.d : static_cast<double>(cell.i);
+            std::uint64_t bits = 0;
+            std::memcpy(&bits, &value, sizeof(bits));
+            for (int i = 0; i < 8; ++i)
+                raw += static_cast<char>(bits >> (8 * i));
+        }
+    }
+    else
+    {
+        // Json 列中原本不是 JSON 文本的值先转换
+        std::vector<std::string> converted;
+        if (kind == Kind::Json)
+        {
+            converted.reserve(column.cells.size());
+            for (const auto &[row, cell] : column.cells)
+            {
+                if (cell.kind == Kind::Json)
+                    converted.push_back(cell.s);
+                else if (cell.kind == Kind::String)
+                    converted.push_back(json(cell.s).dump());
+                else if (cell.kind == Kind::Double)
+                    converted.push_back(json(cell.d).dump());
+                else
+                    converted.push_back(std::to_string(cell.i));
+            }
+        }
+
+        std::unordered_map<std::string_view, std::uint32_t> ids;
+        std::vector<std::string_view> dictionary;
+        std::vector<std::uint32_t> indices;
+        indices.reserve(column.cells.size());
+        for (std::size_t i = 0; i < column.cells.size(); ++i)
+        {
+            const std::string_view text = kind == Kind::Json ? std::string_view(converted[i]) : std::string_view(column.cells[i].second.s);
+            auto [it, inserted] = ids.try_emplace(text, static_cast<std::uint32_t>(dictionary.size()));
+            if (inserted)
+                dictionary.push_back(text);
+            indices.push_back(it->second);
+        }
+        putVarint(raw, dictionary.size());
+        for (std::string_view text : dictionary)
+            putBytes(raw, text);
+        for (std::uint32_t index : indices)
+            putVarint(raw, index);
+    }
+    return raw;
+}
+
+void PlayerExport::Writer::flush()
+{
+    if (pendingRows == 0 || !out.is_open())
+        return;
+
+    std::string group;
+    putVarint(group, pendingRows);
+    putVarint(group, columns.size());
+    std::string compressed;
+    for (const auto &column : columns)
+    {
+        Kind kind = Kind::Int;
+        const std::string raw = encode(column, kind);
+        compressed.resize(compressBound(static_cast<uLong>(raw.size())));
+        uLongf size = static_cast<uLongf>(compressed.size());
+        const bool packed = compress2(reinterpret_cast<Bytef *>(compressed.data()), &size,
+                                      reinterpret_cast<const Bytef *>(raw.data()), static_cast<uLong>(raw.size()), 6) == Z_OK &&
+                            size < raw.size();
+
+        putBytes(group, column.name);
+        group += static_cast<char>(static_cast<std::uint8_t>(kind) | (packed ? CompressedFlag : 0));
+        putVarint(group, raw.size());
+        putBytes(group, packed ? std::string_view(compressed.data(), size) : std::string_view(raw));
+    }
+
+    out.write(group.data(), static_cast<std::streamsize>(group.size()));
+    written += group.size();
+    columns.clear();
+    columnIndex.clear();
+    pendingRows = 0;
+    pendingBytes = 0;
+}
+
+bool PlayerExport::Writer::close()
+{
+    if (!out.is_open())
+        return true;
+    flush();
+    out.put('\0'); // 行数为 0：文件结束
+    ++written;
+    out.close();
+    return !out.fail();
+}
+
+//==============================================================================
+//                                  读取
+//==============================================================================
+
+bool PlayerExport::Reader::open(const fs::path &path, std::string &error)
+{
+    in.close();
+    in.clear();
+    finished = false;
+    in.open(path, std::ios::binary);
+    if (!in)
+    {
+        error = "无法打开导出文件: " + path.string();
+        return false;
+    }
+    char header[sizeof(Magic) + 1] = {};
+    if (!in.read(header, sizeof(header)) || std::memcmp(header, Magic, sizeof(Magic)) != 0)
+    {
+        error = "不是玩家导出文件: " + path.string();
+        return false;
+    }
+    if (static_cast<std::uint8_t>(header[sizeof(Magic)]) != Version)
+    {
+        error = "不支持的导出文件版本: " + std::to_string(static_cast<std::uint8_t>(header[sizeof(Magic)]));
+        return false;
+    }
+    return true;
+}
+
+bool PlayerExport::Reader::next(std::vector<json> &rows, std::string &error)
+{
+    rows.clear();
+    if (finished || !in.is_open())
+        return false;
+
+    std::uint64_t rowCount = 0, columnCount = 0;
+    if (!readVarint(in, rowCount))
+    {
+        error = "文件没有结束标记，导出可能中断";
+        return false;
+    }
+    if (rowCount == 0)
+    {
+        finished = true;
+        return false;
+    }
+    if (rowCount > (1u << 24) || !readVarint(in, columnCount))
+    {
+        error = "行组头损坏";
+        return false;
+    }
+    rows.assign(static_cast<std::size_t>(rowCount), json::object());
+
+    std::string name, stored, raw;
+    for (std::uint64_t c = 0; c < columnCount; ++c)
+    {
+        std::uint64_t nameSize = 0, rawSize = 0, storedSize = 0;
+        if (!readVarint(in, nameSize) || nameSize > 4096)
+        {
+            error = "列头损坏";
+            return false;
+        }
+        name.resize(nameSize);
+        const int type = in.read(name.data(), static_cast<std::streamsize>(nameSize)) ? in.get() : -1;
+        if (type < 0 || !readVarint(in, rawSize) || !readVarint(in, storedSize) ||
+            rawSize > MaxColumnBytes || storedSize > MaxColumnBytes)
+        {
+            error = "列头损坏";
+            return false;
+        }
+        stored.resize(storedSize);
+        if (!in.read(stored.data(), static_cast<std::streamsize>(storedSize)))
+        {
+            error = "列 " + name + " 的内容不完整";
+            return false;
+        }
+
+        if (type & CompressedFlag)
+        {
+            raw.resize(rawSize);
+            uLongf size = static_cast<uLongf>(rawSize);
+            if (uncompress(reinterpret_cast<Bytef *>(raw.data()), &size,
+                           reinterpret_cast<const Bytef *>(stored.data()), static_cast<uLong>(stored.size())) != Z_OK ||
+                size != rawSize)
+            {
+                error = "列 " + name + " 解压失败";
+                return false;
+            }
+        }
+        else
+            raw.swap(stored);
+
+        const std::size_t bitmapSize = (static_cast<std::size_t>(rowCount) + 7) / 8;
+        if (raw.size() < bitmapSize)
+        {
+            error = "列 " + name + " 的存在位图不完整";
+            return false;
+        }
+        std::vector<std::uint32_t> present;
+        for (std::uint32_t row = 0; row < rowCount; ++row)
+            if (static_cast<unsigned char>(raw[row / 8]) & (1 << (row % 8)))
+                present.push_back(row);
+
+        const std::vector<std::string> keys = splitName(name);
+        Cursor cursor{raw.data() + bitmapSize, raw.data() + raw.size()};
+        const auto kind = static_cast<Kind>(type & ~CompressedFlag);
+        bool ok = true;
+        if (kind == Kind::Int)
+        {
+            std::int64_t value = 0;
+            for (std::uint32_t row : present)
+            {
+                std::uint64_t delta = 0;
+                if (!(ok = cursor.varint(delta)))
+                    break;
+                value = static_cast<std::int64_t>(static_cast<std::uint64_t>(value) + static_cast<std::uint64_t>(unzigzag(delta)));
+                assign(rows[row], keys, value);
+            }
+        }
+        else if (kind == Kind::Double)
+        {
+            for (std::uint32_t row : present)
+            {
+                if (!(ok = cursor.end - cursor.p >= 8))
+                    break;
+                std::uint64_t bits = 0;
+                for (int i = 0; i < 8; ++i)
+                    bits |= static_cast<std::uint64_t>(static_cast<unsigned char>(cursor.p[i])) << (8 * i);
+                cursor.p += 8;
+                double value = 0;
+                std::memcpy(&value, &bits, sizeof(value));
+                assign(rows[row], keys, value);
+            }
+        }
+        else if (kind == Kind::String || kind == Kind::Json)
+        {
+            // 字典中的每条只转换一次
+            std::uint64_t dictionarySize = 0;
+            std::vector<json> dictionary;
+            ok = cursor.varint(dictionarySize) && dictionarySize <= present.size();
+            for (std::uint64_t i = 0; ok && i < dictionarySize; ++i)
+            {
+                std::string_view text;
+                if (!(ok = cursor.bytes(text)))
+                    break;
+                dictionary.push_back(kind == Kind::String ? json(std::string(text))
+                                                          : json::parse(text.begin(), text.end(), nullptr, false));
+            }
+            for (std::size_t i = 0; ok && i < present.size(); ++i)
+            {
+                std::uint64_t index = 0;
+                if (!(ok = cursor.varint(index) && index < dictionary.size()))
+                    break;
+                assign(rows[present[i]], keys, dictionary[index]);
+            }
+        }
+        else
+            ok = false;
+
+        if (!ok)
+        {
+            error = "列 " + name + " 的内容损坏";
+            return false;
+        }
+    }
+    return true;
+}
+
+//==============================================================================
+//                                  导出
+//==============================================================================
+
+PlayerExport::Stats PlayerExport::exportRange(const Options &options, const std::function<bool(bool)> &onPlayer)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto started = Clock::now();
+    Stats stats;
+
+    if (options.lastUid < options.firstUid)
+        return stats;
+
+    const auto session = ConsoleManager::OpenSession();
+    Writer writer(options.groupRows);
+    if (!writer.open(options.path))
+        throw std::runtime_error("无法创建导出文件: " + options.path.string());
+
+    std::atomic<std::int64_t> nextUid{options.firstUid};
+    std::atomic<bool> stop{false};
+    std::mutex writerMutex; // 同时保护 writer 与 stats
+
+    const auto count = static_cast<std::uint64_t>(options.lastUid - options.firstUid) + 1;
+    const unsigned threads = static_cast<unsigned>(std::max<std::uint64_t>(1, std::min<std::uint64_t>(options.threads, count)));
+    {
+        // 每个线程不断领取下一个 UID；各自复用自己的 keep-alive 连接，解析与扁平化也在各线程中完成
+        ThreadPool pool(threads);
+        std::vector<std::future<void>> workers;
+        for (unsigned t = 0; t < threads; ++t)
+            workers.push_back(pool.submit([&]
+            {
+                while (!stop.load())
+                {
+                    const std::int64_t uid = nextUid.fetch_add(1);
+                    if (uid > options.lastUid)
+                        return;
+
+                    std::string error;
+                    SessionManager::Response response;
+                    try
+                    {
+                        response = SessionManager::postOnce(session.serverUrl, "/muip/player_information",
+                                                            SessionManager::buildPlayerInfoBody(session.sessionId, std::to_string(uid)));
+                    }
+                    catch (const std::exception &e)
+                    {
+                        response.transportError = e.what();
+                    }
+                    json value;
+                    if (!response.transportError.empty())
+                        error = response.transportError;
+                    else if (response.httpStatus != 200)
+                        error = "HTTP " + std::to_string(response.httpStatus);
+                    else
+                    {
+                        value = json::parse(response.body, nullptr, false);
+                        if (value.is_discarded() || !value.is_object())
+                            error = "响应不是合法的 JSON 对象";
+                        else
+                            value.erase("sessionId");
+                    }
+
+                    {
+                        std::lock_guard<std::mutex> lock(writerMutex);
+                        if (error.empty())
+                        {
+                            writer.add(uid, value);
+                            ++stats.rows;
+                            stats.rawBytes += response.body.size();
+                        }
+                        else
+                        {
+                            ++stats.failed;
+                            if (stats.firstError.empty())
+                                stats.firstError = "UID " + std::to_string(uid) + "：" + error;
+                        }
+                    }
+                    if (!onPlayer(error.empty()))
+                        stop = true;
+                }
+            }));
+        for (auto &worker : workers)
+            worker.get();
+    }
+
+    const bool closed = writer.close();
+    stats.fileBytes = writer.bytesWritten();
+    stats.cancelled = stop.load();
+    stats.seconds = std::chrono::duration<double>(Clock::now() - started).count();
+    if (!closed)
+        throw std::runtime_error("写入导出文件失败: " + options.path.string());
+    return stats;
+}
@@ -0,0 +1,275 @@
+#include "PlayerWatcher.hpp"
+#include "ConsoleManager.hpp"
+#include "ConsoleOutputManager.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <future>
+
+std::mutex PlayerWatcher::watchMutex;
+std::condition_variable PlayerWatcher::watchNotifier;
+std::thread PlayerWatcher::watchThread;
+bool PlayerWatcher::isRunning = false;
+bool PlayerWatcher::stopping = false;
+PlayerWatcher::Options PlayerWatcher::options;
+std::vector<PlayerWatcher::Player> PlayerWatcher::players;
+
+PlayerWatcher::Finalizer PlayerWatcher::finalizer;
+
+namespace
+{
+    // JSON Pointer 转义：~ → ~0，/ → ~1
+    void appendToken(std::string &path, const std::string &key)
+    {
+        path += '/';
+        for (char c : key)
+        {
+            if (c == '~')
+                path += "~0";
+            else if (c == '/')
+                path += "~1";
+            else
+                path += c;
+        }
+    }
+
+    void addOp(json &patch, const char *op, const std::string &path, const json *old, const json *value)
+    {
+        json entry = {{"op", op}, {"path", path}};
+        if (old)
+            entry["old"] = *old;
+        if (value)
+            entry["value"] = *value;
+        patch.push_back(std::move(entry));
+    }
+
+    // path 在递归中原地追加与截断，不为每一层复制
+    void diffInto(const json &before, const json &after, std::string &path, json &patch)
+    {
+        if (before.type() != after.type())
+        {
+            addOp(patch, "replace", path, &before, &after);
+            return;
+        }
+
+        const std::size_t length = path.size();
+        if (before.is_object())
+        {
+            // 两侧的键都有序，归并一遍即可得到删除、新增与共同的键
+            auto a = before.begin();
+            auto b = after.begin();
+            while (a != before.end() || b != after.end())
+            {
+                const int order = a == before.end()  ? 1
+                                  : b == after.end() ? -1
+                                                     : a.key().compare(b.key());
+                appendToken(path, order <= 0 ? a.key() : b.key());
+                if (order < 0)
+                    addOp(patch, "remove", path, &*a++, nullptr);
+                else if (order > 0)
+                    addOp(patch, "add", path, nullptr, &*b++);
+                else
+                    diffInto(*a++, *b++, path, patch);
+                path.resize(length);
+            }
+        }
+        else if (before.is_array())
+        {
+            const std::size_t common = std::min(before.size(), after.size());
+            for (std::size_t i = 0; i < common; ++i)
+            {
+                path += '/';
+                path += std::to_string(i);
+                diffInto(before[i], after[i], path, patch);
+                path.resize(length);
+            }
+            for (std::size_t i = common; i < after.size(); ++i)
+                addOp(patch, "add", path + '/' + std::to_string(i), nullptr, &after[i]);
+            for (std::size_t i = before.size(); i > common; --i)
+                addOp(patch, "remove", path + '/' + std::to_string(i - 1), &before[i - 1], nullptr);
+        }
+        else if (before != after)
+            addOp(patch, "replace", path, &before, &after);
+    }
+
+    std::string brief(const json &value)
+    {
+        std::string text = value.dump(-1, ' ', false, json::error_handler_t::replace);
+        if (text.size() > 80)
+            text = text.substr(0, 77) + "...";
+        return text;
+    }
+}
+
+json PlayerWatcher::diff(const json &before, const json &after)
+{
+    json patch = json::array();
+    std::string path;
+    diffInto(before, after, path, patch);
+    return patch;
+}
+
+std::string PlayerWatcher::describe(const json &op)
+{
+    const std::string name = op.value("op", std::string());
+    std::string path = op.value("path", std::string());
+    if (path.empty())
+        path = "/";
+    if (name == "replace")
+        return "replace " + path + ": " + brief(op["old"]) + " → " + brief(op["value"]);
+    if (name == "remove")
+        return "remove " + path + ": " + brief(op["old"]);
+    return name + " " + path + ": " + brief(op["value"]);
+}
+
+bool PlayerWatcher::start(Options newOptions)
+{
+    std::lock_guard<std::mutex> lock(watchMutex);
+    if (isRunning || newOptions.uids.empty())
+        return false;
+
+    options = std::move(newOptions);
+    options.intervalSeconds = std::max(options.intervalSeconds, 1);
+    options.threads = std::max(1u, std::min<unsigned>(options.threads, static_cast<unsigned>(options.uids.size())));
+    players.clear();
+    for (const auto &uid : options.uids)
+    {
+        Player player;
+        player.uid = uid;
+        players.push_back(std::move(player));
+    }
+
+    isRunning = true;
+    stopping = false;
+    watchThread = std::thread([]()
+                              { run(); });
+    return true;
+}
+
+void PlayerWatcher::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(watchMutex);
+        if (!isRunning)
+            return;
+        stopping = true;
+    }
+    watchNotifier.notify_all();
+    if (watchThread.joinable())
+        watchThread.join();
+
+    std::lock_guard<std::mutex> lock(watchMutex);
+    isRunning = false;
+}
+
+bool PlayerWatcher::running()
+{
+    std::lock_guard<std::mutex> lock(watchMutex);
+    return isRunning;
+}
+
+std::vector<std::string> PlayerWatcher::watchedUids()
+{
+    std::lock_guard<std::mutex> lock(watchMutex);
+    return isRunning ? options.uids : std::vector<std::string>();
+}
+
+bool PlayerWatcher::poll(Player &player, const SessionManager::Session &session)
+{
+    const std::string prefix = "[监视 " + player.uid + "] ";
+    try
+    {
+        std::string raw = SessionManager::GetPlayerInfoRaw(session, player.uid);
+        if (player.hasSnapshot && raw == player.raw)
+            return true; // 与上次完全相同
+
+        json response = SessionManager::parseResponse(raw);
+        if (response.value("message", std::string()) != "Success" || !response.contains("data"))
+            throw std::runtime_error("查询失败，返回信息：" + response.value("message", std::string()));
+
+        json data = std::move(response["data"]);
+        if (!player.lastError.empty())
+        {
+            buffer(prefix + "已恢复", MessageType::Success);
+            player.lastError.clear();
+        }
+
+        if (!player.hasSnapshot)
+            buffer(prefix + "已记录初始快照", MessageType::Info);
+        else
+        {
+            const json patch = diff(player.snapshot, data);
+            const std::size_t shown = std::min(patch.size(), MaxLinesPerPoll);
+            for (std::size_t i = 0; i < shown; ++i)
+                buffer(prefix + describe(patch[i]), MessageType::Info);
+            if (patch.size() > shown)
+                buffer(prefix + "……另有 " + std::to_string(patch.size() - shown) + " 处变化", MessageType::Info);
+        }
+        player.raw = std::move(raw);
+        player.snapshot = std::move(data);
+        player.hasSnapshot = true;
+        return true;
+    }
+    catch (const std::exception &e)
+    {
+        if (player.lastError != e.what())
+        {
+            player.lastError = e.what();
+            buffer(prefix + player.lastError, MessageType::Error);
+        }
+        return false;
+    }
+}
+
+void PlayerWatcher::run()
+{
+    using Clock = std::chrono::steady_clock;
+    ThreadPool pool(options.threads);
+    SessionManager::Session session;
+    bool sessionValid = false;
+
+    std::unique_lock<std::mutex> lock(watchMutex);
+    while (!stopping)
+    {
+        const auto roundStart = Clock::now();
+        lock.unlock();
+
+        if (!sessionValid)
+        {
+            try
+            {
+                session = ConsoleManager::OpenSession();
+                sessionValid = true;
+            }
+            catch (const std::exception &e)
+            {
+                buffer(std::string("[监视] 无法建立会话: ") + e.what(), MessageType::Error);
+            }
+        }
+
+        if (sessionValid)
+        {
+            // 各 UID 的查询互不依赖，分给工作线程并发进行；每个线程复用自己的连接
+            std::vector<std::future<bool>> results;
+            results.reserve(players.size());
+            for (auto &player : players)
+                results.push_back(pool.submit([&player, &session]
+                                              { return poll(player, session); }));
+            bool anyOk = false;
+            for (auto &result : results)
+                anyOk = result.get() || anyOk;
+            // 全部查询都失败时下一轮重新建立会话（会话可能已过期）；个别 UID 失败多半是 UID 本身的问题
+            sessionValid = anyOk;
+        }
+
+        lock.lock();
+        watchNotifier.wait_until(lock, roundStart + std::chrono::seconds(options.intervalSeconds), []
+                                 { return stopping; });
+    }
+}
+
+PlayerWatcher::Finalizer::~Finalizer()
+{
+    PlayerWatcher::stop();
+}
@@ -0,0 +1,357 @@
+#include "RelicSimulator.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+    using Stat = RelicSimulator::Stat;
+
+    struct WeightedStat
+    {
+        Stat stat;
+        std::uint32_t weight;
+    };
+
+    // 主词条表：下标 + 1 即主词条 ID，权重为千分比
+    const std::vector<WeightedStat> &mainTable(int partId)
+    {
+        static const std::vector<WeightedStat> tables[] = {
+            {},
+            {{Stat::Hp, 1000}},                                                             // 头
+            {{Stat::Atk, 1000}},                                                            // 手
+            {{Stat::HpPct, 200}, {Stat::AtkPct, 200}, {Stat::DefPct, 200}, {Stat::CritRate, 100},
+             {Stat::CritDmg, 100}, {Stat::Healing, 100}, {Stat::EffectHit, 100}},          // 躯
+            {{Stat::HpPct, 280}, {Stat::AtkPct, 300}, {Stat::DefPct, 300}, {Stat::Spd, 120}}, // 脚
+            {{Stat::HpPct, 120}, {Stat::AtkPct, 130}, {Stat::DefPct, 120}, {Stat::PhysicalDmg, 90},
+             {Stat::FireDmg, 90}, {Stat::IceDmg, 90}, {Stat::LightningDmg, 90}, {Stat::WindDmg, 90},
+             {Stat::QuantumDmg, 90}, {Stat::ImaginaryDmg, 90}},                            // 位面球
+            {{Stat::BreakEffect, 150}, {Stat::EnergyRegen, 50}, {Stat::HpPct, 270}, {Stat::AtkPct, 270},
+             {Stat::DefPct, 260}},                                                          // 连接绳
+        };
+        return tables[partId >= 1 && partId <= 6 ? partId : 0];
+    }
+
+    // 副词条表：下标 + 1 即副词条 ID
+    const WeightedStat SubTable[] = {
+        {Stat::Hp, 10}, {Stat::Atk, 10}, {Stat::Def, 10}, {Stat::HpPct, 10}, {Stat::AtkPct, 10}, {Stat::DefPct, 10},
+        {Stat::Spd, 4}, {Stat::CritRate, 6}, {Stat::CritDmg, 6}, {Stat::EffectHit, 8}, {Stat::EffectRes, 8},
+        {Stat::BreakEffect, 8}};
+    constexpr int SubKinds = sizeof(SubTable) / sizeof(SubTable[0]);
+
+    constexpr const char *StatNames[] = {
+        "hp", "atk", "def", "hp_pct", "atk_pct", "def_pct", "spd", "crit_rate", "crit_dmg", "effect_hit",
+        "effect_res", "break_effect", "healing", "energy_regen", "physical_dmg", "fire_dmg", "ice_dmg",
+        "lightning_dmg", "wind_dmg", "quantum_dmg", "imaginary_dmg"};
+    static_assert(sizeof(StatNames) / sizeof(StatNames[0]) == RelicSimulator::StatCount, "词条名称表与枚举不一致");
+
+    std::uint64_t splitmix64(std::uint64_t &x)
+    {
+        std::uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    inline std::uint64_t rotl(std::uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    // 4 路交错的 xoshiro256++：状态按路分列存放，一次补充 256 个 64 位数，
+    // 内层按路的循环只有加法、移位、异或与循环移位，编译器可向量化（SSE2/AVX2/NEON）
+    class LaneRng
+    {
+    public:
+        explicit LaneRng(std::uint64_t seed)
+        {
+            for (int lane = 0; lane < Lanes; ++lane)
+            {
+                s0[lane] = splitmix64(seed);
+                s1[lane] = splitmix64(seed);
+                s2[lane] = splitmix64(seed);
+                s3[lane] = splitmix64(seed);
+            }
+        }
+
+        std::uint32_t next()
+        {
+            if (pos == BufferWords)
+                refill();
+            return buffer[pos++];
+        }
+
+        // [0, n) 内的整数（乘法取高位，n 远小于 2^32，偏差可忽略）
+        std::uint32_t below(std::uint32_t n)
+        {
+            return static_cast<std::uint32_t>((static_cast<std::uint64_t>(next()) * n) >> 32);
+        }
+
+    private:
+        static constexpr int Lanes = 4;
+        static constexpr int Steps = 64;
+        static constexpr std::size_t BufferWords = Lanes * Steps * 2;
+
+        void refill()
+        {
+            for (int step = 0; step < Steps; ++step)
+            {
+                std::uint64_t result[Lanes];
+                for (int lane = 0; lane < Lanes; ++lane)
+                {
+                    result[lane] = rotl(s0[lane] + s3[lane], 23) + s0[lane];
+                    const std::uint64_t t = s1[lane] << 17;
+                    s2[lane] ^= s0[lane];
+                    s3[lane] ^= s1[lane];
+                    s1[lane] ^= s2[lane];
+                    s0[lane] ^= s3[lane];
+                    s2[lane] ^= t;
+                    s3[lane] = rotl(s3[lane], 45);
+                }
+                std::memcpy(buffer + step * Lanes * 2, result, sizeof(result));
+            }
+            pos = 0;
+        }
+
+        std::uint64_t s0[Lanes], s1[Lanes], s2[Lanes], s3[Lanes];
+        std::uint32_t buffer[BufferWords];
+        std::size_t pos = BufferWords;
+    };
+
+    // 权重均为小整数：按权重展开成查找表，抽样为一次乘法加一次查表，没有依赖随机数的分支
+    struct Sampler
+    {
+        std::vector<std::uint8_t> outcome;
+
+        explicit Sampler(const WeightedStat *table, std::size_t size)
+        {
+            for (std::size_t i = 0; i < size; ++i)
+                outcome.insert(outcome.end(), table[i].weight, static_cast<std::uint8_t>(i));
+        }
+
+        int draw(LaneRng &rng) const
+        {
+            return outcome[rng.below(static_cast<std::uint32_t>(outcome.size()))];
+        }
+    };
+
+    // 一次模拟中不变的量
+    struct Plan
+    {
+        Sampler main;
+        Sampler sub;
+        std::vector<Stat> mainStats;
+        int baseSubs;  // 初始副词条数（另有 20% 概率多一条）
+        int upgrades;  // 强化次数
+        const RelicSimulator::Profile &profile;
+    };
+
+    bool better(const RelicSimulator::Candidate &a, const RelicSimulator::Candidate &b)
+    {
+        return a.score > b.score || (a.score == b.score && a.index < b.index);
+    }
+
+    // 保留最好的 top 个：堆顶是其中最差的一个
+    void offer(std::vector<RelicSimulator::Candidate> &heap, std::size_t top, const RelicSimulator::Candidate &c)
+    {
+        if (heap.size() < top)
+        {
+            heap.push_back(c);
+            std::push_heap(heap.begin(), heap.end(), better);
+        }
+        else if (better(c, heap.front()))
+        {
+            std::pop_heap(heap.begin(), heap.end(), better);
+            heap.back() = c;
+            std::push_heap(heap.begin(), heap.end(), better);
+        }
+    }
+
+    constexpr std::uint64_t ChunkSize = 1u << 16;
+
+    // 候选 [first, last)，种子只由 (seed, 块号) 决定
+    void simulateChunk(const Plan &plan, std::uint64_t seed, std::uint64_t chunk, std::uint64_t first,
+                       std::uint64_t last, std::size_t top, std::vector<RelicSimulator::Candidate> &heap)
+    {
+        std::uint64_t mixed = seed ^ ((chunk + 1) * 0xD1B54A32D192ED03ull);
+        LaneRng rng(splitmix64(mixed));
+        const std::uint32_t extraSubThreshold = 858993459u; // 2^32 × 0.2
+
+        RelicSimulator::Candidate c;
+        for (std::uint64_t index = first; index < last; ++index)
+        {
+            c.index = index;
+            const int mainIndex = plan.mainStats.size() == 1 ? 0 : plan.main.draw(rng);
+            c.mainTag = static_cast<std::uint8_t>(mainIndex + 1);
+            const Stat main = plan.mainStats[mainIndex];
+
+            // 已占用的词条（含主词条）用位掩码排除
+            std::uint32_t used = 1u << static_cast<unsigned>(main);
+            c.subCount = 0;
+            auto addSub = [&]
+            {
+                int pick;
+                do
+                    pick = plan.sub.draw(rng);
+                while (used & (1u << static_cast<unsigned>(SubTable[pick].stat)));
+                used |= 1u << static_cast<unsigned>(SubTable[pick].stat);
+                c.subIds[c.subCount] = static_cast<std::uint8_t>(pick + 1);
+                c.rolls[c.subCount] = 1;
+                ++c.subCount;
+            };
+
+            const int initial = plan.baseSubs + (rng.next() < extraSubThreshold ? 1 : 0);
+            for (int i = 0; i < initial; ++i)
+                addSub();
+            // 每次强化：不足 4 条时新增一条，否则随机强化已有的一条
+            for (int i = 0; i < plan.upgrades; ++i)
+            {
+                if (c.subCount < 4)
+                    addSub();
+                else
+                    ++c.rolls[rng.below(4)];
+            }
+
+            float score = plan.profile.main[static_cast<std::size_t>(main)];
+            for (int i = 0; i < c.subCount; ++i)
+                score += plan.profile.sub[static_cast<std::size_t>(SubTable[c.subIds[i] - 1].stat)] * c.rolls[i];
+            c.score = score;
+            offer(heap, top, c);
+        }
+    }
+}
+
+const char *RelicSimulator::statName(Stat stat)
+{
+    const auto index = static_cast<std::size_t>(stat);
+    return index < StatCount ? StatNames[index] : "?";
+}
+
+RelicSimulator::Stat RelicSimulator::mainStat(int partId, int mainTag)
+{
+    const auto &table = mainTable(partId);
+    if (mainTag < 1 || mainTag > static_cast<int>(table.size()))
+        throw std::invalid_argument("部位 " + std::to_string(partId) + " 没有主词条 " + std::to_string(mainTag));
+    return table[mainTag - 1].stat;
+}
+
+RelicSimulator::Stat RelicSimulator::subStat(int subId)
+{
+    if (subId < 1 || subId > SubKinds)
+        throw std::invalid_argument("没有副词条 " + std::to_string(subId));
+    return SubTable[subId - 1].stat;
+}
+
+RelicSimulator::Profile RelicSimulator::Profile::fromJson(const json &j)
+{
+    Profile profile;
+    auto read = [&j](const char *section, std::array<float, StatCount> &weights)
+    {
+        if (!j.contains(section))
+            return;
+        for (const auto &item : j.at(section).items())
+        {
+            const auto found = std::find_if(std::begin(StatNames), std::end(StatNames), [&](const char *name)
+                                            { return item.key() == name; });
+            if (found == std::end(StatNames))
+                throw std::invalid_argument(std::string("未知的词条名: ") + section + "." + item.key());
+            weights[static_cast<std::size_t>(found - std::begin(StatNames))] = item.value().get<float>();
+        }
+    };
+    read("main", profile.main);
+    read("sub", profile.sub);
+    return profile;
+}
+
+RelicSimulator::Profile RelicSimulator::Profile::defaultProfile()
+{
+    return fromJson({{"main", {{"crit_rate", 3}, {"crit_dmg", 3}, {"spd", 3}, {"atk_pct", 2}, {"energy_regen", 2},
+                               {"physical_dmg", 2}, {"fire_dmg", 2}, {"ice_dmg", 2}, {"lightning_dmg", 2},
+                               {"wind_dmg", 2}, {"quantum_dmg", 2}, {"imaginary_dmg", 2}, {"hp", 1}, {"atk", 1}}},
+                     {"sub", {{"crit_rate", 1}, {"crit_dmg", 1}, {"spd", 1}, {"atk_pct", 0.6}, {"break_effect", 0.3},
+                              {"atk", 0.2}}}});
+}
+
+std::string RelicSimulator::Candidate::subTag() const
+{
+    std::string tag;
+    for (int i = 0; i < subCount; ++i)
+    {
+        if (i)
+            tag += ' ';
+        tag += std::to_string(subIds[i]) + ":" + std::to_string(rolls[i]);
+    }
+    return tag;
+}
+
+Relic RelicSimulator::Candidate::toRelic(const Options &options) const
+{
+    return Relic(options.type, options.starRank, options.relicId, options.partId, std::to_string(mainTag), subTag(),
+                 options.level);
+}
+
+RelicSimulator::Result RelicSimulator::run(const Options &options)
+{
+    if (!Relic::isValidPart(options.type, options.partId))
+        throw std::invalid_argument(options.type == Relic::Type::Tunnel ? "隧洞遗器部位ID应为 1–4" : "位面饰品部位ID应为 5–6");
+    if (options.starRank < 2 || options.starRank > 5)
+        throw std::invalid_argument("星级应为 2–5");
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // 强化等级：取 "l15" 中的数字，不超过该星级的上限
+    int level = 0;
+    for (char ch : options.level)
+        if (ch >= '0' && ch <= '9')
+            level = std::min(level * 10 + (ch - '0'), 99);
+    level = std::min(level, options.starRank * 3);
+
+    const auto &table = mainTable(options.partId);
+    Plan plan{Sampler(table.data(), table.size()), Sampler(SubTable, SubKinds), {}, options.starRank - 2, level / 3,
+              options.profile};
+    for (const auto &entry : table)
+        plan.mainStats.push_back(entry.stat);
+
+    const std::size_t top = std::max<std::size_t>(options.top, 1);
+    const std::uint64_t chunks = (options.candidates + ChunkSize - 1) / ChunkSize;
+    std::vector<std::vector<Candidate>> results(chunks);
+
+    unsigned threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+    threads = static_cast<unsigned>(std::max<std::uint64_t>(1, std::min<std::uint64_t>(threads ? threads : 1, chunks)));
+
+    // 工作线程依次领取分块；每块的结果放在自己的位置，合并顺序与线程调度无关
+    std::atomic<std::uint64_t> nextChunk{0};
+    auto work = [&]
+    {
+        for (std::uint64_t chunk; (chunk = nextChunk++) < chunks;)
+        {
+            const std::uint64_t first = chunk * ChunkSize;
+            const std::uint64_t last = std::min(first + ChunkSize, options.candidates);
+            results[chunk].reserve(top);
+            simulateChunk(plan, options.seed, chunk, first, last, top, results[chunk]);
+        }
+    };
+    if (threads == 1)
+        work();
+    else
+    {
+        ThreadPool pool(threads);
+        std::vector<std::future<void>> done;
+        for (unsigned i = 0; i < threads; ++i)
+            done.push_back(pool.submit(work));
+        for (auto &f : done)
+            f.get();
+    }
+
+    Result result;
+    for (const auto &chunk : results)
+        for (const auto &c : chunk)
+            offer(result.best, top, c);
+    std::sort(result.best.begin(), result.best.end(), better);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
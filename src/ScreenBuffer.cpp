@@ -0,0 +1,325 @@
+#include "ScreenBuffer.hpp"
+#include <algorithm>
+
+namespace
+{
+    // 解码一个 UTF-8 字符并前移 i；非法序列按 U+FFFD 处理，只跳过一个字节
+    char32_t decode(std::string_view s, std::size_t &i)
+    {
+        const auto lead = static_cast<unsigned char>(s[i]);
+        int extra;
+        char32_t ch;
+        if (lead < 0x80)
+        {
+            ++i;
+            return lead;
+        }
+        if ((lead & 0xE0) == 0xC0)
+        {
+            extra = 1;
+            ch = lead & 0x1F;
+        }
+        else if ((lead & 0xF0) == 0xE0)
+        {
+            extra = 2;
+            ch = lead & 0x0F;
+        }
+        else if ((lead & 0xF8) == 0xF0)
+        {
+            extra = 3;
+            ch = lead & 0x07;
+        }
+        else
+        {
+            ++i;
+            return 0xFFFD;
+        }
+        if (i + extra >= s.size())
+        {
+            ++i;
+            return 0xFFFD;
+        }
+        for (int k = 1; k <= extra; ++k)
+        {
+            const auto next = static_cast<unsigned char>(s[i + k]);
+            if ((next & 0xC0) != 0x80)
+            {
+                ++i;
+                return 0xFFFD;
+            }
+            ch = (ch << 6) | (next & 0x3F);
+        }
+        i += extra + 1;
+        return ch;
+    }
+
+    int digits(int value)
+    {
+        int n = 1;
+        while (value >= 10)
+        {
+            value /= 10;
+            ++n;
+        }
+        return n;
+    }
+
+    void appendCursor(int x, int y, std::string &out)
+    {
+        out += "\x1B[";
+        out += std::to_string(y + 1);
+        if (x > 0)
+        {
+            out += ';';
+            out += std::to_string(x + 1);
+        }
+        out += 'H';
+    }
+
+    int cursorCost(int x, int y)
+    {
+        return 3 + digits(y + 1) + (x > 0 ? 1 + digits(x + 1) : 0);
+    }
+
+    int utf8Length(char32_t ch)
+    {
+        return ch < 0x80 ? 1 : ch < 0x800 ? 2 : ch < 0x10000 ? 3 : 4;
+    }
+}
+
+ScreenBuffer::ScreenBuffer(int cols, int rows)
+{
+    resize(cols, rows);
+}
+
+void ScreenBuffer::resize(int cols, int rows)
+{
+    width = std::max(cols, 0);
+    height = std::max(rows, 0);
+    cells.assign(static_cast<std::size_t>(width) * height, Cell());
+}
+
+void ScreenBuffer::clear()
+{
+    std::fill(cells.begin(), cells.end(), Cell());
+}
+
+int ScreenBuffer::charWidth(char32_t ch)
+{
+    if (ch < 0x20 || (ch >= 0x7F && ch < 0xA0))
+        return 0;
+    // 组合附加符号、零宽字符与变体选择符
+    if ((ch >= 0x0300 && ch <= 0x036F) || (ch >= 0x200B && ch <= 0x200F) ||
+        (ch >= 0xFE00 && ch <= 0xFE0F) || ch == 0xFEFF)
+        return 0;
+    // 东亚宽字符（CJK、谚文、全角标点与符号、常见表情）
+    if ((ch >= 0x1100 && ch <= 0x115F) ||
+        (ch >= 0x2E80 && ch <= 0x303E) ||
+        (ch >= 0x3041 && ch <= 0x33FF) ||
+        (ch >= 0x3400 && ch <= 0x4DBF) ||
+        (ch >= 0x4E00 && ch <= 0x9FFF) ||
+        (ch >= 0xA000 && ch <= 0xA4CF) ||
+        (ch >= 0xAC00 && ch <= 0xD7A3) ||
+        (ch >= 0xF900 && ch <= 0xFAFF) ||
+        (ch >= 0xFE30 && ch <= 0xFE4F) ||
+        (ch >= 0xFF00 && ch <= 0xFF60) ||
+        (ch >= 0xFFE0 && ch <= 0xFFE6) ||
+        (ch >= 0x1F300 && ch <= 0x1F64F) ||
+        (ch >= 0x1F900 && ch <= 0x1F9FF) ||
+        (ch >= 0x20000 && ch <= 0x3FFFD))
+        return 2;
+    return 1;
+}
+
+int ScreenBuffer::displayWidth(std::string_view utf8)
+{
+    int columns = 0;
+    for (std::size_t i = 0; i < utf8.size();)
+        columns += charWidth(decode(utf8, i));
+    return columns;
+}
+
+int ScreenBuffer::put(int x, int y, std::string_view utf8, std::uint8_t style, int maxColumns)
+{
+    if (y < 0 || y >= height || x < 0 || x >= width)
+        return 0;
+    const int limit = maxColumns < 0 ? width - x : std::min(maxColumns, width - x);
+    Cell *row = &cells[static_cast<std::size_t>(y) * width];
+
+    // 覆盖全角字符的任意一半时，另一半变成空格
+    auto breakWide = [&](int column)
+    {
+        if (row[column].ch == 0 && column > 0)
+            row[column - 1].ch = U' ';
+        if (column + 1 < width && row[column + 1].ch == 0)
+            row[column + 1].ch = U' ';
+    };
+
+    int used = 0;
+    for (std::size_t i = 0; i < utf8.size();)
+    {
+        const char32_t ch = decode(utf8, i);
+        const int w = charWidth(ch);
+        if (w == 0)
+            continue;
+        if (used + w > limit)
+        {
+            if (used < limit)
+            {
+                fill(x + used, y, limit - used, U' ', style);
+                used = limit;
+            }
+            break;
+        }
+        const int column = x + used;
+        breakWide(column);
+        row[column] = {ch, style};
+        if (w == 2)
+        {
+            breakWide(column + 1);
+            row[column + 1] = {0, style};
+        }
+        used += w;
+    }
+    return used;
+}
+
+void ScreenBuffer::fill(int x, int y, int count, char32_t ch, std::uint8_t style)
+{
+    if (y < 0 || y >= height)
+        return;
+    Cell *row = &cells[static_cast<std::size_t>(y) * width];
+    const int begin = std::max(x, 0);
+    const int end = std::min(x + count, width);
+    if (begin >= end)
+        return;
+    // 填充范围两端切开的全角字符，剩下的一半变成空格
+    if (row[begin].ch == 0 && begin > 0)
+        row[begin - 1].ch = U' ';
+    if (end < width && row[end].ch == 0)
+        row[end].ch = U' ';
+    std::fill(row + begin, row + end, Cell{ch, style});
+}
+
+void ScreenBuffer::appendUtf8(char32_t ch, std::string &out)
+{
+    if (ch < 0x80)
+        out += static_cast<char>(ch);
+    else if (ch < 0x800)
+    {
+        out += static_cast<char>(0xC0 | (ch >> 6));
+        out += static_cast<char>(0x80 | (ch & 0x3F));
+    }
+    else if (ch < 0x10000)
+    {
+        out += static_cast<char>(0xE0 | (ch >> 12));
+        out += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (ch & 0x3F));
+    }
+    else
+    {
+        out += static_cast<char>(0xF0 | (ch >> 18));
+        out += static_cast<char>(0x80 | ((ch >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (ch & 0x3F));
+    }
+}
+
+void ScreenBuffer::appendStyle(std::uint8_t style, std::string &out)
+{
+    out += "\x1B[0";
+    if (style & Bold)
+        out += ";1";
+    if (style & Inverse)
+        out += ";7";
+    const int color = style & 0x0F;
+    if (color == Gray)
+        out += ";90";
+    else if (color >= Red && color <= White)
+    {
+        out += ";3";
+        out += static_cast<char>('0' + color);
+    }
+    out += 'm';
+}
+
+void ScreenBuffer::diff(const ScreenBuffer &front, const ScreenBuffer &back, std::string &out)
+{
+    // 尺寸变化（首帧或终端缩放）：清屏后与空白屏比较
+    ScreenBuffer blank;
+    const ScreenBuffer *base = &front;
+    if (front.width != back.width || front.height != back.height)
+    {
+        out += "\x1B[0m\x1B[2J";
+        blank.resize(back.width, back.height);
+        base = &blank;
+    }
+
+    const int width = back.width;
+    int cursorX = -1, cursorY = -1; // 光标位置未知
+    int current = Plain;            // 每次输出都以默认样式结束，下一次从默认样式开始
+    std::vector<char> dirty(static_cast<std::size_t>(width));
+
+    for (int y = 0; y < back.height; ++y)
+    {
+        const Cell *was = &base->cells[static_cast<std::size_t>(y) * width];
+        const Cell *now = &back.cells[static_cast<std::size_t>(y) * width];
+
+        bool any = false;
+        for (int x = 0; x < width; ++x)
+            any |= (dirty[x] = was[x] != now[x]) != 0;
+        if (!any)
+            continue;
+
+        // 全角字符的两格一起重画：续格变了要重画它的首格，原先的续格被覆盖时左侧原来的首格同理
+        for (int x = width - 1; x > 0; --x)
+            if (dirty[x] && (now[x].ch == 0 || was[x].ch == 0))
+                dirty[x - 1] = 1;
+
+        for (int x = 0; x < width; ++x)
+        {
+            if (!dirty[x] || now[x].ch == 0)
+                continue;
+
+            if (cursorY != y || cursorX != x)
+            {
+                // 同一行里光标落后不多：重写中间未变的格子比光标定位便宜时直接重写
+                int gapCost = -1;
+                if (cursorY == y && cursorX >= 0 && cursorX < x)
+                {
+                    gapCost = 0;
+                    for (int g = cursorX; g < x && gapCost >= 0; ++g)
+                    {
+                        if (now[g].ch == 0)
+                            continue;
+                        gapCost += utf8Length(now[g].ch);
+                        if (now[g].style != current)
+                            gapCost = -1; // 需要切换样式，不划算
+                    }
+                }
+                if (gapCost >= 0 && gapCost <= cursorCost(x, y))
+                {
+                    for (int g = cursorX; g < x; ++g)
+                        if (now[g].ch != 0)
+                            appendUtf8(now[g].ch, out);
+                }
+                else
+                    appendCursor(x, y, out);
+            }
+
+            if (now[x].style != current)
+            {
+                appendStyle(now[x].style, out);
+                current = now[x].style;
+            }
+            appendUtf8(now[x].ch, out);
+            cursorY = y;
+            cursorX = x + (x + 1 < width && now[x + 1].ch == 0 ? 2 : 1);
+            if (cursorX >= width)
+                cursorX = -1; // 行尾的自动换行行为因终端而异，下次重新定位
+        }
+    }
+
+    if (current != Plain)
+        out += "\x1B[0m";
+}
@@ -1,10 +1,13 @@
 #include "SessionManager.hpp"
 #include "ConsoleOutputManager.hpp"
+#include "Metrics.hpp"
 #include <openssl/pem.h>
 #include <openssl/rsa.h>
 #include <openssl/bio.h>
 #include <openssl/err.h>
 #include <curl/curl.h>
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
@@ -13,12 +16,62 @@
 
 using json = nlohmann::json;
 
+std::mutex SessionManager::sharedMutex;
+SessionManager::Session SessionManager::shared;
+bool SessionManager::sharedValid = false;
+
 static size_t WriteCallback(void *contents, size_t size, size_t nmemb, std::string *output)
 {
     output->append((char *)contents, size * nmemb);
     return size * nmemb;
 }
 
+namespace
+{
+    // 每个 MUIP 接口一组指标；未知路径（如压测自定义的路径）归入 other，避免标签无限增长
+    struct EndpointMetrics
+    {
+        const char *path;
+        Metrics::Counter *requests;
+        Metrics::Counter *transportErrors;
+        Metrics::Counter *httpErrors;
+        Metrics::Histogram *duration;
+    };
+
+    const EndpointMetrics &endpointMetrics(const char *path)
+    {
+        static const std::vector<EndpointMetrics> table = []
+        {
+            const char *paths[] = {"/muip/create_session", "/muip/auth_admin", "/muip/server_information",
+                                   "/muip/player_information", "/muip/exec_cmd", nullptr};
+            std::vector<EndpointMetrics> entries;
+            for (const char *known : paths)
+            {
+                const std::string endpoint = known ? std::string(known).substr(6) : "other";
+                entries.push_back({known,
+                                   &Metrics::counter("danheng_console_muip_requests_total", "MUIP 请求数", {{"endpoint", endpoint}}),
+                                   &Metrics::counter("danheng_console_muip_errors_total", "MUIP 请求失败数",
+                                                     {{"endpoint", endpoint}, {"kind", "transport"}}),
+                                   &Metrics::counter("danheng_console_muip_errors_total", "MUIP 请求失败数",
+                                                     {{"endpoint", endpoint}, {"kind", "http"}}),
+                                   &Metrics::histogram("danheng_console_muip_request_duration_seconds", "MUIP 请求耗时（秒）",
+                                                       Metrics::requestBuckets(), {{"endpoint", endpoint}})});
+            }
+            return entries;
+        }();
+        for (const auto &entry : table)
+            if (!entry.path || std::strcmp(entry.path, path) == 0)
+                return entry;
+        return table.back();
+    }
+}
+
+void SessionManager::initialize()
+{
+    if (curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK)
+        buffer("CURL 全局初始化失败", MessageType::Error);
+}
+
 std::string SessionManager::base64Encode(const std::string &binary)
 {
     BIO *bmem = BIO_new(BIO_s_mem());
@@ -107,168 +160,182 @@ std::string encrypt(const std::string &rsaPublicKeyPEM, const std::string &admin
     return SessionManager::base64Encode(encrypted);
 }
 
-json SessionManager::createSession(const std::string &serverUrl)
+std::string SessionManager::buildCreateSessionBody()
 {
-    CURL *curl = curl_easy_init();
-
-    if (!curl)
-    {
-        buffer("无法初始化 CURL", MessageType::Error);
-    }
-
-    std::string url = serverUrl + "/muip/create_session";
     json requestBody = {
         {"key_type", "PEM"}};
-    std::string postData = requestBody.dump();
-    struct curl_slist *headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    std::string responseStr;
-
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postData.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseStr);
-
-    CURLcode res = curl_easy_perform(curl);
-
-    curl_easy_cleanup(curl);
-    curl_slist_free_all(headers);
-
-    if (res != CURLE_OK)
-        buffer("创建会话请求失败: " + std::string(curl_easy_strerror(res)), MessageType::Error);
-    return json::parse(responseStr);
+    return requestBody.dump();
 }
 
-json SessionManager::authorize(const std::string &serverUrl, const std::string &sessionId, const std::string &rsaPublicKeyPEM, const std::string &adminKeyPlain)
+std::string SessionManager::buildAuthorizeBody(const std::string &sessionId, const std::string &rsaPublicKeyPEM, const std::string &adminKeyPlain)
 {
-    std::string encryptedKey = encrypt(rsaPublicKeyPEM, adminKeyPlain);
-
     json requestBody = {
         {"session_id", sessionId},
-        {"admin_key", encryptedKey}};
-
-    CURL *curl = curl_easy_init();
-    if (!curl)
-        buffer("无法初始化 CURL", MessageType::Error);
-    std::string url = serverUrl + "/muip/auth_admin";
-    std::string postData = requestBody.dump();
-    std::string responseStr;
-
-    struct curl_slist *headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postData.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, postData.size());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseStr);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-
-    CURLcode res = curl_easy_perform(curl);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    if (res != CURLE_OK)
-        buffer("授权请求失败: " + std::string(curl_easy_strerror(res)), MessageType::Error);
-
-    return json::parse(responseStr);
+        {"admin_key", encrypt(rsaPublicKeyPEM, adminKeyPlain)}};
+    return requestBody.dump();
 }
 
-json SessionManager::getServerStatus(const std::string &serverUrl, const std::string &sessionId)
+std::string SessionManager::buildServerStatusBody(const std::string &sessionId)
 {
     json requestBody = {
         {"SessionId", sessionId},
     };
-    CURL *curl = curl_easy_init();
-    if (!curl)
-        buffer("无法初始化 CURL", MessageType::Error);
-
-    std::string url = serverUrl + "/muip/server_information";
-    std::string postData = requestBody.dump();
-    std::string responseStr;
-    struct curl_slist *headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
+    return requestBody.dump();
+}
 
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postData.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, postData.size());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseStr);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+std::string SessionManager::buildPlayerInfoBody(const std::string &sessionId, const std::string &playerUid)
+{
+    json requestBody = {
+        {"SessionId", sessionId},
+        {"Uid", playerUid}
+    };
+    return requestBody.dump();
+}
 
-    CURLcode res = curl_easy_perform(curl);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+std::string SessionManager::buildCommandBody(const std::string &sessionId, const std::string &rsaPublicKeyPEM, const std::string &commandPlain, const std::string &targetUid)
+{
+    json requestBody = {
+        {"SessionId", sessionId},
+        {"Command", encrypt(rsaPublicKeyPEM, commandPlain)},
+        {"TargetUid", targetUid}};
+    return requestBody.dump();
+}
 
-    if (res != CURLE_OK)
-        buffer("获取服务器状态失败: " + std::string(curl_easy_strerror(res)), MessageType::Error);
+json SessionManager::parseResponse(const std::string &responseStr)
+{
     return json::parse(responseStr);
 }
 
-json SessionManager::getPlayerInfo(const std::string &serverUrl, const std::string &sessionId, const std::string &playerUid)
+namespace
 {
-    json requestBody = {
-        {"SessionId", sessionId},
-        {"Uid", playerUid}
+    // 线程结束时释放句柄与其连接缓存
+    struct CurlHandle
+    {
+        CURL *curl = curl_easy_init();
+        struct curl_slist *headers = curl_slist_append(nullptr, "Content-Type: application/json");
+        ~CurlHandle()
+        {
+            curl_slist_free_all(headers);
+            if (curl)
+                curl_easy_cleanup(curl);
+        }
     };
-    CURL *curl = curl_easy_init();
+}
+
+json SessionManager::post(const std::string &serverUrl, const char *path, const std::string &postData, const char *failure)
+{
+    return parseResponse(postRaw(serverUrl, path, postData, failure));
+}
+
+std::string SessionManager::postRaw(const std::string &serverUrl, const char *path, const std::string &postData, const char *failure)
+{
+    Response response = postOnce(serverUrl, path, postData);
+    if (!response.transportError.empty())
+        buffer(failure + response.transportError, MessageType::Error);
+    return response.body;
+}
+
+SessionManager::Response SessionManager::postOnce(const std::string &serverUrl, const char *path, const std::string &postData, long timeoutMs)
+{
+    thread_local CurlHandle handle;
+    CURL *curl = handle.curl;
     if (!curl)
-        buffer("无法初始化 CURL", MessageType::Error);
+        throw std::runtime_error("无法初始化 CURL");
 
-    std::string url = serverUrl + "/muip/player_information";
-    std::string postData = requestBody.dump();
-    std::string responseStr;
-    struct curl_slist *headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
+    // reset 只清除选项，保留连接缓存与 DNS 缓存
+    curl_easy_reset(curl);
+    std::string url = serverUrl + path;
+    Response response;
 
     curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postData.c_str());
     curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, postData.size());
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseStr);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response.body);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, handle.headers);
+    if (timeoutMs > 0)
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeoutMs);
 
+    const EndpointMetrics &metrics = endpointMetrics(path);
+    const auto started = std::chrono::steady_clock::now();
     CURLcode res = curl_easy_perform(curl);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+    metrics.duration->observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+    metrics.requests->add();
 
     if (res != CURLE_OK)
-        buffer("获取玩家信息失败: " + std::string(curl_easy_strerror(res)), MessageType::Error);
-    return json::parse(responseStr);
+    {
+        response.transportError = curl_easy_strerror(res);
+        metrics.transportErrors->add();
+    }
+    else
+    {
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.httpStatus);
+        if (response.httpStatus >= 400)
+            metrics.httpErrors->add();
+    }
+    return response;
 }
 
-json SessionManager::submitCommand(const std::string &serverUrl, const std::string &sessionId, const std::string &rsaPublicKeyPEM, const std::string &commandPlain, const std::string &targetUid)
+SessionManager::Session SessionManager::OpenSession(const std::string &serverUrl, const std::string &adminKeyPlain)
 {
-    std::string encryptedCommand = encrypt(rsaPublicKeyPEM, commandPlain);
+    json created = createSession(serverUrl);
+    if (!created.contains("data") || !created["data"].contains("sessionId") || !created["data"].contains("rsaPublicKey"))
+        throw std::runtime_error("创建会话失败，返回信息：" + created.value("message", std::string()));
+
+    Session session{serverUrl,
+                    created["data"]["sessionId"].get<std::string>(),
+                    created["data"]["rsaPublicKey"].get<std::string>()};
+    authorize(serverUrl, session.sessionId, session.rsaPublicKey, adminKeyPlain);
+    static Metrics::Counter &opened = Metrics::counter("danheng_console_sessions_opened_total", "已建立的 MUIP 会话数");
+    opened.add();
+    return session;
+}
 
-    json requestBody = {
-        {"SessionId", sessionId},
-        {"Command", encryptedCommand},
-        {"TargetUid", targetUid}};
+SessionManager::Session SessionManager::SharedSession(const std::string &serverUrl, const std::string &adminKeyPlain)
+{
+    // 持锁建立：并发的首批调用只建一次会话
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    if (!sharedValid || shared.serverUrl != serverUrl)
+    {
+        shared = OpenSession(serverUrl, adminKeyPlain);
+        sharedValid = true;
+    }
+    return shared;
+}
 
-    CURL *curl = curl_easy_init();
-    if (!curl)
-        buffer("无法初始化 CURL", MessageType::Error);
+void SessionManager::InvalidateSharedSession(const std::string &sessionId)
+{
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    if (sharedValid && shared.sessionId == sessionId)
+        sharedValid = false;
+}
 
-    std::string url = serverUrl + "/muip/exec_cmd";
-    std::string postData = requestBody.dump();
-    std::string responseStr;
-    struct curl_slist *headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
+json SessionManager::createSession(const std::string &serverUrl)
+{
+    return post(serverUrl, "/muip/create_session", buildCreateSessionBody(), "创建会话请求失败: ");
+}
 
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postData.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, postData.size());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseStr);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+json SessionManager::authorize(const std::string &serverUrl, const std::string &sessionId, const std::string &rsaPublicKeyPEM, const std::string &adminKeyPlain)
+{
+    return post(serverUrl, "/muip/auth_admin", buildAuthorizeBody(sessionId, rsaPublicKeyPEM, adminKeyPlain), "授权请求失败: ");
+}
 
-    CURLcode res = curl_easy_perform(curl);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+json SessionManager::getServerStatus(const std::string &serverUrl, const std::string &sessionId)
+{
+    return post(serverUrl, "/muip/server_information", buildServerStatusBody(sessionId), "获取服务器状态失败: ");
+}
 
-    if (res != CURLE_OK)
-        buffer("命令提交失败: " + std::string(curl_easy_strerror(res)), MessageType::Error);
-    return json::parse(responseStr);
-}
\ No newline at end of file
+json SessionManager::getPlayerInfo(const std::string &serverUrl, const std::string &sessionId, const std::string &playerUid)
+{
+    return post(serverUrl, "/muip/player_information", buildPlayerInfoBody(sessionId, playerUid), "获取玩家信息失败: ");
+}
+
+std::string SessionManager::GetPlayerInfoRaw(const Session &session, const std::string &playerUid)
+{
+    return postRaw(session.serverUrl, "/muip/player_information", buildPlayerInfoBody(session.sessionId, playerUid), "获取玩家信息失败: ");
+}
+
+json SessionManager::submitCommand(const std::string &serverUrl, const std::string &sessionId, const std::string &rsaPublicKeyPEM, const std::string &commandPlain, const std::string &targetUid)
+{
+    return post(serverUrl, "/muip/exec_cmd", buildCommandBody(sessionId, rsaPublicKeyPEM, commandPlain, targetUid), "命令提交失败: ");
+}
@@ -0,0 +1,154 @@
+#include "SqliteBackup.hpp"
+#include "FileCopier.hpp"
+#include "IoThrottle.hpp"
+#include <sqlite3.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace
+{
+    // 连接句柄的简单 RAII 包装
+    struct Connection
+    {
+        sqlite3 *db = nullptr;
+        ~Connection() { close(); }
+        void close()
+        {
+            if (db)
+                sqlite3_close_v2(db);
+            db = nullptr;
+        }
+    };
+
+    bool exec(sqlite3 *db, const char *sql)
+    {
+        return sqlite3_exec(db, sql, nullptr, nullptr, nullptr) == SQLITE_OK;
+    }
+
+    std::string journalMode(sqlite3 *db)
+    {
+        std::string mode;
+        sqlite3_stmt *stmt = nullptr;
+        if (sqlite3_prepare_v2(db, "PRAGMA journal_mode", -1, &stmt, nullptr) == SQLITE_OK &&
+            sqlite3_step(stmt) == SQLITE_ROW)
+            mode = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+        sqlite3_finalize(stmt);
+        return mode;
+    }
+
+    int pageSize(sqlite3 *db)
+    {
+        int size = 4096;
+        sqlite3_stmt *stmt = nullptr;
+        if (sqlite3_prepare_v2(db, "PRAGMA page_size", -1, &stmt, nullptr) == SQLITE_OK &&
+            sqlite3_step(stmt) == SQLITE_ROW)
+            size = sqlite3_column_int(stmt, 0);
+        sqlite3_finalize(stmt);
+        return size;
+    }
+}
+
+bool SqliteBackup::backup(const fs::path &source, const fs::path &target,
+                          int pagesPerStep, int pauseMs,
+                          Stats &stats, std::string &error,
+                          IoThrottle *throttle)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    stats = Stats{};
+
+    Connection src;
+    if (sqlite3_open_v2(source.string().c_str(), &src.db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+    {
+        error = src.db ? sqlite3_errmsg(src.db) : "无法打开源数据库";
+        return false;
+    }
+    sqlite3_busy_timeout(src.db, 2000);
+
+    // WAL 模式下在源连接上保持一个读事务：备份始终读取同一个快照，
+    // 服务器的写入照常追加到 WAL，不会因源库变化而反复重新开始
+    stats.wal = journalMode(src.db) == "wal";
+    bool readTxn = stats.wal && exec(src.db, "BEGIN") &&
+                   exec(src.db, "SELECT count(*) FROM sqlite_master");
+
+    fs::path tmp = target;
+    tmp += ".tmp";
+    fs::remove(tmp);
+
+    {
+        Connection dst;
+        if (sqlite3_open(tmp.string().c_str(), &dst.db) != SQLITE_OK)
+        {
+            error = dst.db ? sqlite3_errmsg(dst.db) : "无法创建备份文件";
+            return false;
+        }
+
+        sqlite3_backup *backup = sqlite3_backup_init(dst.db, "main", src.db, "main");
+        if (!backup)
+        {
+            error = sqlite3_errmsg(dst.db);
+            return false;
+        }
+
+        // 限速时每步页数不超过一个令牌块
+        const int stepBytes = pageSize(src.db);
+        if (throttle && throttle->limited())
+            pagesPerStep = std::max(1, std::min(pagesPerStep > 0 ? pagesPerStep : 1 << 20,
+                                                static_cast<int>(throttle->chunkSize() / stepBytes)));
+
+        int rc;
+        int lastRemaining = -1;
+        do
+        {
+            if (throttle && !throttle->acquire(static_cast<std::size_t>(pagesPerStep > 0 ? pagesPerStep : 1) * stepBytes))
+            {
+                rc = SQLITE_INTERRUPT;
+                break;
+            }
+            rc = sqlite3_backup_step(backup, pagesPerStep > 0 ? pagesPerStep : -1);
+
+            // 剩余页数回升说明源库被其他连接修改，备份已从头开始
+            int remaining = sqlite3_backup_remaining(backup);
+            if (lastRemaining >= 0 && remaining > lastRemaining)
+                ++stats.restarts;
+            lastRemaining = remaining;
+            if (stats.restarts > MaxRestarts)
+                break;
+
+            if (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED)
+                std::this_thread::sleep_for(std::chrono::milliseconds(pauseMs));
+        } while (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED);
+
+        stats.pages = sqlite3_backup_pagecount(backup);
+        sqlite3_backup_finish(backup);
+
+        if (rc != SQLITE_DONE)
+        {
+            if (rc == SQLITE_INTERRUPT)
+                error = "备份已取消";
+            else if (stats.restarts > MaxRestarts)
+                error = "源库在备份期间被持续修改，已重新开始 " + std::to_string(stats.restarts) +
+                        " 次，放弃本次保存（可将数据库切换为 WAL 模式，备份将读取固定快照）";
+            else
+                error = sqlite3_errstr(rc);
+            dst.close();
+            fs::remove(tmp);
+            return false;
+        }
+
+        // 备份文件改为独立的回滚日志模式，单个文件即可完整恢复
+        exec(dst.db, "PRAGMA journal_mode=DELETE");
+    }
+
+    if (readTxn)
+        exec(src.db, "COMMIT");
+
+    if (!FileCopier::commit(tmp, target, error))
+    {
+        fs::remove(tmp);
+        return false;
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return true;
+}
@@ -0,0 +1,193 @@
+#ifndef _WIN32
+
+#include "TerminalBackend.hpp"
+#include <termios.h>
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <csignal>
+#include <cstdlib>
+#include <cerrno>
+#include <mutex>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+// 进入原始模式前的终端设置，restore() 时写回
+static termios savedTermios;
+static bool termiosSaved = false;
+
+// 唤醒输入线程用的描述符：Linux 下为 eventfd，其余平台为自管道
+static int wakeReadFd = -1;
+static int wakeWriteFd = -1;
+
+static void openWakeFds()
+{
+    static std::once_flag once;
+    std::call_once(once, []
+                   {
+#ifdef __linux__
+        wakeReadFd = wakeWriteFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+#else
+        int fds[2];
+        if (pipe(fds) == 0)
+        {
+            fcntl(fds[0], F_SETFL, O_NONBLOCK);
+            fcntl(fds[1], F_SETFL, O_NONBLOCK);
+            wakeReadFd = fds[0];
+            wakeWriteFd = fds[1];
+        }
+#endif
+    });
+}
+
+// 收到终止信号时先恢复终端，再按默认行为退出
+static void restoreAndReraise(int sig)
+{
+    TerminalBackend::restore();
+    std::signal(sig, SIG_DFL);
+    std::raise(sig);
+}
+
+void TerminalBackend::init()
+{
+    static std::once_flag once;
+    std::call_once(once, []
+                   {
+        if (!inputIsTty() || tcgetattr(STDIN_FILENO, &savedTermios) != 0)
+            return;
+        termiosSaved = true;
+
+        // 关闭规范模式与回显：逐键读取，由输入线程自行回显
+        termios raw = savedTermios;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+
+        std::atexit(restore);
+        std::signal(SIGINT, restoreAndReraise);
+        std::signal(SIGTERM, restoreAndReraise);
+        std::signal(SIGHUP, restoreAndReraise); });
+}
+
+void TerminalBackend::restore()
+{
+    if (termiosSaved)
+        tcsetattr(STDIN_FILENO, TCSANOW, &savedTermios);
+}
+
+bool TerminalBackend::inputIsTty()
+{
+    static const bool tty = isatty(STDIN_FILENO) != 0;
+    return tty;
+}
+
+bool TerminalBackend::outputIsTty()
+{
+    static const bool tty = isatty(STDOUT_FILENO) != 0;
+    return tty;
+}
+
+bool TerminalBackend::keyAvailable()
+{
+    pollfd pfd{STDIN_FILENO, POLLIN, 0};
+    return poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLIN | POLLHUP));
+}
+
+InputEvent TerminalBackend::waitInput()
+{
+    openWakeFds();
+    pollfd pfds[2] = {{STDIN_FILENO, POLLIN, 0}, {wakeReadFd, POLLIN, 0}};
+
+    while (true)
+    {
+        if (poll(pfds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return InputEvent::Key; // 交给 readKey() 报告错误/结束
+        }
+
+        if (pfds[1].revents & POLLIN)
+        {
+            // 清空唤醒计数；多次唤醒合并为一次
+            char drain[64];
+            while (::read(wakeReadFd, drain, sizeof(drain)) > 0)
+            {
+            }
+            return InputEvent::Wake;
+        }
+        if (pfds[0].revents & (POLLIN | POLLHUP | POLLERR))
+            return InputEvent::Key;
+    }
+}
+
+void TerminalBackend::wakeInput()
+{
+    openWakeFds();
+#ifdef __linux__
+    uint64_t one = 1;
+    ssize_t n = ::write(wakeWriteFd, &one, sizeof(one));
+#else
+    char one = 1;
+    ssize_t n = ::write(wakeWriteFd, &one, 1);
+#endif
+    (void)n;
+}
+
+int TerminalBackend::readKey()
+{
+    unsigned char ch = 0;
+    ssize_t n;
+    do
+        n = ::read(STDIN_FILENO, &ch, 1);
+    while (n < 0 && errno == EINTR);
+
+    if (n <= 0)
+        return -1;
+
+    // 与 Windows 的 _getch() 保持一致的按键编码
+    if (ch == '\n')
+        return '\r';
+    if (ch == 0x7F)
+        return '\b';
+    return ch;
+}
+
+void TerminalBackend::write(const std::string &text, bool toStderr)
+{
+    const int fd = toStderr ? STDERR_FILENO : STDOUT_FILENO;
+    const char *data = text.data();
+    size_t left = text.size();
+    while (left > 0)
+    {
+        ssize_t n = ::write(fd, data, left);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        data += n;
+        left -= static_cast<size_t>(n);
+    }
+}
+
+bool TerminalBackend::enableVirtualTerminal()
+{
+    return outputIsTty();
+}
+
+bool TerminalBackend::size(int &cols, int &rows)
+{
+    winsize ws{};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) != 0 || ws.ws_col == 0 || ws.ws_row == 0)
+        return false;
+    cols = ws.ws_col;
+    rows = ws.ws_row;
+    return true;
+}
+
+#endif
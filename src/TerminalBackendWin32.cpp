@@ -0,0 +1,119 @@
+#ifdef _WIN32
+
+#include "TerminalBackend.hpp"
+#include <windows.h>
+#include <conio.h> // _kbhit(), _getch()
+#include <io.h>    // _isatty(), _fileno()
+#include <cstdio>
+
+void TerminalBackend::init()
+{
+    // 设为 UTF-8 控制台
+    SetConsoleOutputCP(CP_UTF8);
+    SetConsoleCP(CP_UTF8);
+}
+
+void TerminalBackend::restore()
+{
+}
+
+bool TerminalBackend::inputIsTty()
+{
+    static const bool tty = _isatty(_fileno(stdin)) != 0;
+    return tty;
+}
+
+bool TerminalBackend::outputIsTty()
+{
+    static const bool tty = _isatty(_fileno(stdout)) != 0;
+    return tty;
+}
+
+bool TerminalBackend::keyAvailable()
+{
+    return _kbhit() != 0;
+}
+
+// 唤醒输入线程用的事件对象
+static HANDLE wakeEvent()
+{
+    static HANDLE event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    return event;
+}
+
+InputEvent TerminalBackend::waitInput()
+{
+    HANDLE input = GetStdHandle(STD_INPUT_HANDLE);
+    if (!inputIsTty())
+        return InputEvent::Key; // 重定向输入：由 readKey() 阻塞读取
+
+    HANDLE handles[2] = {wakeEvent(), input};
+    while (true)
+    {
+        DWORD r = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+        if (r == WAIT_OBJECT_0)
+            return InputEvent::Wake;
+        if (r != WAIT_OBJECT_0 + 1)
+            return InputEvent::Key;
+
+        // 控制台句柄在鼠标、焦点、按键抬起等事件上同样会触发；
+        // 丢弃这些事件，只在真正有字符可读时返回
+        INPUT_RECORD record;
+        DWORD count = 0;
+        while (PeekConsoleInputW(input, &record, 1, &count) && count > 0)
+        {
+            if (record.EventType == KEY_EVENT && record.Event.KeyEvent.bKeyDown)
+            {
+                WORD vk = record.Event.KeyEvent.wVirtualKeyCode;
+                bool modifierOnly = vk == VK_SHIFT || vk == VK_CONTROL ||
+                                    vk == VK_MENU || vk == VK_CAPITAL;
+                if (!modifierOnly)
+                    return InputEvent::Key;
+            }
+            ReadConsoleInputW(input, &record, 1, &count);
+        }
+    }
+}
+
+void TerminalBackend::wakeInput()
+{
+    SetEvent(wakeEvent());
+}
+
+int TerminalBackend::readKey()
+{
+    return _getch();
+}
+
+void TerminalBackend::write(const std::string &text, bool toStderr)
+{
+    FILE *stream = toStderr ? stderr : stdout;
+    std::fwrite(text.data(), 1, text.size(), stream);
+    std::fflush(stream);
+}
+
+bool TerminalBackend::enableVirtualTerminal()
+{
+    if (!outputIsTty())
+        return false;
+    HANDLE output = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (!GetConsoleMode(output, &mode))
+        return false;
+    if (mode & ENABLE_VIRTUAL_TERMINAL_PROCESSING)
+        return true;
+    // Windows 10 之前的控制台不支持该标志
+    return SetConsoleMode(output, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING) != 0;
+}
+
+bool TerminalBackend::size(int &cols, int &rows)
+{
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info))
+        return false;
+    cols = info.srWindow.Right - info.srWindow.Left + 1;
+    rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+    return cols > 0 && rows > 0;
+}
+
+#endif
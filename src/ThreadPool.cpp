@@ -0,0 +1,42 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    workers.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i)
+        workers.emplace_back([this]
+                             { workerLoop(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        stopping = true;
+    }
+    tasksNotifier.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(tasksMutex);
+            tasksNotifier.wait(lock, [this]
+                               { return stopping || !tasks.empty(); });
+            if (tasks.empty())
+                return; // stopping 且任务已执行完
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
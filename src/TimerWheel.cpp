@@ -0,0 +1,52 @@
+#include "TimerWheel.hpp"
+#include <algorithm>
+#include <limits>
+
+TimerWheel::TimerWheel(std::size_t bucketCount)
+    : buckets(std::max<std::size_t>(bucketCount, 1))
+{
+}
+
+void TimerWheel::schedule(int id, std::uint64_t tick)
+{
+    tick = std::max(tick, current + 1);
+    buckets[tick % buckets.size()].push_back(Entry{id, tick});
+    ++count;
+}
+
+void TimerWheel::advance(std::uint64_t now, std::vector<int> &due)
+{
+    if (now <= current)
+        return;
+
+    // 跨越超过一圈时每个桶只需扫描一次
+    const std::uint64_t steps = std::min<std::uint64_t>(now - current, buckets.size());
+    for (std::uint64_t i = 1; i <= steps; ++i)
+    {
+        auto &bucket = buckets[(current + i) % buckets.size()];
+        auto kept = std::remove_if(bucket.begin(), bucket.end(), [&](const Entry &entry)
+                                   {
+                                       if (entry.deadline > now)
+                                           return false;
+                                       due.push_back(entry.id);
+                                       return true; });
+        count -= static_cast<std::size_t>(bucket.end() - kept);
+        bucket.erase(kept, bucket.end());
+    }
+    current = now;
+}
+
+std::uint64_t TimerWheel::nextDue() const
+{
+    if (count == 0)
+        return std::numeric_limits<std::uint64_t>::max();
+
+    for (std::uint64_t i = 1; i <= buckets.size(); ++i)
+    {
+        const std::uint64_t tick = current + i;
+        for (const auto &entry : buckets[tick % buckets.size()])
+            if (entry.deadline <= tick)
+                return tick;
+    }
+    return current + buckets.size();
+}
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""经控制台的本地控制套接字（config.json 的 control_socket）提交请求，只依赖 Python 标准库。
+
+复用控制台已授权的会话，不必自己建会话、做 RSA 授权。协议为 4 字节大端长度 + JSON，
+一个连接上可以连续发送多个请求，响应按 id 对应。
+
+    python3 tools/danheng_ctl.py --socket /run/danheng/console.sock ping
+    python3 tools/danheng_ctl.py --socket ... status
+    python3 tools/danheng_ctl.py --socket ... player 10001
+    python3 tools/danheng_ctl.py --socket ... exec 10001 "give 1001 x10" "give 1002 x10"
+
+exec 可一次给出多条命令，全部发出后再等待结果（服务器侧并发执行，按完成顺序输出）。
+任一请求失败时退出码为 1。
+"""
+
+import argparse
+import json
+import socket
+import struct
+import sys
+
+
+def send(sock, request):
+    payload = json.dumps(request, ensure_ascii=False).encode()
+    sock.sendall(struct.pack(">I", len(payload)) + payload)
+
+
+def receive_exact(sock, size):
+    data = b""
+    while len(data) < size:
+        chunk = sock.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError("控制台关闭了连接")
+        data += chunk
+    return data
+
+
+def receive(sock):
+    (length,) = struct.unpack(">I", receive_exact(sock, 4))
+    return json.loads(receive_exact(sock, length))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="DanhengServer-Console 本地控制客户端")
+    parser.add_argument("--socket", required=True, help="控制台配置的 control_socket 路径")
+    parser.add_argument("--json", action="store_true", help="原样输出每条响应")
+    parser.add_argument("op", choices=["ping", "status", "player", "exec"])
+    parser.add_argument("args", nargs="*", help="player: UID；exec: UID 与一条或多条命令")
+    args = parser.parse_args()
+
+    requests = []
+    if args.op in ("ping", "status"):
+        requests.append({"op": args.op})
+    elif args.op == "player":
+        if len(args.args) != 1:
+            parser.error("player 需要一个 UID")
+        requests.append({"op": "player", "uid": args.args[0]})
+    else:
+        if len(args.args) < 2:
+            parser.error("exec 需要 UID 与至少一条命令")
+        requests.extend({"op": "exec", "uid": args.args[0], "command": c} for c in args.args[1:])
+    for i, request in enumerate(requests, 1):
+        request["id"] = i
+
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.connect(args.socket)
+    for request in requests:
+        send(sock, request)
+    sock.shutdown(socket.SHUT_WR)
+
+    failed = False
+    for _ in requests:
+        response = receive(sock)
+        failed |= not response.get("ok")
+        if args.json:
+            print(json.dumps(response, ensure_ascii=False))
+            continue
+        request = requests[response["id"] - 1] if isinstance(response.get("id"), int) else {}
+        label = request.get("command", args.op)
+        if not response.get("ok"):
+            print(f"[失败] {label}: {response.get('error')}", file=sys.stderr)
+        elif "output" in response:
+            print(f"[{label}] {response['output']}")
+        else:
+            print(json.dumps(response.get("data"), ensure_ascii=False, indent=2))
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
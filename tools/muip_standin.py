@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""本地 MUIP 替身服务器，用于压测（H.压力测试）与离线调试，只依赖 Python 标准库。
+
+实现 create_session、auth_admin、exec_cmd、player_information、server_information 五个接口，
+响应格式与 DanhengServer 相同。不解密管理员密钥与命令（下发的是固定公钥，私钥不在此处），
+因此只用于测量控制台与网络路径，不代表真实服务器的命令执行开销。
+
+    python3 tools/muip_standin.py --port 8080 --delay-ms 2 --jitter-ms 5 --error-rate 0.01
+
+然后把 config.json 的 dispatchUrl 改为 http://127.0.0.1:8080。
+"""
+
+import argparse
+import base64
+import json
+import random
+import threading
+import time
+import uuid
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+PUBLIC_KEY = """-----BEGIN PUBLIC KEY-----
+MIIBIjANBgkqhkiG9w0BAQEFAAOCAQ8AMIIBCgKCAQEA1xBv8L6SJIAcIKtG+M4w
+/fV3bucw83+PfZedVKPpQH43nMRQw2kNqpVmMGRO7i/sQWZNiUCRRKX7lYsMdFS5
+OlQtYyIExlkJNwxJgtW6jNwBVkCm7lVgPKwRGkKJEApOJObeCyTfNFp8R2QooEAr
+hOFij5w1G+Y8AVAxMqD+Xy8vqY08h21+K4gTWBDDpeaXz/zym7y9D5erPYQ78Q/l
+FVWqitZaI85JWjdDX1cfF5avv693Zd7+hSOIpYAQR94siqRzQxPDVpadSAO4RHj5
+CklbuPcvhuJ7nrncOr8ornhvxdgD3VIlx7AK7hy0zI0yMMfj0/H8MAZKNAuYM7bs
+twIDAQAB
+-----END PUBLIC KEY-----
+"""
+
+sessions = set()
+sessions_lock = threading.Lock()
+counters = {"exec_cmd": 0}
+
+
+def ok(data):
+    return {"code": 0, "message": "Success", "data": data}
+
+
+def fail(message):
+    return {"code": 1, "message": message, "data": None}
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"  # keep-alive，与控制台的连接复用一致
+    disable_nagle_algorithm = True  # 响应头与响应体分两次写出，不关 Nagle 会与延迟确认叠加出约 40 ms 的停顿
+    args = None
+    inventory = None
+
+    def log_message(self, *_):
+        pass
+
+    def reply(self, status, payload):
+        body = json.dumps(payload).encode()
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def do_POST(self):
+        length = int(self.headers.get("Content-Length", 0))
+        try:
+            request = json.loads(self.rfile.read(length) or b"{}")
+        except ValueError:
+            self.reply(400, fail("BadRequest"))
+            return
+
+        args = self.args
+        delay = args.delay_ms + random.random() * args.jitter_ms
+        if delay > 0:
+            time.sleep(delay / 1000.0)
+        if args.error_rate > 0 and random.random() < args.error_rate:
+            self.reply(500, fail("InjectedError"))
+            return
+
+        endpoint = self.path.rsplit("/", 1)[-1]
+        if endpoint == "create_session":
+            session_id = str(uuid.uuid4())
+            with sessions_lock:
+                sessions.add(session_id)
+            self.reply(200, ok({"sessionId": session_id, "rsaPublicKey": PUBLIC_KEY, "expireTimeStamp": int(time.time()) + 600}))
+            return
+        if endpoint == "auth_admin":
+            self.reply(200, ok({"sessionId": request.get("session_id"), "expireTimeStamp": int(time.time()) + 600}))
+            return
+
+        with sessions_lock:
+            known = request.get("SessionId") in sessions
+        if not known:
+            self.reply(200, fail("InvalidSession"))
+            return
+
+        if endpoint == "exec_cmd":
+            with sessions_lock:
+                counters["exec_cmd"] += 1
+            message = base64.b64encode("命令已执行（替身服务器）".encode()).decode()
+            self.reply(200, ok({"sessionId": request["SessionId"], "message": message}))
+        elif endpoint == "player_information":
+            uid = request.get("Uid")
+            data = {"uid": uid, "name": "Trailblazer", "level": 70, "worldLevel": 6,
+                    "stamina": random.randint(0, 240)}
+            if self.inventory is not None:
+                data["itemList"] = self.inventory
+            self.reply(200, ok(data))
+        elif endpoint == "server_information":
+            self.reply(200, ok({"onlinePlayers": [], "serverTime": int(time.time()), "maxMemory": 0,
+                                "usedMemory": 0, "programUsedMemory": 0}))
+        else:
+            self.reply(404, fail("NotFound"))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="DanhengServer MUIP 替身服务器")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--delay-ms", type=float, default=0, help="每个请求的固定处理延迟")
+    parser.add_argument("--jitter-ms", type=float, default=0, help="在固定延迟上附加 0–jitter 的随机延迟")
+    parser.add_argument("--error-rate", type=float, default=0, help="以该概率返回 HTTP 500")
+    parser.add_argument("--inventory", help="JSON 文件 {物品ID: 数量}，作为 player_information 的 itemList 返回（供背包补齐测试）")
+    Handler.args = parser.parse_args()
+    if Handler.args.inventory:
+        with open(Handler.args.inventory, encoding="utf-8") as f:
+            Handler.inventory = [{"itemId": int(k), "count": v} for k, v in json.load(f).items()]
+
+    server = ThreadingHTTPServer((Handler.args.host, Handler.args.port), Handler)
+    server.daemon_threads = True
+    print(f"MUIP 替身服务器监听 http://{Handler.args.host}:{Handler.args.port}")
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""读取主菜单 K.导出玩家 生成的列式导出文件（.dhpx），只依赖 Python 标准库。
+
+    python3 tools/read_player_export.py players_10001_20000.dhpx              # 每行一个 JSON 对象
+    python3 tools/read_player_export.py players_10001_20000.dhpx --csv        # 扁平列名的 CSV
+    python3 tools/read_player_export.py players_10001_20000.dhpx --columns    # 各列的类型与存储大小
+
+逐个行组读取，内存占用只与行组大小有关。文件格式见 include/PlayerExport.hpp。
+"""
+
+import argparse
+import csv
+import json
+import struct
+import sys
+import zlib
+
+INT, DOUBLE, STRING, JSON = 0, 1, 2, 3
+KIND_NAMES = {INT: "int", DOUBLE: "double", STRING: "string", JSON: "json"}
+COMPRESSED = 0x80
+
+
+class Corrupt(Exception):
+    pass
+
+
+def read_varint(f):
+    value, shift = 0, 0
+    while shift < 64:
+        b = f.read(1)
+        if not b:
+            return None
+        value |= (b[0] & 0x7F) << shift
+        if not b[0] & 0x80:
+            return value
+        shift += 7
+    raise Corrupt("变长整数过长")
+
+
+def varint_at(buf, pos):
+    value, shift = 0, 0
+    while pos < len(buf) and shift < 64:
+        b = buf[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        if not b & 0x80:
+            return value, pos
+        shift += 7
+    raise Corrupt("变长整数不完整")
+
+
+def decode_column(kind, raw, rows):
+    """返回 [(行号, 值)]"""
+    bitmap = (rows + 7) // 8
+    present = [r for r in range(rows) if raw[r // 8] >> (r % 8) & 1]
+    pos = bitmap
+    values = []
+    if kind == INT:
+        value = 0
+        for _ in present:
+            delta, pos = varint_at(raw, pos)
+            value += (delta >> 1) ^ -(delta & 1)
+            values.append(value)
+    elif kind == DOUBLE:
+        values = list(struct.unpack_from("<%dd" % len(present), raw, pos))
+    elif kind in (STRING, JSON):
+        size, pos = varint_at(raw, pos)
+        dictionary = []
+        for _ in range(size):
+            length, pos = varint_at(raw, pos)
+            text = raw[pos:pos + length].decode("utf-8")
+            dictionary.append(json.loads(text) if kind == JSON else text)
+            pos += length
+        for _ in present:
+            index, pos = varint_at(raw, pos)
+            values.append(dictionary[index])
+    else:
+        raise Corrupt("未知列类型 %d" % kind)
+    return list(zip(present, values))
+
+
+def groups(f):
+    """逐个行组产出 (行数, [(列名, 类型, 存储大小, [(行号, 值)])])；读到结束标记后停止"""
+    header = f.read(5)
+    if header[:4] != b"DHPX":
+        raise Corrupt("不是玩家导出文件")
+    if header[4] != 1:
+        raise Corrupt("不支持的版本 %d" % header[4])
+    while True:
+        rows = read_varint(f)
+        if rows is None:
+            raise Corrupt("文件没有结束标记，导出可能中断")
+        if rows == 0:
+            return
+        columns = []
+        for _ in range(read_varint(f)):
+            name = f.read(read_varint(f)).decode("utf-8")
+            kind = f.read(1)[0]
+            raw_size = read_varint(f)
+            stored = f.read(read_varint(f))
+            raw = zlib.decompress(stored) if kind & COMPRESSED else stored
+            if len(raw) != raw_size:
+                raise Corrupt("列 %s 的长度不符" % name)
+            columns.append((name, kind & ~COMPRESSED, len(stored), decode_column(kind & ~COMPRESSED, raw, rows)))
+        yield rows, columns
+
+
+def unescape(segment):
+    return segment.replace("~1", "/").replace("~0", "~")
+
+
+def to_objects(rows, columns):
+    objects = [{} for _ in range(rows)]
+    for name, _, _, cells in columns:
+        path = [unescape(s) for s in name.split("/")]
+        for row, value in cells:
+            node = objects[row]
+            for key in path[:-1]:
+                node = node.setdefault(key, {})
+            node[path[-1]] = value
+    return objects
+
+
+def main():
+    parser = argparse.ArgumentParser(description="读取玩家导出文件（.dhpx）")
+    parser.add_argument("file")
+    mode = parser.add_mutually_exclusive_group()
+    mode.add_argument("--csv", action="store_true", help="输出 CSV（列名为字段路径，如 data/level）")
+    mode.add_argument("--columns", action="store_true", help="只列出各列的类型、值个数与压缩后大小")
+    args = parser.parse_args()
+
+    stats = {}
+    writer = None
+    with open(args.file, "rb") as f:
+        try:
+            for rows, columns in groups(f):
+                if args.columns:
+                    for name, kind, stored, cells in columns:
+                        entry = stats.setdefault(name, [set(), 0, 0])
+                        entry[0].add(KIND_NAMES.get(kind, "?"))
+                        entry[1] += len(cells)
+                        entry[2] += stored
+                elif args.csv:
+                    # CSV 的列在第一个行组确定，之后新出现的列不输出
+                    table = [dict() for _ in range(rows)]
+                    for name, _, _, cells in columns:
+                        for row, value in cells:
+                            table[row][name] = json.dumps(value, ensure_ascii=False) if isinstance(value, (list, dict, bool)) else value
+                    if writer is None:
+                        writer = csv.DictWriter(sys.stdout, fieldnames=[c[0] for c in columns], extrasaction="ignore")
+                        writer.writeheader()
+                    writer.writerows(table)
+                else:
+                    for obj in to_objects(rows, columns):
+                        print(json.dumps(obj, ensure_ascii=False))
+        except (Corrupt, zlib.error, IndexError, UnicodeDecodeError, struct.error) as e:
+            print("读取中止：%s" % e, file=sys.stderr)
+            sys.exit(1)
+
+    if args.columns:
+        for name, (kinds, count, stored) in stats.items():
+            print("%-40s %-12s %10d 个值 %10d 字节" % (name, "/".join(sorted(kinds)), count, stored))
+
+
+if __name__ == "__main__":
+    main()